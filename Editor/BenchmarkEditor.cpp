@@ -0,0 +1,225 @@
+#include "IMGUI/imgui.h"
+
+#include "EditorSubmodule.h"
+#include "Engine.h"
+#include "ModuleWindow.h"
+#include "EditorUtils.h"
+#include "Benchmarks.h"
+#include "ParticleSimulation.h"
+#include "Skinning.h"
+#include "AnimationCompression.h"
+
+class BenchmarkEditor : public EditorSubmodule
+{
+public:
+	void Init() override;
+	void Update() override;
+
+private:
+	void drawParticleResults() const;
+	void drawSkinningResults() const;
+	void drawBVHResults() const;
+	void drawOcclusionResults() const;
+	void drawAnimationCompressionResults() const;
+	void drawAnimationResults() const;
+
+	std::shared_ptr<ModuleWindow> _moduleWindow;
+	std::vector<ParticleBenchmarkResult> _particleResults;
+	std::vector<SkinningBenchmarkResult> _skinningResults;
+	std::vector<BVHBenchmarkResult> _bvhResults;
+	std::vector<OcclusionBenchmarkResult> _occlusionResults;
+	std::vector<AnimationCompressionBenchmarkResult> _animationCompressionResults;
+	std::vector<AnimationBenchmarkResult> _animationResults;
+};
+
+REGISTER_EDITOR_SUBMODULE(BenchmarkEditor)
+
+void BenchmarkEditor::Init()
+{
+	_moduleWindow = App->GetModule<ModuleWindow>();
+}
+
+void BenchmarkEditor::Update()
+{
+	int w, h;
+	_moduleWindow->GetWindowSize(w, h);
+
+	ImVec2 windowPosition(964, h - 200);
+	ImGui::SetNextWindowSize(ImVec2(320, 200), ImGuiSetCond_Always);
+	ImGui::SetNextWindowPos(windowPosition, ImGuiSetCond_Always);
+	if (ImGui::Begin("Benchmarks", nullptr, ImGuiWindowFlags_AlwaysUseWindowPadding))
+	{
+		if (ImGui::Button("Particle simulation"))
+			_particleResults = Benchmarks::RunParticleSimulation();
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Skinning"))
+			_skinningResults = Benchmarks::RunSkinning();
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Mesh BVH"))
+			_bvhResults = Benchmarks::RunMeshBVH();
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Occlusion"))
+			_occlusionResults = Benchmarks::RunOcclusion();
+
+		if (ImGui::Button("Anim compression"))
+			_animationCompressionResults = Benchmarks::RunAnimationCompression(AnimationCompression::GetOptionsFromSettings());
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Animation"))
+			_animationResults = Benchmarks::RunAnimation();
+
+		if (!_particleResults.empty())
+			drawParticleResults();
+
+		if (!_skinningResults.empty())
+			drawSkinningResults();
+
+		if (!_bvhResults.empty())
+			drawBVHResults();
+
+		if (!_occlusionResults.empty())
+			drawOcclusionResults();
+
+		if (!_animationCompressionResults.empty())
+			drawAnimationCompressionResults();
+
+		if (!_animationResults.empty())
+			drawAnimationResults();
+	}
+	ImGui::End();
+}
+
+void BenchmarkEditor::drawParticleResults() const
+{
+	ImGui::Columns(4, "ParticleBenchmark");
+	ImGui::Text("Particles"); ImGui::NextColumn();
+	ImGui::Text("Scalar ms"); ImGui::NextColumn();
+	ImGui::Text("%s ms", ParticleSimulation::GetKernelName(SimulationKernel::Best)); ImGui::NextColumn();
+	ImGui::Text("Speedup"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const ParticleBenchmarkResult& result : _particleResults)
+	{
+		ImGui::Text("%i", int(result.Particles)); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.ScalarMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.SimdMs); ImGui::NextColumn();
+		ImGui::Text("x%.2f", result.SimdMs > 0.0 ? result.ScalarMs / result.SimdMs : 0.0); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+void BenchmarkEditor::drawSkinningResults() const
+{
+	ImGui::Columns(4, "SkinningBenchmark");
+	ImGui::Text("Vertices"); ImGui::NextColumn();
+	ImGui::Text("Scalar ms"); ImGui::NextColumn();
+	ImGui::Text("%s ms", Skinning::GetKernelName(SkinningKernel::Best)); ImGui::NextColumn();
+	ImGui::Text("Speedup"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const SkinningBenchmarkResult& result : _skinningResults)
+	{
+		ImGui::Text("%i", int(result.Vertices)); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.ScalarMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.SimdMs); ImGui::NextColumn();
+		ImGui::Text("x%.2f", result.SimdMs > 0.0 ? result.ScalarMs / result.SimdMs : 0.0); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+void BenchmarkEditor::drawBVHResults() const
+{
+	ImGui::Columns(5, "BVHBenchmark");
+	ImGui::Text("Triangles"); ImGui::NextColumn();
+	ImGui::Text("Build ms"); ImGui::NextColumn();
+	ImGui::Text("Brute ms"); ImGui::NextColumn();
+	ImGui::Text("BVH ms"); ImGui::NextColumn();
+	ImGui::Text("Speedup"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const BVHBenchmarkResult& result : _bvhResults)
+	{
+		ImGui::Text("%i", int(result.Triangles)); ImGui::NextColumn();
+		ImGui::Text("%.2f", result.BuildMs); ImGui::NextColumn();
+		ImGui::Text("%.2f", result.BruteForceMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.BVHMs); ImGui::NextColumn();
+		ImGui::Text("x%.1f", result.BVHMs > 0.0 ? result.BruteForceMs / result.BVHMs : 0.0); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+void BenchmarkEditor::drawOcclusionResults() const
+{
+	ImGui::Columns(5, "OcclusionBenchmark");
+	ImGui::Text("Triangles"); ImGui::NextColumn();
+	ImGui::Text("Scalar ms"); ImGui::NextColumn();
+	ImGui::Text("SIMD ms"); ImGui::NextColumn();
+	ImGui::Text("Speedup"); ImGui::NextColumn();
+	ImGui::Text("Test ms"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const OcclusionBenchmarkResult& result : _occlusionResults)
+	{
+		ImGui::Text("%i", int(result.Triangles)); ImGui::NextColumn();
+		ImGui::Text("%.2f", result.ScalarMs); ImGui::NextColumn();
+		ImGui::Text("%.2f", result.SSEMs); ImGui::NextColumn();
+		ImGui::Text("x%.1f", result.SSEMs > 0.0 ? result.ScalarMs / result.SSEMs : 0.0); ImGui::NextColumn();
+		ImGui::Text("%.2f", result.TestMs); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+void BenchmarkEditor::drawAnimationCompressionResults() const
+{
+	ImGui::Columns(5, "AnimationCompressionBenchmark");
+	ImGui::Text("Keys"); ImGui::NextColumn();
+	ImGui::Text("Ratio"); ImGui::NextColumn();
+	ImGui::Text("Position"); ImGui::NextColumn();
+	ImGui::Text("Rotation"); ImGui::NextColumn();
+	ImGui::Text("Bounded"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const AnimationCompressionBenchmarkResult& result : _animationCompressionResults)
+	{
+		ImGui::Text("%i/%i", int(result.ClipKeys), int(result.SourceKeys)); ImGui::NextColumn();
+		ImGui::Text("x%.1f", result.ClipBytes > 0 ? double(result.RawBytes) / result.ClipBytes : 0.0); ImGui::NextColumn();
+		ImGui::Text("%.5f", result.Error.Position); ImGui::NextColumn();
+		ImGui::Text("%.5f", result.Error.Rotation); ImGui::NextColumn();
+		ImGui::Text(result.WithinBounds ? "Yes" : "No"); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
+
+void BenchmarkEditor::drawAnimationResults() const
+{
+	ImGui::Columns(5, "AnimationBenchmark");
+	ImGui::Text("Instances"); ImGui::NextColumn();
+	ImGui::Text("Serial ms"); ImGui::NextColumn();
+	ImGui::Text("Jobs ms"); ImGui::NextColumn();
+	ImGui::Text("Speedup"); ImGui::NextColumn();
+	ImGui::Text("Mismatches"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const AnimationBenchmarkResult& result : _animationResults)
+	{
+		ImGui::Text("%i", int(result.Instances)); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.SerialMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.ParallelMs); ImGui::NextColumn();
+		ImGui::Text("x%.2f", result.ParallelMs > 0.0 ? result.SerialMs / result.ParallelMs : 0.0); ImGui::NextColumn();
+		ImGui::Text("%i", int(result.PoseMismatches)); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+}
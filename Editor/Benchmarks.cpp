@@ -0,0 +1,523 @@
+#include "Benchmarks.h"
+#include "Globals.h"
+#include "Random.h"
+#include "ParticleBuffer.h"
+#include "ParticleSimulation.h"
+#include "Skinning.h"
+#include "MeshBVH.h"
+#include "OcclusionBuffer.h"
+#include "GameObject.h"
+#include "TransformComponent.h"
+
+#include <MathGeoLib/include/Math/Quat.h>
+#include <cfloat>
+#include <cmath>
+
+#define BENCHMARK_BONES 32
+#define BENCHMARK_ADDITIVE_BONES 8 // The additive clip only animates part of the skeleton
+#define BENCHMARK_FRAMES 60
+#define BENCHMARK_FRAME_TIME (1.f / 60.f)
+#define BENCHMARK_FADE_TIME 0.25f
+#define BENCHMARK_ADDITIVE_WEIGHT 0.5f
+
+namespace
+{
+	void FillParticles(ParticleBuffer& particles, unsigned count)
+	{
+		particles.Reserve(count);
+
+		Random random(12345);
+		for (unsigned i = 0; i < count; ++i)
+		{
+			float value = random.NextFloat();
+			particles.Spawn(float3(value * 100.f, 20.f, value * 50.f), float3(0.f, -1.2f, 0.f), 0.1f + value * 15.f);
+		}
+	}
+
+	void BuildSkin(unsigned vertexCount, MeshSkin& skin, std::vector<float4x4>& palette)
+	{
+		Random random(4321);
+
+		skin.BindPositions.resize(vertexCount);
+		skin.BindNormals.resize(vertexCount);
+		skin.BoneIndices.resize(vertexCount * SKINNING_INFLUENCES);
+		skin.BoneWeights.resize(vertexCount * SKINNING_INFLUENCES);
+
+		for (unsigned v = 0; v < vertexCount; ++v)
+		{
+			skin.BindPositions[v] = float3(random.NextFloat(-1.f, 1.f), random.NextFloat(0.f, 2.f), random.NextFloat(-1.f, 1.f));
+			skin.BindNormals[v] = float3(random.NextFloat(-1.f, 1.f), 1.f, random.NextFloat(-1.f, 1.f)).Normalized();
+
+			float total = 0.f;
+			for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+			{
+				skin.BoneIndices[v * SKINNING_INFLUENCES + i] = float(random.Next() % MAX_SKINNING_BONES);
+				skin.BoneWeights[v * SKINNING_INFLUENCES + i] = random.NextFloat(0.1f, 1.f);
+				total += skin.BoneWeights[v * SKINNING_INFLUENCES + i];
+			}
+
+			for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+				skin.BoneWeights[v * SKINNING_INFLUENCES + i] /= total;
+		}
+
+		palette.resize(MAX_SKINNING_BONES);
+		for (float4x4& matrix : palette)
+		{
+			Quat rotation = Quat::RotateY(random.NextFloat(-1.f, 1.f));
+			matrix = float4x4::FromTRS(float3(random.NextFloat(-0.1f, 0.1f), 0.f, 0.f), rotation, float3::one);
+		}
+	}
+
+	void BuildTerrain(unsigned triangleCount, std::vector<float3>& vertices, std::vector<uint32_t>& indices)
+	{
+		Random random(777);
+		unsigned side = unsigned(sqrtf(triangleCount / 2.f)) + 1;
+
+		vertices.clear();
+		for (unsigned z = 0; z <= side; ++z)
+		{
+			for (unsigned x = 0; x <= side; ++x)
+				vertices.push_back(float3(float(x), random.NextFloat(0.f, 0.5f), float(z)));
+		}
+
+		indices.clear();
+		for (unsigned z = 0; z < side && indices.size() < triangleCount * 3; ++z)
+		{
+			for (unsigned x = 0; x < side && indices.size() < triangleCount * 3; ++x)
+			{
+				uint32_t corner = z * (side + 1) + x;
+				uint32_t quad[6] = { corner, corner + side + 1, corner + 1, corner + 1, corner + side + 1, corner + side + 2 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+		indices.resize(triangleCount * 3);
+	}
+
+	// Smooth looping motion on every track of bones named "Bone0", "Bone1"... sampled at a fixed rate
+	std::vector<Channel> CreateSyntheticChannels(unsigned bones, float duration, float keysPerSecond, uint32_t seed)
+	{
+		Random random(seed);
+		unsigned keyCount = unsigned(duration * keysPerSecond) + 1;
+		std::vector<Channel> channels(bones);
+
+		for (unsigned bone = 0; bone < bones; ++bone)
+		{
+			Channel& channel = channels[bone];
+			channel.NodeName = "Bone" + std::to_string(bone);
+
+			// Whole cycles over the duration, so the clip loops without a jump
+			float3 offset(random.NextFloat(-1.f, 1.f), random.NextFloat(-1.f, 1.f), random.NextFloat(-1.f, 1.f));
+			float3 amplitude(random.NextFloat(0.05f, 0.5f), random.NextFloat(0.05f, 0.5f), random.NextFloat(0.05f, 0.5f));
+			float3 axis = float3(random.NextFloat(-1.f, 1.f), random.NextFloat(-1.f, 1.f), random.NextFloat(1.f, 2.f)).Normalized();
+			float swing = random.NextFloat(0.2f, 0.8f);
+			float pulse = random.NextFloat(0.f, 0.1f);
+			float frequency = float(1 + random.Next() % 3) * 2.f * pi / duration;
+			float phase = random.NextFloat(0.f, 2.f * pi);
+
+			for (unsigned key = 0; key < keyCount; ++key)
+			{
+				float time = MIN(key / keysPerSecond, duration);
+				float wave = sinf(frequency * time + phase);
+
+				channel.PositionTimes.push_back(time);
+				channel.Positions.push_back(offset + amplitude * wave);
+
+				channel.RotationTimes.push_back(time);
+				channel.Rotations.push_back(Quat::RotateAxisAngle(axis, swing * wave));
+
+				channel.ScaleTimes.push_back(time);
+				channel.Scales.push_back(float3::one * (1.f + pulse * wave));
+			}
+		}
+
+		return channels;
+	}
+
+	// Root with a binary tree of bones named like the channels of CreateSyntheticChannels
+	void CreateRig(unsigned bones, std::vector<GameObject*>& nodes)
+	{
+		size_t first = nodes.size();
+
+		GameObject* root = new GameObject;
+		root->Name = "BenchmarkRig";
+		root->AddComponent(new TransformComponent);
+		nodes.push_back(root);
+
+		for (unsigned i = 0; i < bones; ++i)
+		{
+			GameObject* bone = new GameObject;
+			bone->Name = "Bone" + std::to_string(i);
+			bone->AddComponent(new TransformComponent);
+			bone->SetParent(nodes[first + (i == 0 ? 0 : 1 + (i - 1) / 2)]);
+			nodes.push_back(bone);
+		}
+	}
+
+	void RegisterSyntheticClip(ModuleAnimation& animation, const std::string& name, unsigned bones, uint32_t seed)
+	{
+		const float duration = 2.f;
+		std::vector<Channel> channels = CreateSyntheticChannels(bones, duration, 30.f, seed);
+		AnimationCompression::Compress(channels, duration, AnimationCompressionOptions(), *animation.CreateAnimation(name));
+	}
+
+	// Time of a looping layer after the benchmark frames, advanced the same way AdvanceLayer does
+	float LayerTime(float duration)
+	{
+		float time = 0.f;
+		for (unsigned frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+			time = fmodf(time + BENCHMARK_FRAME_TIME, duration);
+		return time;
+	}
+
+	bool MatchesPose(const TransformComponent& transform, const float3& position, const Quat& rotation, const float3& scale)
+	{
+		const float tolerance = 1e-4f;
+		return transform.Position.Distance(position) <= tolerance && transform.Scale.Distance(scale) <= tolerance &&
+			fabsf(transform.Rotation.Dot(rotation)) >= 1.f - tolerance * tolerance;
+	}
+
+	Quat NormalisedOrIdentity(const Quat& rotation)
+	{
+		float lengthSq = rotation.Dot(rotation);
+		if (lengthSq <= 1e-12f)
+			return Quat::identity;
+
+		float inverseLength = 1.f / sqrtf(lengthSq);
+		return Quat(rotation.x * inverseLength, rotation.y * inverseLength, rotation.z * inverseLength, rotation.w * inverseLength);
+	}
+}
+
+std::vector<ParticleBenchmarkResult> Benchmarks::RunParticleSimulation(unsigned iterations)
+{
+	const float dt = 1.f / 60.f;
+	ParticleBuffer particles;
+
+	return SweepSizes<ParticleBenchmarkResult>({ 10000, 100000, 1000000 }, [&](unsigned size, ParticleBenchmarkResult& result)
+	{
+		result.Particles = size;
+
+		SimulationKernel kernels[] = { SimulationKernel::Scalar, SimulationKernel::Best };
+		double* times[] = { &result.ScalarMs, &result.SimdMs };
+
+		for (unsigned k = 0; k < 2; ++k)
+		{
+			// Both kernels start from the same particle field
+			FillParticles(particles, size);
+			*times[k] = TimeMs([&]() { ParticleSimulation::Simulate(particles, dt, kernels[k]); }, iterations);
+		}
+
+		LOG("Particle simulation %i particles: scalar %.3f ms, %s %.3f ms (x%.2f)", size, result.ScalarMs,
+			ParticleSimulation::GetKernelName(SimulationKernel::Best), result.SimdMs, result.ScalarMs / MAX(result.SimdMs, 1e-6));
+	});
+}
+
+std::vector<SkinningBenchmarkResult> Benchmarks::RunSkinning(unsigned iterations)
+{
+	return SweepSizes<SkinningBenchmarkResult>({ 10000, 100000, 1000000 }, [&](unsigned size, SkinningBenchmarkResult& result)
+	{
+		MeshSkin skin;
+		std::vector<float4x4> palette;
+		BuildSkin(size, skin, palette);
+
+		std::vector<float3> positions(size);
+		std::vector<float3> normals(size);
+
+		result.Vertices = size;
+
+		SkinningKernel kernels[] = { SkinningKernel::Scalar, SkinningKernel::Best };
+		double* times[] = { &result.ScalarMs, &result.SimdMs };
+
+		for (unsigned k = 0; k < 2; ++k)
+		{
+			*times[k] = TimeMs([&]()
+			{
+				Skinning::SkinVertices(skin, palette.data(), palette.size(), positions.data(), normals.data(), kernels[k]);
+			}, iterations);
+		}
+
+		LOG("Skinning %i vertices: scalar %.3f ms, %s %.3f ms (x%.2f)", size, result.ScalarMs,
+			Skinning::GetKernelName(SkinningKernel::Best), result.SimdMs, result.ScalarMs / MAX(result.SimdMs, 1e-6));
+	});
+}
+
+std::vector<BVHBenchmarkResult> Benchmarks::RunMeshBVH(unsigned rays)
+{
+	std::vector<float3> vertices;
+	std::vector<uint32_t> indices;
+
+	return SweepSizes<BVHBenchmarkResult>({ 10000, 100000, 1000000 }, [&](unsigned size, BVHBenchmarkResult& result)
+	{
+		BuildTerrain(size, vertices, indices);
+
+		result.Triangles = size;
+
+		MeshBVH bvh;
+		result.BuildMs = TimeMs([&]() { bvh.Build(vertices.data(), indices.data(), size); });
+
+		std::vector<TrianglePack> packs;
+		RayTriangle::BuildPacks(vertices.data(), indices.data(), size, packs);
+
+		// Rays fall on the terrain from above with a slight tilt
+		float side = vertices.back().x;
+		std::vector<float3> origins, directions;
+		Random random(4242);
+		for (unsigned i = 0; i < rays; ++i)
+		{
+			origins.push_back(float3(random.NextFloat(0.f, side), 10.f, random.NextFloat(0.f, side)));
+			directions.push_back(float3(random.NextFloat(-0.2f, 0.2f), -1.f, random.NextFloat(-0.2f, 0.2f)));
+		}
+
+		std::vector<RayTriangleHit> bruteHits(rays), bvhHits(rays);
+
+		result.BruteForceMs = TimeMs([&]()
+		{
+			for (unsigned i = 0; i < rays; ++i)
+			{
+				bruteHits[i].Distance = FLT_MAX;
+				RayTriangle::Intersect(origins[i], directions[i], packs.data(), packs.size(), bruteHits[i]);
+			}
+		});
+
+		result.BVHMs = TimeMs([&]()
+		{
+			for (unsigned i = 0; i < rays; ++i)
+			{
+				bvhHits[i].Distance = FLT_MAX;
+				bvh.Intersect(origins[i], directions[i], bvhHits[i]);
+			}
+		});
+
+		unsigned mismatches = 0;
+		for (unsigned i = 0; i < rays; ++i)
+		{
+			if (bruteHits[i].Triangle != bvhHits[i].Triangle && fabsf(bruteHits[i].Distance - bvhHits[i].Distance) > 1e-4f)
+				++mismatches;
+		}
+
+		LOG("Mesh BVH %i triangles: %i nodes, %.1f KB, build %.2f ms, %i rays brute force %.2f ms, BVH %.2f ms (x%.1f), %i mismatches",
+			size, int(bvh.GetNodeCount()), bvh.GetMemoryUsage() / 1024.f, result.BuildMs, rays, result.BruteForceMs, result.BVHMs,
+			result.BruteForceMs / MAX(result.BVHMs, 1e-6), mismatches);
+	});
+}
+
+std::vector<OcclusionBenchmarkResult> Benchmarks::RunOcclusion(unsigned boxes)
+{
+	// Right handed camera at the origin looking down -Z
+	float4x4 viewProjection = float4x4::OpenGLPerspProjRH(0.1f, 200.f, 0.2f, 0.1f);
+
+	std::vector<float3> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<TrianglePack> packs;
+
+	OcclusionBuffer scalarBuffer, simdBuffer;
+
+	return SweepSizes<OcclusionBenchmarkResult>({ 1000, 10000, 100000 }, [&](unsigned size, OcclusionBenchmarkResult& result)
+	{
+		// Random quads split in two triangles, spread in front of the camera
+		Random random(1337);
+		vertices.clear();
+		indices.clear();
+		packs.clear();
+
+		for (unsigned i = 0; i < size / 2; ++i)
+		{
+			float3 center(random.NextFloat(-60.f, 60.f), random.NextFloat(-30.f, 30.f), random.NextFloat(-150.f, -10.f));
+			float halfSize = random.NextFloat(0.5f, 4.f);
+
+			uint32_t first = uint32_t(vertices.size());
+			vertices.push_back(center + float3(-halfSize, -halfSize, 0.f));
+			vertices.push_back(center + float3(halfSize, -halfSize, 0.f));
+			vertices.push_back(center + float3(halfSize, halfSize, 0.f));
+			vertices.push_back(center + float3(-halfSize, halfSize, 0.f));
+
+			uint32_t quad[] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+
+		RayTriangle::BuildPacks(vertices.data(), indices.data(), indices.size() / 3, packs);
+
+		result.Triangles = unsigned(indices.size() / 3);
+
+		scalarBuffer.Clear(viewProjection);
+		result.ScalarMs = TimeMs([&]() { scalarBuffer.RasterizeTriangles(float4x4::identity, packs.data(), packs.size(), OcclusionKernel::Scalar); });
+
+		simdBuffer.Clear(viewProjection);
+		result.SSEMs = TimeMs([&]() { simdBuffer.RasterizeTriangles(float4x4::identity, packs.data(), packs.size(), OcclusionKernel::Best); });
+
+		const float* scalarDepth = scalarBuffer.GetDepth();
+		const float* simdDepth = simdBuffer.GetDepth();
+		unsigned mismatches = 0;
+		for (unsigned i = 0; i < simdBuffer.GetWidth() * simdBuffer.GetHeight(); ++i)
+		{
+			if (scalarDepth[i] != simdDepth[i])
+				++mismatches;
+		}
+
+		result.TestMs = TimeMs([&]()
+		{
+			simdBuffer.BuildPyramid();
+			for (unsigned i = 0; i < boxes; ++i)
+			{
+				float3 center(random.NextFloat(-60.f, 60.f), random.NextFloat(-30.f, 30.f), random.NextFloat(-190.f, -10.f));
+				float3 halfSize(random.NextFloat(0.2f, 3.f), random.NextFloat(0.2f, 3.f), random.NextFloat(0.2f, 3.f));
+				simdBuffer.IsVisible(AABB(center - halfSize, center + halfSize));
+			}
+		});
+
+		LOG("Occlusion %i triangles: scalar %.2f ms, %s %.2f ms (x%.1f), %i mismatches, pyramid and %i boxes %.2f ms, %i culled",
+			result.Triangles, result.ScalarMs, OcclusionBuffer::GetKernelName(OcclusionKernel::Best), result.SSEMs, result.ScalarMs / MAX(result.SSEMs, 1e-6),
+			mismatches, boxes, result.TestMs, simdBuffer.GetStats().Culled);
+	});
+}
+
+std::vector<AnimationCompressionBenchmarkResult> Benchmarks::RunAnimationCompression(const AnimationCompressionOptions& options)
+{
+	const unsigned bones = 64;
+	const float duration = 4.f;
+	std::vector<Channel> channels = CreateSyntheticChannels(bones, duration, 30.f, 1337);
+
+	unsigned sourceKeys = 0;
+	for (const Channel& channel : channels)
+		sourceKeys += unsigned(channel.Positions.size() + channel.Rotations.size() + channel.Scales.size());
+
+	std::vector<AnimationCompressionBenchmarkResult> results;
+	for (bool reduceKeys : { false, true })
+	{
+		AnimationCompressionOptions benchmarkOptions = options;
+		benchmarkOptions.ReduceKeys = reduceKeys;
+
+		Animation clip;
+		AnimationCompression::Compress(channels, duration, benchmarkOptions, clip);
+
+		AnimationCompressionBenchmarkResult result;
+		result.ReduceKeys = reduceKeys;
+		result.SourceKeys = sourceKeys;
+		result.ClipKeys = unsigned(clip.Keys.size() / Animation::KEY_STRIDE);
+		result.RawBytes = AnimationCompression::GetRawSize(channels);
+		result.ClipBytes = clip.GetMemoryUsage();
+		result.Error = AnimationCompression::MeasureError(channels, clip);
+
+		AnimationCompressionError bound = AnimationCompression::GetErrorBound(channels, duration, benchmarkOptions, clip);
+		result.WithinBounds = result.Error.Position <= bound.Position && result.Error.Rotation <= bound.Rotation && result.Error.Scale <= bound.Scale;
+
+		LOG("Animation compression %s: %i of %i keys, %i to %i bytes (x%.1f), max error %.6f units, %.6f rad, %.6f scale, %s",
+			reduceKeys ? "with reduction" : "quantised only", result.ClipKeys, result.SourceKeys, int(result.RawBytes), int(result.ClipBytes),
+			float(result.RawBytes) / MAX(float(result.ClipBytes), 1.f), result.Error.Position, result.Error.Rotation, result.Error.Scale,
+			result.WithinBounds ? "within bounds" : "OUT OF BOUNDS");
+
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+std::vector<AnimationBenchmarkResult> Benchmarks::RunAnimation()
+{
+	// Modules of their own, so the instances playing in the level are left alone. Both play the same
+	// instances, one evaluates them on this thread and the other on the job system.
+	ModuleAnimation serialAnimation, parallelAnimation;
+	ModuleAnimation* animations[] = { &serialAnimation, &parallelAnimation };
+	std::vector<GameObject*> nodes[2];
+
+	for (ModuleAnimation* animation : animations)
+	{
+		animation->Start();
+		RegisterSyntheticClip(*animation, "BenchmarkWalk", BENCHMARK_BONES, 1);
+		RegisterSyntheticClip(*animation, "BenchmarkRun", BENCHMARK_BONES, 2);
+		RegisterSyntheticClip(*animation, "BenchmarkAdditive", BENCHMARK_ADDITIVE_BONES, 3);
+	}
+
+	std::shared_ptr<Animation> walk = serialAnimation.GetAnimation("BenchmarkWalk");
+	std::shared_ptr<Animation> run = serialAnimation.GetAnimation("BenchmarkRun");
+	std::shared_ptr<Animation> additive = serialAnimation.GetAnimation("BenchmarkAdditive");
+
+	std::vector<AnimationBenchmarkResult> results = SweepSizes<AnimationBenchmarkResult>({ 64, 256, 512 }, [&](unsigned size, AnimationBenchmarkResult& result)
+	{
+		// A third of the instances only play, a third cross-fade to another clip and a third add a layer on top
+		for (unsigned m = 0; m < 2; ++m)
+		{
+			for (unsigned i = 0; i < size; ++i)
+			{
+				CreateRig(BENCHMARK_BONES, nodes[m]);
+				unsigned instance = animations[m]->Play("BenchmarkWalk", nodes[m][i * (BENCHMARK_BONES + 1)]);
+
+				if (i % 3 == 1)
+					animations[m]->CrossFade(instance, "BenchmarkRun", BENCHMARK_FADE_TIME);
+				else if (i % 3 == 2)
+					animations[m]->AddAdditive(instance, "BenchmarkAdditive", BENCHMARK_ADDITIVE_WEIGHT);
+			}
+		}
+
+		result.Instances = size;
+		result.Bones = BENCHMARK_BONES;
+		result.SerialMs = TimeMs([&]() { serialAnimation.Evaluate(BENCHMARK_FRAME_TIME, false); }, BENCHMARK_FRAMES);
+		result.ParallelMs = TimeMs([&]() { parallelAnimation.Evaluate(BENCHMARK_FRAME_TIME, true); }, BENCHMARK_FRAMES);
+
+		// Bones are sampled again, the fade is over so cross-faded instances only play the new clip
+		float walkTime = LayerTime(walk->Duration);
+		float runTime = LayerTime(run->Duration);
+		float additiveTime = LayerTime(additive->Duration);
+
+		for (unsigned i = 0; i < size; ++i)
+		{
+			for (unsigned channel = 0; channel < BENCHMARK_BONES; ++channel)
+			{
+				size_t node = i * (BENCHMARK_BONES + 1) + 1 + channel;
+				const TransformComponent* serial = nodes[0][node]->GetTransform();
+				const TransformComponent* parallel = nodes[1][node]->GetTransform();
+
+				float3 position, scale;
+				Quat rotation;
+				ChannelCursor cursor;
+				if (i % 3 == 1)
+					AnimationCompression::Sample(*run, channel, runTime, cursor, position, rotation, scale);
+				else
+					AnimationCompression::Sample(*walk, channel, walkTime, cursor, position, rotation, scale);
+
+				if (i % 3 == 2 && channel < BENCHMARK_ADDITIVE_BONES)
+				{
+					float3 referencePosition, referenceScale, layerPosition, layerScale;
+					Quat referenceRotation, layerRotation;
+					ChannelCursor referenceCursor, layerCursor;
+					AnimationCompression::Sample(*additive, channel, 0.f, referenceCursor, referencePosition, referenceRotation, referenceScale);
+					AnimationCompression::Sample(*additive, channel, additiveTime, layerCursor, layerPosition, layerRotation, layerScale);
+
+					position += (layerPosition - referencePosition) * BENCHMARK_ADDITIVE_WEIGHT;
+					scale += (layerScale - referenceScale) * BENCHMARK_ADDITIVE_WEIGHT;
+
+					Quat delta = referenceRotation.Conjugated() * layerRotation;
+					if (delta.w < 0.f)
+						delta = delta.Neg();
+					rotation = NormalisedOrIdentity(rotation * Quat::identity.Slerp(delta, BENCHMARK_ADDITIVE_WEIGHT));
+				}
+
+				// Evaluating on the jobs must give exactly the same pose as on one thread
+				bool matches = MatchesPose(*parallel, position, rotation, scale) &&
+					parallel->Position.Equals(serial->Position, 0.f) && parallel->Rotation.Equals(serial->Rotation, 0.f) &&
+					parallel->Scale.Equals(serial->Scale, 0.f);
+
+				if (!matches)
+					++result.PoseMismatches;
+			}
+		}
+
+		LOG("Animation %i instances of %i bones: serial %.3f ms, parallel %.3f ms (x%.2f) per frame, %i mismatching bones",
+			result.Instances, result.Bones, result.SerialMs, result.ParallelMs, result.SerialMs / MAX(result.ParallelMs, 1e-6), result.PoseMismatches);
+
+		for (unsigned m = 0; m < 2; ++m)
+		{
+			animations[m]->StopAll();
+			for (GameObject* node : nodes[m])
+			{
+				node->CleanUp();
+				RELEASE(node);
+			}
+			nodes[m].clear();
+		}
+	});
+
+	for (ModuleAnimation* animation : animations)
+		animation->CleanUp();
+
+	return results;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ComplexTimer.h"
+#include "AnimationCompression.h"
+
+#include <initializer_list>
+#include <vector>
+
+struct ParticleBenchmarkResult
+{
+	unsigned Particles = 0;
+	double ScalarMs = 0.0;
+	double SimdMs = 0.0;
+};
+
+struct SkinningBenchmarkResult
+{
+	unsigned Vertices = 0;
+	double ScalarMs = 0.0;
+	double SimdMs = 0.0;
+};
+
+struct BVHBenchmarkResult
+{
+	unsigned Triangles = 0;
+	double BuildMs = 0.0;
+	double BruteForceMs = 0.0;
+	double BVHMs = 0.0;
+};
+
+struct OcclusionBenchmarkResult
+{
+	unsigned Triangles = 0;
+	double ScalarMs = 0.0;
+	double SSEMs = 0.0;
+	double TestMs = 0.0;
+};
+
+struct AnimationCompressionBenchmarkResult
+{
+	bool ReduceKeys = false;
+	unsigned SourceKeys = 0;
+	unsigned ClipKeys = 0;
+	size_t RawBytes = 0;
+	size_t ClipBytes = 0;
+	AnimationCompressionError Error;
+	bool WithinBounds = false; // Every error is under AnimationCompression::GetErrorBound
+};
+
+struct AnimationBenchmarkResult
+{
+	unsigned Instances = 0;
+	unsigned Bones = 0;
+	double SerialMs = 0.0; // Per frame
+	double ParallelMs = 0.0;
+	unsigned PoseMismatches = 0;
+};
+
+/*
+ * Synthetic workloads for the engine systems, run from the benchmarks window. Each benchmark sweeps
+ * a few problem sizes, times the variants of the system at every size and logs a summary line.
+ */
+namespace Benchmarks
+{
+	// Average milliseconds of one call to run
+	template<typename RUN>
+	double TimeMs(RUN run, unsigned iterations = 1)
+	{
+		ComplexTimer timer;
+		timer.Start();
+		for (unsigned i = 0; i < iterations; ++i)
+			run();
+
+		return timer.Stop() / 1000.0 / iterations;
+	}
+
+	// One result per size, measure(size, result) fills in the result of a size
+	template<typename RESULT, typename MEASURE>
+	std::vector<RESULT> SweepSizes(std::initializer_list<unsigned> sizes, MEASURE measure)
+	{
+		std::vector<RESULT> results;
+		results.reserve(sizes.size());
+
+		for (unsigned size : sizes)
+		{
+			RESULT result;
+			measure(size, result);
+			results.push_back(result);
+		}
+
+		return results;
+	}
+
+	// Scalar kernel against the best SIMD one at 10k, 100k and 1M particles
+	std::vector<ParticleBenchmarkResult> RunParticleSimulation(unsigned iterations = 20);
+	// Scalar CPU skinning against the SSE kernel on synthetic meshes, needs no GL context
+	std::vector<SkinningBenchmarkResult> RunSkinning(unsigned iterations = 20);
+	// Builds synthetic terrains and times brute force triangle tests against the mesh BVH
+	std::vector<BVHBenchmarkResult> RunMeshBVH(unsigned rays = 256);
+	// Rasterizes random occluders with both kernels and times box tests against the result
+	std::vector<OcclusionBenchmarkResult> RunOcclusion(unsigned boxes = 4096);
+	// Compresses a synthetic clip with and without key reduction and checks the error of both
+	std::vector<AnimationCompressionBenchmarkResult> RunAnimationCompression(const AnimationCompressionOptions& options);
+	// Plays synthetic clips with cross-fades and additive layers on generated skeletons, times their
+	// evaluation on one thread and on the job system and checks the poses written to the bones
+	std::vector<AnimationBenchmarkResult> RunAnimation();
+}
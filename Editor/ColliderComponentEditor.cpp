@@ -0,0 +1,35 @@
+#include "BaseComponentEditor.h"
+#include "ColliderComponent.h"
+
+#include "IMGUI/imgui.h"
+
+DEFINE_COMPONENT_EDITOR(ColliderComponent)
+{
+	BASE_COMPONENT_EDITOR(ColliderComponent)
+
+	void DrawUI(BaseComponent* component) override;
+};
+
+void ColliderComponentEditor::DrawUI(BaseComponent* component)
+{
+	ColliderComponent* colliderComponent = static_cast<ColliderComponent*>(component);
+	assert(nullptr != colliderComponent && "Component is not of type collider component");
+
+	AABB bounds = colliderComponent->GetLocalBounds();
+	bool changed = ImGui::InputFloat3("Min", &bounds.minPoint[0], -1, ImGuiInputTextFlags_CharsDecimal);
+	changed |= ImGui::InputFloat3("Max", &bounds.maxPoint[0], -1, ImGuiInputTextFlags_CharsDecimal);
+
+	if (changed)
+		colliderComponent->SetLocalBounds(bounds);
+
+	if (ImGui::Button("Fit to meshes"))
+		colliderComponent->FitToMeshes();
+
+	const AABB& worldBounds = colliderComponent->GetWorldBounds();
+	ImGui::PushStyleColor(ImGuiCol_Text, ImColor(240, 230, 140));
+	ImGui::LabelText("", "World min: %.2f %.2f %.2f", worldBounds.minPoint.x, worldBounds.minPoint.y, worldBounds.minPoint.z);
+	ImGui::LabelText("", "World max: %.2f %.2f %.2f", worldBounds.maxPoint.x, worldBounds.maxPoint.y, worldBounds.maxPoint.z);
+	ImGui::PopStyleColor();
+}
+
+REGISTER_COMPONENT_EDITOR(ColliderComponentEditor)
@@ -10,18 +10,168 @@
 #include "ModuleTextures.h"
 #include "ModuleMaterialManager.h"
 #include "ModuleMeshManager.h"
+#include "ModuleSettings.h"
+#include "AnimationCompression.h"
+#include "MeshSimplifier.h"
+#include "ModuleRender.h"
+#include "RenderDevice.h"
 
 namespace
 {
-	void ImportMeshes(const aiScene* scene, const char* path, std::vector<Mesh*>& meshes)
+	// Buffers go through the render device, which may be running without a GL context
+	GLuint CreateBuffer(BufferTarget target, const void* data, size_t bytes)
+	{
+		return App->GetModule<ModuleRender>()->GetDevice()->CreateBuffer(target, data, bytes);
+	}
+
+	// Atlased textures cannot wrap, so only materials whose meshes keep their UVs inside [0, 1] can be packed
+	std::vector<bool> FindAtlasableMaterials(const aiScene* scene)
+	{
+		const float epsilon = 0.001f;
+		std::vector<bool> atlasable(scene->mNumMaterials, true);
+		for (size_t i = 0; i < scene->mNumMeshes; ++i)
+		{
+			aiMesh* aMesh = scene->mMeshes[i];
+			if (aMesh->mTextureCoords[0] == nullptr || !atlasable[aMesh->mMaterialIndex])
+				continue;
+
+			for (unsigned v = 0; v < aMesh->mNumVertices; ++v)
+			{
+				const aiVector3D& uv = aMesh->mTextureCoords[0][v];
+				if (uv.x < -epsilon || uv.x > 1.f + epsilon || uv.y < -epsilon || uv.y > 1.f + epsilon)
+				{
+					atlasable[aMesh->mMaterialIndex] = false;
+					break;
+				}
+			}
+		}
+
+		return atlasable;
+	}
+
+	float4x4 ToFloat4x4(const aiMatrix4x4& m)
+	{
+		return float4x4(m.a1, m.a2, m.a3, m.a4,
+			m.b1, m.b2, m.b3, m.b4,
+			m.c1, m.c2, m.c3, m.c4,
+			m.d1, m.d2, m.d3, m.d4);
+	}
+
+	// Keeps the SKINNING_INFLUENCES strongest bones of every vertex, renormalised, and uploads them next to the mesh
+	MeshSkin* ImportSkin(const aiMesh* aMesh, Mesh* mesh)
+	{
+		MeshSkin* skin = new MeshSkin;
+		unsigned vertexCount = aMesh->mNumVertices;
+
+		skin->BoneIndices.assign(vertexCount * SKINNING_INFLUENCES, 0.f);
+		skin->BoneWeights.assign(vertexCount * SKINNING_INFLUENCES, 0.f);
+
+		for (unsigned b = 0; b < aMesh->mNumBones; ++b)
+		{
+			const aiBone* bone = aMesh->mBones[b];
+			skin->BoneNames.push_back(bone->mName.data);
+			skin->InverseBindMatrices.push_back(ToFloat4x4(bone->mOffsetMatrix));
+
+			for (unsigned w = 0; w < bone->mNumWeights; ++w)
+			{
+				const aiVertexWeight& weight = bone->mWeights[w];
+				float* weights = &skin->BoneWeights[weight.mVertexId * SKINNING_INFLUENCES];
+				float* indices = &skin->BoneIndices[weight.mVertexId * SKINNING_INFLUENCES];
+
+				// Replace the weakest influence if this one is stronger
+				unsigned weakest = 0;
+				for (unsigned i = 1; i < SKINNING_INFLUENCES; ++i)
+				{
+					if (weights[i] < weights[weakest])
+						weakest = i;
+				}
+
+				if (weight.mWeight > weights[weakest])
+				{
+					weights[weakest] = weight.mWeight;
+					indices[weakest] = float(b);
+				}
+			}
+		}
+
+		for (unsigned v = 0; v < vertexCount; ++v)
+		{
+			float* weights = &skin->BoneWeights[v * SKINNING_INFLUENCES];
+			float total = 0.f;
+			for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+				total += weights[i];
+
+			if (total > 0.f)
+			{
+				for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+					weights[i] /= total;
+			}
+			else
+				weights[0] = 1.f;
+		}
+
+		skin->BindPositions.assign(reinterpret_cast<float3*>(aMesh->mVertices), reinterpret_cast<float3*>(aMesh->mVertices) + vertexCount);
+		if (aMesh->mNormals != nullptr)
+			skin->BindNormals.assign(reinterpret_cast<float3*>(aMesh->mNormals), reinterpret_cast<float3*>(aMesh->mNormals) + vertexCount);
+
+		size_t influenceBytes = sizeof(GLfloat) * vertexCount * SKINNING_INFLUENCES;
+
+		skin->BoneIndicesID = CreateBuffer(BufferTarget::Vertices, &skin->BoneIndices[0], influenceBytes);
+
+		skin->BoneWeightsID = CreateBuffer(BufferTarget::Vertices, &skin->BoneWeights[0], influenceBytes);
+
+		mesh->gpuBytes += influenceBytes * 2;
+
+		return skin;
+	}
+
+	// Each LOD clusters vertices on a grid half as fine as the last one, grids that barely simplify are skipped
+	void GenerateLods(const aiMesh* aMesh, const GLuint* indexes, unsigned lodCount, Mesh* mesh)
+	{
+		const unsigned LOD_MIN_TRIANGLES = 64;
+		const unsigned LOD_GRID_RESOLUTIONS[] = { 64, 32, 16, 8 };
+
+		if (aMesh->mVertices == nullptr || aMesh->mNumFaces < LOD_MIN_TRIANGLES)
+			return;
+
+		std::vector<uint32_t> lodIndices;
+		size_t previousTriangles = aMesh->mNumFaces;
+
+		for (unsigned resolution : LOD_GRID_RESOLUTIONS)
+		{
+			if (mesh->lods.size() >= lodCount)
+				break;
+
+			MeshSimplifier::ClusterVertices(reinterpret_cast<float3*>(aMesh->mVertices), aMesh->mNumVertices, indexes, aMesh->mNumFaces, resolution, lodIndices);
+
+			size_t triangles = lodIndices.size() / 3;
+			if (triangles == 0)
+				break;
+
+			if (triangles * 4 > previousTriangles * 3)
+				continue;
+
+			MeshLod lod;
+			lod.num_indices = unsigned(lodIndices.size());
+			lod.indexesID = CreateBuffer(BufferTarget::Indices, &lodIndices[0], sizeof(GLuint) * lodIndices.size());
+			mesh->gpuBytes += sizeof(GLuint) * lodIndices.size();
+
+			mesh->lods.push_back(lod);
+			previousTriangles = triangles;
+		}
+	}
+
+	void ImportMeshes(const aiScene* scene, const char* path, std::vector<MeshHandle>& meshes)
 	{
 		std::shared_ptr<ModuleTextures> moduleTextures = App->GetModule<ModuleTextures>();
 		std::shared_ptr<ModuleMaterialManager> materialManager = App->GetModule<ModuleMaterialManager>();
-		std::vector<Material*> materials;
+		std::vector<MaterialHandle> materials;
+		std::vector<bool> atlasable = FindAtlasableMaterials(scene);
 		for (size_t i = 0; i < scene->mNumMaterials; ++i)
 		{
 			aiMaterial* aiMat = scene->mMaterials[i];
-			Material* material = materialManager->CreateMaterial();
+			MaterialHandle materialHandle = materialManager->CreateMaterial();
+			Material* material = materialManager->GetMaterial(materialHandle);
 
 			aiColor4D ai_property;
 			float shininess;
@@ -44,22 +194,26 @@ namespace
 				aMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &fileName);
 				sprintf_s(material->FilePath, "%s%s", path, fileName.C_Str());
 
-				material->texture = moduleTextures->Load(material->FilePath);
+				material->texture = moduleTextures->Load(material->FilePath, atlasable[i]);
+				material->uvTransform = moduleTextures->GetUVTransform(material->texture);
+				moduleTextures->AddRef(material->texture);
 			}
 
-			materials.push_back(material);
+			materials.push_back(materialHandle);
 		}
 
 		std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
 		for (size_t i = 0; i < scene->mNumMeshes; ++i)
 		{
-			Mesh* mesh = meshManager->CreateMesh();
+			MeshHandle meshHandle = meshManager->CreateMesh();
+			Mesh* mesh = meshManager->GetMesh(meshHandle);
 			aiMesh* aMesh = scene->mMeshes[i];
 
 			mesh->num_vertices = aMesh->mNumVertices;
 			mesh->num_indices = aMesh->mNumFaces * 3;
 
-			mesh->material = materials[aMesh->mMaterialIndex]->id;
+			mesh->material = materials[aMesh->mMaterialIndex];
+			materialManager->AddRef(mesh->material);
 
 			GLuint* indexes = new uint32_t[aMesh->mNumFaces * 3];
 
@@ -74,30 +228,44 @@ namespace
 
 			if (aMesh->mVertices != nullptr)
 			{
-				glGenBuffers(1, &mesh->vertexID);
-				glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexID);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * mesh->num_vertices * 3, &aMesh->mVertices[0], GL_STATIC_DRAW);
+				mesh->vertexID = CreateBuffer(BufferTarget::Vertices, &aMesh->mVertices[0], sizeof(GLfloat) * mesh->num_vertices * 3);
+				mesh->gpuBytes += sizeof(GLfloat) * mesh->num_vertices * 3;
 			}
 
 			if (aMesh->mNormals != nullptr)
 			{
-				glGenBuffers(1, &mesh->normalID);
-				glBindBuffer(GL_ARRAY_BUFFER, mesh->normalID);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * mesh->num_vertices * 3, &aMesh->mNormals[0], GL_STATIC_DRAW);
+				mesh->normalID = CreateBuffer(BufferTarget::Vertices, &aMesh->mNormals[0], sizeof(GLfloat) * mesh->num_vertices * 3);
+				mesh->gpuBytes += sizeof(GLfloat) * mesh->num_vertices * 3;
 			}
 
 			if (aMesh->mTextureCoords[0] != nullptr)
 			{
-				glGenBuffers(1, &mesh->textureCoordsID);
-				glBindBuffer(GL_ARRAY_BUFFER, mesh->textureCoordsID);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(aiVector3D) * mesh->num_vertices, &aMesh->mTextureCoords[0][0], GL_STATIC_DRAW);
+				mesh->textureCoordsID = CreateBuffer(BufferTarget::Vertices, &aMesh->mTextureCoords[0][0], sizeof(aiVector3D) * mesh->num_vertices);
+				mesh->gpuBytes += sizeof(aiVector3D) * mesh->num_vertices;
+			}
+
+			if (aMesh->mVertices != nullptr)
+			{
+				if (App->GetModule<ModuleSettings>()->BuildMeshBVH)
+				{
+					mesh->bvh = new MeshBVH;
+					mesh->bvh->Build(reinterpret_cast<float3*>(aMesh->mVertices), indexes, aMesh->mNumFaces);
+				}
+				else
+					RayTriangle::BuildPacks(reinterpret_cast<float3*>(aMesh->mVertices), indexes, aMesh->mNumFaces, mesh->triangles);
 			}
 
-			glGenBuffers(1, &mesh->indexesID);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexesID);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(aiVector3D) * aMesh->mNumFaces, indexes, GL_STATIC_DRAW);
+			if (aMesh->HasBones() && aMesh->mVertices != nullptr)
+				mesh->skin = ImportSkin(aMesh, mesh);
+
+			mesh->indexesID = CreateBuffer(BufferTarget::Indices, indexes, sizeof(aiVector3D) * aMesh->mNumFaces);
+			mesh->gpuBytes += sizeof(aiVector3D) * aMesh->mNumFaces;
+
+			GenerateLods(aMesh, indexes, MIN(App->GetModule<ModuleSettings>()->MeshLods, unsigned(MAX_MESH_LODS - 1)), mesh);
 
-			meshes.push_back(mesh);
+			MemoryTracker::TrackExternal(MemoryTag::Meshes, ptrdiff_t(mesh->gpuBytes));
+
+			meshes.push_back(meshHandle);
 
 			mesh->boundingBox.SetNegativeInfinity();
 			mesh->boundingBox.Enclose(reinterpret_cast<float3*>(&aMesh->mVertices[0]), mesh->num_vertices);
@@ -106,12 +274,12 @@ namespace
 		}
 	}
 
-	void LoadNodes(aiNode* originalNode, GameObject* node, const std::vector<Mesh*>& meshes)
+	void LoadNodes(aiNode* originalNode, GameObject* node, Level& level, const std::vector<MeshHandle>& meshes)
 	{
 		if (originalNode == nullptr)
 			return;
 
-		GameObject* children = new GameObject;
+		GameObject* children = level.CreateGameObject();
 
 		children->Name = originalNode->mName.C_Str();
 		children->SetParent(node);
@@ -121,7 +289,7 @@ namespace
 		aiQuaternion rotation;
 
 		originalNode->mTransformation.Decompose(scale, rotation, position);
-		TransformComponent* transform = new TransformComponent;
+		TransformComponent* transform = level.CreateComponent<TransformComponent>();
 		transform->Position = float3(position.x, position.y, position.z);
 		transform->Scale = float3(scale.x, scale.y, scale.z);
 		transform->Rotation = Quat(rotation.x, rotation.y, rotation.z, rotation.w);
@@ -133,22 +301,23 @@ namespace
 		if (originalNode->mMeshes != nullptr)
 		{
 			vertex_boundingbox.resize(originalNode->mNumMeshes * 8);
-			MeshComponent* meshComponent = new MeshComponent;
+			MeshComponent* meshComponent = level.CreateComponent<MeshComponent>();
 			children->AddComponent(meshComponent);
 
-			MaterialComponent* materialComponent = new MaterialComponent;
+			MaterialComponent* materialComponent = level.CreateComponent<MaterialComponent>();
 			children->AddComponent(materialComponent);
 
 			meshComponent->MaterialComponent = materialComponent;
-			std::shared_ptr<ModuleMaterialManager> materialManager = App->GetModule<ModuleMaterialManager>();
+			std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
 
 			for (size_t i = 0; i < originalNode->mNumMeshes; ++i)
 			{
-				Mesh* mesh = meshes[originalNode->mMeshes[i]];
+				MeshHandle meshHandle = meshes[originalNode->mMeshes[i]];
+				Mesh* mesh = meshManager->GetMesh(meshHandle);
 
-				mesh->materialInComponent = materialComponent->AddMaterial(materialManager->GetMaterial(mesh->material));
+				mesh->materialInComponent = materialComponent->AddMaterial(mesh->material);
 
-				meshComponent->Meshes.push_back(mesh);
+				meshComponent->AddMesh(meshHandle);
 
 				mesh->boundingBox.GetCornerPoints(&vertex_boundingbox[i * 8]);
 			}
@@ -160,7 +329,7 @@ namespace
 
 		for (size_t i = 0; i < originalNode->mNumChildren; ++i)
 		{
-			LoadNodes(originalNode->mChildren[i], children, meshes);
+			LoadNodes(originalNode->mChildren[i], children, level, meshes);
 		}
 	}
 }
@@ -175,13 +344,17 @@ std::shared_ptr<Level> DataImporter::ImportLevel(const char* path, const char* f
 
 	aiNode* node = scene->mRootNode;
 
-	std::vector<Mesh*> meshes;
-	meshes.reserve(scene->mNumMeshes);
-	ImportMeshes(scene, path, meshes);
+	std::vector<MeshHandle> meshes;
+	{
+		MEMORY_TAG_SCOPE(MemoryTag::Meshes);
+		meshes.reserve(scene->mNumMeshes);
+		ImportMeshes(scene, path, meshes);
+	}
 
+	MEMORY_TAG_SCOPE(MemoryTag::SceneGraph);
 	std::shared_ptr<Level> level = std::make_shared<Level>();
 
-	LoadNodes(node, level->GetRootNode(), meshes);
+	LoadNodes(node, level->GetRootNode(), *level, meshes);
 	level->RegenerateQuadtree(); // TODO: Improve quadtree generation
 
 	aiReleaseImport(scene);
@@ -193,34 +366,65 @@ std::shared_ptr<Animation> DataImporter::ImportAnimation(const char* name, const
 {
 	LOG("Loading animation %s", filePath);
 
+	MEMORY_TAG_SCOPE(MemoryTag::Animation);
 	const aiScene* scene = aiImportFile(filePath, aiProcessPreset_TargetRealtime_MaxQuality);
+	if (scene == nullptr || scene->mNumAnimations == 0)
+	{
+		LOG("Animation %s could not be loaded", filePath);
+		if (scene != nullptr)
+			aiReleaseImport(scene);
+		return nullptr;
+	}
 
-	aiAnimation** animations = scene->mAnimations;
+	const aiAnimation* aiAnimation = scene->mAnimations[0];
 
-	std::shared_ptr<Animation> animation = App->GetModule<ModuleAnimation>()->CreateAnimation(name);
-	animation->Duration = animations[0]->mDuration;
-	animation->Channels = std::vector<Channel*>(animations[0]->mNumChannels);
+	// Keys are stored in seconds, assimp leaves the rate at 0 when the file does not specify it
+	double ticksPerSecond = aiAnimation->mTicksPerSecond > 0.0 ? aiAnimation->mTicksPerSecond : 25.0;
+
+	float duration = float(aiAnimation->mDuration / ticksPerSecond);
+	std::vector<Channel> channels(aiAnimation->mNumChannels);
 
-	for (unsigned int i = 0; i < animations[0]->mNumChannels; ++i)
+	for (unsigned int i = 0; i < aiAnimation->mNumChannels; ++i)
 	{
-		aiNodeAnim* aiNodeAnim = animations[0]->mChannels[i];
-		
-		animation->Channels[i] = new Channel();
-		animation->Channels[i]->NodeName = aiNodeAnim->mNodeName.C_Str();
+		const aiNodeAnim* aiNodeAnim = aiAnimation->mChannels[i];
+		Channel& channel = channels[i];
+		channel.NodeName = aiNodeAnim->mNodeName.C_Str();
 
-		for(unsigned int j = 0; j < aiNodeAnim->mNumPositionKeys; ++j)
+		channel.PositionTimes.reserve(aiNodeAnim->mNumPositionKeys);
+		channel.Positions.reserve(aiNodeAnim->mNumPositionKeys);
+		for (unsigned int j = 0; j < aiNodeAnim->mNumPositionKeys; ++j)
 		{
-			aiVector3D position = aiNodeAnim->mPositionKeys[j].mValue;
-			animation->Channels[i]->Positions.push_back(&float3(position.x, position.y, position.z));
+			const aiVectorKey& key = aiNodeAnim->mPositionKeys[j];
+			channel.PositionTimes.push_back(float(key.mTime / ticksPerSecond));
+			channel.Positions.push_back(float3(key.mValue.x, key.mValue.y, key.mValue.z));
 		}
 
+		channel.RotationTimes.reserve(aiNodeAnim->mNumRotationKeys);
+		channel.Rotations.reserve(aiNodeAnim->mNumRotationKeys);
 		for (unsigned int j = 0; j < aiNodeAnim->mNumRotationKeys; ++j)
 		{
-			aiQuaternion rotation = aiNodeAnim->mRotationKeys[j].mValue;
-			animation->Channels[i]->Rotations.push_back(&Quat(rotation.x, rotation.y, rotation.z, rotation.w));
+			const aiQuatKey& key = aiNodeAnim->mRotationKeys[j];
+			channel.RotationTimes.push_back(float(key.mTime / ticksPerSecond));
+			channel.Rotations.push_back(Quat(key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w));
+		}
+
+		channel.ScaleTimes.reserve(aiNodeAnim->mNumScalingKeys);
+		channel.Scales.reserve(aiNodeAnim->mNumScalingKeys);
+		for (unsigned int j = 0; j < aiNodeAnim->mNumScalingKeys; ++j)
+		{
+			const aiVectorKey& key = aiNodeAnim->mScalingKeys[j];
+			channel.ScaleTimes.push_back(float(key.mTime / ticksPerSecond));
+			channel.Scales.push_back(float3(key.mValue.x, key.mValue.y, key.mValue.z));
 		}
 	}
 
+	std::shared_ptr<Animation> animation = App->GetModule<ModuleAnimation>()->CreateAnimation(name);
+	AnimationCompression::Compress(channels, duration, AnimationCompression::GetOptionsFromSettings(), *animation);
+
+	AnimationCompressionError error = AnimationCompression::MeasureError(channels, *animation);
+	LOG("Animation %s compressed from %i to %i bytes, max error %.5f units, %.5f rad, %.5f scale", name, int(AnimationCompression::GetRawSize(channels)),
+		int(animation->GetMemoryUsage()), error.Position, error.Rotation, error.Scale);
+
 	aiReleaseImport(scene);
 
 	return animation;
@@ -4,6 +4,12 @@
 #include "Engine.h"
 #include "ModuleWindow.h"
 #include "EditorUtils.h"
+#include "ModuleTextures.h"
+#include "ModuleMeshManager.h"
+#include "ModuleLevelManager.h"
+#include "Level.h"
+#include "ModuleRender.h"
+#include "RecordingRenderDevice.h"
 
 namespace
 {
@@ -25,6 +31,10 @@ private:
 	std::list<float> _fpsValues;
 
 	std::shared_ptr<ModuleWindow> _moduleWindow;
+	std::shared_ptr<ModuleTextures> _moduleTextures;
+	std::shared_ptr<ModuleMeshManager> _meshManager;
+	std::shared_ptr<ModuleLevelManager> _levelManager;
+	std::shared_ptr<ModuleRender> _moduleRender;
 };
 
 REGISTER_EDITOR_SUBMODULE(EngineStatsEditor)
@@ -32,6 +42,10 @@ REGISTER_EDITOR_SUBMODULE(EngineStatsEditor)
 void EngineStatsEditor::Init()
 {
 	_moduleWindow = App->GetModule<ModuleWindow>();
+	_moduleTextures = App->GetModule<ModuleTextures>();
+	_meshManager = App->GetModule<ModuleMeshManager>();
+	_levelManager = App->GetModule<ModuleLevelManager>();
+	_moduleRender = App->GetModule<ModuleRender>();
 }
 
 void EngineStatsEditor::Update()
@@ -53,6 +67,27 @@ void EngineStatsEditor::Update()
 		if (ImGui::BeginChild("Histogram", ImVec2(0, 0), true))
 		{
 			ImGui::Text("FPS: %f", framerate);
+
+			float textureMemory = _moduleTextures->GetResidentMemory() / (1024.f * 1024.f);
+			if (_moduleTextures->GetMemoryBudget() > 0)
+				ImGui::Text("Textures: %.1f / %.1f MB", textureMemory, _moduleTextures->GetMemoryBudget() / (1024.f * 1024.f));
+			else
+				ImGui::Text("Textures: %.1f MB", textureMemory);
+			ImGui::Text("Atlas pages: %i", int(_moduleTextures->GetAtlasPageCount()));
+			ImGui::Text("Meshes per LOD: %u / %u / %u / %u", _meshManager->GetLodDrawCount(0), _meshManager->GetLodDrawCount(1),
+				_meshManager->GetLodDrawCount(2), _meshManager->GetLodDrawCount(3));
+			const OcclusionStats& occlusion = _levelManager->GetCurrentLevel().GetOcclusionStats();
+			ImGui::Text("Occluded: %u / %u (%u occluder triangles)", occlusion.Culled, occlusion.Tested, occlusion.OccluderTriangles);
+			ImGui::Text("Render jobs: %u", _levelManager->GetCurrentLevel().GetRenderJobCount());
+
+			RecordingRenderDevice* recording = dynamic_cast<RecordingRenderDevice*>(_moduleRender->GetDevice());
+			if (recording != nullptr)
+			{
+				const RenderStats& render = recording->GetFrameStats();
+				ImGui::Text("Draw calls: %u (%u primitives)", render.DrawCalls, render.Primitives);
+				ImGui::Text("State changes: %u (%u redundant), errors: %u", render.StateChanges, render.RedundantStateChanges, render.Errors);
+			}
+
 			ImGui::PlotHistogram("Framerate", &ListGetter, &_fpsValues, _fpsValues.size(), 0, nullptr, 0, 120);
 		}
 
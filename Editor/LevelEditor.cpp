@@ -6,8 +6,14 @@
 #include "ModuleLevelManager.h"
 #include "Level.h"
 #include "BaseComponentEditor.h"
+#include "ModuleInput.h"
+#include "ModuleCameraManager.h"
+#include "CameraComponent.h"
+#include "SceneQuery.h"
+#include "ModuleAnimation.h"
 
 #include "IMGUI/imgui.h"
+#include <SDL.h>
 #include <unordered_map>
 #include <typeindex>
 
@@ -38,14 +44,21 @@ public:
 
 private:
 	void drawProperties();
+	void drawAnimation();
 	void drawLevelHierachy();
 	void drawLevelHierachy(GameObject* node);
+	void pickGameObject();
 
 	GameObject* _selectedGameObject = nullptr;
+	int _selectedAnimation = 0;
+	float _fadeTime = 0.3f;
 	std::unordered_map<std::type_index, BaseComponentEditor*> _componentEditors;
 
 	std::shared_ptr<ModuleWindow> _moduleWindow;
 	std::shared_ptr<ModuleLevelManager> _levelManager;
+	std::shared_ptr<ModuleInput> _moduleInput;
+	std::shared_ptr<ModuleCameraManager> _cameraManager;
+	std::shared_ptr<ModuleAnimation> _animation;
 };
 
 REGISTER_EDITOR_SUBMODULE(LevelEditor);
@@ -62,12 +75,16 @@ void LevelEditor::Init()
 
 	_moduleWindow = App->GetModule<ModuleWindow>();
 	_levelManager = App->GetModule<ModuleLevelManager>();
+	_moduleInput = App->GetModule<ModuleInput>();
+	_cameraManager = App->GetModule<ModuleCameraManager>();
+	_animation = App->GetModule<ModuleAnimation>();
 }
 
 void LevelEditor::Update()
 {
 	drawProperties();
 	drawLevelHierachy();
+	pickGameObject();
 
 	if (nullptr != _selectedGameObject)
 	{
@@ -140,11 +157,55 @@ void LevelEditor::drawProperties()
 				}
 				ImGui::PopID();
 			}
+
+			drawAnimation();
 		}
 	}
 	ImGui::End();
 }
 
+void LevelEditor::drawAnimation()
+{
+	std::vector<std::string> names = _animation->GetAnimationNames();
+	if (names.empty() || !ImGui::CollapsingHeader("Animation", ImGuiTreeNodeFlags_DefaultOpen))
+		return;
+
+	std::vector<const char*> items;
+	for (const std::string& name : names)
+		items.push_back(name.c_str());
+
+	_selectedAnimation = MIN(_selectedAnimation, int(items.size()) - 1);
+	ImGui::Combo("Clip", &_selectedAnimation, items.data(), int(items.size()));
+	const std::string& clip = names[_selectedAnimation];
+
+	// Channels are bound to the nodes with the same name under the selected object
+	unsigned instance = _animation->GetInstance(_selectedGameObject);
+	if (instance == 0)
+	{
+		if (ImGui::Button("Play"))
+			_animation->Play(clip, _selectedGameObject);
+	}
+	else
+	{
+		ImGui::DragFloat("Fade time", &_fadeTime, 0.01f, 0.f, 5.f);
+
+		if (ImGui::Button("Cross-fade"))
+			_animation->CrossFade(instance, clip, _fadeTime);
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Add additive"))
+			_animation->AddAdditive(instance, clip, 1.f);
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Stop"))
+			_animation->Stop(instance);
+	}
+
+	ImGui::Text("%i instances playing", int(_animation->GetInstanceCount()));
+}
+
 void LevelEditor::drawLevelHierachy()
 {
 	int w, h;
@@ -184,3 +245,23 @@ void LevelEditor::drawLevelHierachy(GameObject* node)
 		ImGui::TreePop();
 	}
 }
+
+void LevelEditor::pickGameObject()
+{
+	// Clicks on editor windows are for ImGui
+	if (_moduleInput->GetMouseButtonDown(SDL_BUTTON_LEFT) != KEY_DOWN || ImGui::GetIO().WantCaptureMouse)
+		return;
+
+	int w, h;
+	_moduleWindow->GetWindowSize(w, h);
+
+	const iPoint& mouse = _moduleInput->GetMousePosition();
+	float x = 2.f * mouse.x / w - 1.f;
+	float y = 1.f - 2.f * mouse.y / h;
+
+	CameraComponent* camera = _cameraManager->GetMainCamera();
+	RaycastHit hit;
+	SceneQuery::Raycast(_levelManager->GetCurrentLevel(), camera->GetPickingRay(x, y), camera->GetFrustum().FarPlaneDistance(), hit);
+
+	_selectedGameObject = hit.Object;
+}
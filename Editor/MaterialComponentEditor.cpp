@@ -1,5 +1,7 @@
 #include "BaseComponentEditor.h"
 #include "MaterialComponent.h"
+#include "ModuleMaterialManager.h"
+#include "Engine.h"
 
 #include "IMGUI/imgui.h"
 
@@ -22,7 +24,7 @@ void MaterialComponentEditor::DrawUI(BaseComponent* component)
 		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_AllowOverlapMode;
 		if (ImGui::TreeNodeEx(name, flags))
 		{
-			Material* mat = materialComponent->Materials[i];
+			Material* mat = App->GetModule<ModuleMaterialManager>()->GetMaterial(materialComponent->Materials[i]);
 
 			char* path = mat->FilePath;
 			if (strcmp(path, "") == 0)
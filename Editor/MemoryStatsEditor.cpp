@@ -0,0 +1,71 @@
+#include "IMGUI/imgui.h"
+
+#include "EditorSubmodule.h"
+#include "Engine.h"
+#include "ModuleWindow.h"
+#include "EditorUtils.h"
+
+class MemoryStatsEditor : public EditorSubmodule
+{
+public:
+	void Init() override;
+	void Update() override;
+
+private:
+	std::shared_ptr<ModuleWindow> _moduleWindow;
+};
+
+REGISTER_EDITOR_SUBMODULE(MemoryStatsEditor)
+
+void MemoryStatsEditor::Init()
+{
+	_moduleWindow = App->GetModule<ModuleWindow>();
+}
+
+void MemoryStatsEditor::Update()
+{
+	int w, h;
+	_moduleWindow->GetWindowSize(w, h);
+
+	ImVec2 windowPosition(502, h - 200);
+	ImGui::SetNextWindowSize(ImVec2(460, 200), ImGuiSetCond_Always);
+	ImGui::SetNextWindowPos(windowPosition, ImGuiSetCond_Always);
+	if (ImGui::Begin("Memory", nullptr, ImGuiWindowFlags_AlwaysUseWindowPadding))
+	{
+		ImGui::Text("Allocations last frame: %i", int(MemoryTracker::GetFrameAllocations()));
+
+		ImGui::Columns(5, "MemoryTags");
+		ImGui::Text("Tag"); ImGui::NextColumn();
+		ImGui::Text("Heap KB"); ImGui::NextColumn();
+		ImGui::Text("Allocs"); ImGui::NextColumn();
+		ImGui::Text("Frame"); ImGui::NextColumn();
+		ImGui::Text("GPU KB"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+		{
+			MemoryTag tag = MemoryTag(i);
+			MemoryTagStats stats = MemoryTracker::GetStats(tag);
+
+			bool overBudget = MemoryTracker::IsOverBudget(tag);
+			if (overBudget)
+				ImGui::PushStyleColor(ImGuiCol_Text, ImColor(255, 80, 80));
+
+			ImGui::Text("%s", MemoryTracker::GetTagName(tag)); ImGui::NextColumn();
+			if (stats.Budget > 0)
+				ImGui::Text("%i / %i", int(stats.Bytes / 1024), int(stats.Budget / 1024));
+			else
+				ImGui::Text("%i", int(stats.Bytes / 1024));
+			ImGui::NextColumn();
+			ImGui::Text("%i", int(stats.Allocations)); ImGui::NextColumn();
+			ImGui::Text("%i", int(stats.FrameAllocations)); ImGui::NextColumn();
+			ImGui::Text("%i", int(stats.ExternalBytes / 1024)); ImGui::NextColumn();
+
+			if (overBudget)
+				ImGui::PopStyleColor();
+		}
+
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
@@ -1,5 +1,7 @@
 #include "BaseComponentEditor.h"
 #include "MeshComponent.h"
+#include "ModuleMeshManager.h"
+#include "Engine.h"
 
 #include "IMGUI/imgui.h"
 
@@ -21,8 +23,10 @@ void MeshComponentEditor::DrawUI(BaseComponent* component)
 	int vertex, indices;
 	vertex = indices = 0;
 	int i = 0;
-	for (Mesh* mesh : meshComponent->Meshes)
+	std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
+	for (MeshHandle meshHandle : meshComponent->Meshes)
 	{
+		const Mesh* mesh = meshManager->GetMesh(meshHandle);
 		vertex += mesh->num_vertices;
 		indices += mesh->num_indices;
 		ImGui::LabelText("", "Mesh %i: %i triangles (%i indices, %i vertices)", i, mesh->num_indices / 3, mesh->num_indices,
@@ -16,6 +16,9 @@
 #include "ModuleAnimation.h"
 #include "ModuleLevelManager.h"
 #include "ModuleTextures.h"
+#include "ModuleSettings.h"
+#include "ModuleRender.h"
+#include "RenderDevice.h"
 
 ModuleEditor::~ModuleEditor()
 {
@@ -25,14 +28,19 @@ bool ModuleEditor::Init()
 {
 	LOG("Initializing Editor module");
 	_dataImporter = new DataImporter;
+	// The UI is drawn with GL, so a render device without a context runs like a headless one
+	_headless = App->GetModule<ModuleSettings>()->Headless || !App->GetModule<ModuleRender>()->GetDevice()->HasContext();
 
 	IEditorSubmoduleFactoryDictionary* submoduleFactoryDictionary = GetEditorSubmoduleFactoryDictionary();
-	_submodules.reserve(submoduleFactoryDictionary->Size());
-	for (EditorSubmoduleFactoryBase* submoduleFactory : submoduleFactoryDictionary->GetAllFactories())
+	if (!_headless)
 	{
-		EditorSubmodule* submodule = submoduleFactory->Instantiate();
-		submodule->Init();
-		_submodules.push_back(submodule);
+		_submodules.reserve(submoduleFactoryDictionary->Size());
+		for (EditorSubmoduleFactoryBase* submoduleFactory : submoduleFactoryDictionary->GetAllFactories())
+		{
+			EditorSubmodule* submodule = submoduleFactory->Instantiate();
+			submodule->Init();
+			_submodules.push_back(submodule);
+		}
 	}
 	submoduleFactoryDictionary->Clear();
 	LOG("Registered %d editor submodules", _submodules.size());
@@ -44,24 +52,31 @@ bool ModuleEditor::Init()
 
 bool ModuleEditor::Start()
 {
-	ImGui_ImplSdlGL3_Init(_moduleWindow->window);
+	if (!_headless)
+	{
+		ImGui_ImplSdlGL3_Init(_moduleWindow->window);
+
+		// The UI goes over the frame once it is submitted, recorded or not
+		App->GetModule<ModuleRender>()->SetOverlay([]() { ImGui::Render(); });
+	}
 
 	for (EditorSubmodule* submodule : _submodules)
 	{
 		submodule->Start();
 	}
 
-	App->SetUpdateState(Engine::UpdateState::Stopped);
+	// Nobody is there to press play on a headless run
+	App->SetUpdateState(_headless ? Engine::UpdateState::Playing : Engine::UpdateState::Stopped);
 
 
 	std::shared_ptr<Level> level = GetDataImporter()->ImportLevel("Models/street/", "Street.obj");
 	GetDataImporter()->ImportAnimation("Idle", "Models/ArmyPilot/Animations/ArmyPilot_Idle.fbx");
 
 	////////////
-	GameObject* goPS = new GameObject;
-	TransformComponent* transform = new TransformComponent;
-	ParticleEmitter* peComponent = new ParticleEmitter(200, float2(50.f, 50.f), 20.f, 1.2f, 15.f);
-	unsigned rainTex = App->GetModule<ModuleTextures>()->Load("Models/rainSprite.tga");
+	GameObject* goPS = level->CreateGameObject();
+	TransformComponent* transform = level->SpawnComponent<TransformComponent>();
+	ParticleEmitter* peComponent = level->SpawnComponent<ParticleEmitter>(200, float2(50.f, 50.f), 20.f, 1.2f, 15.f);
+	TextureHandle rainTex = App->GetModule<ModuleTextures>()->Load("Models/rainSprite.tga", true);
 	//unsigned snowTex = App->textures->Load("Models/simpleflake.tga");
 	peComponent->SetTexture(rainTex);
 	goPS->Name = "ParticleSystem";
@@ -77,13 +92,18 @@ bool ModuleEditor::Start()
 
 update_status ModuleEditor::PreUpdate(float DeltaTime)
 {
-	ImGui_ImplSdlGL3_NewFrame(_moduleWindow->window);
+	if (!_headless)
+		ImGui_ImplSdlGL3_NewFrame(_moduleWindow->window);
 
 	return UPDATE_CONTINUE;
 }
 
 update_status ModuleEditor::Update(float DeltaTime)
 {
+	MEMORY_TAG_SCOPE(MemoryTag::Editor);
+	if (_headless)
+		return UPDATE_CONTINUE;
+
 	int w, h;
 	_moduleWindow->GetWindowSize(w, h);
 
@@ -125,8 +145,6 @@ update_status ModuleEditor::Update(float DeltaTime)
 	}
 	ImGui::End();
 
-	ImGui::Render();
-
 	return UPDATE_CONTINUE;
 }
 
@@ -139,7 +157,8 @@ bool ModuleEditor::CleanUp()
 {
 	LOG("Shutting down Engine module");
 
-	ImGui_ImplSdlGL3_Shutdown();
+	if (!_headless)
+		ImGui_ImplSdlGL3_Shutdown();
 
 	for (EditorSubmodule* submodule : _submodules)
 	{
@@ -29,6 +29,7 @@ public:
 
 private:
 	bool _drawHierachy = false;
+	bool _headless = false; // Loads the level and plays it without any UI
 	std::list<float> _fpsValues;
 	std::vector<EditorSubmodule*> _submodules;
 	DataImporter* _dataImporter = nullptr;
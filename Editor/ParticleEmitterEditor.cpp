@@ -23,11 +23,20 @@ void ParticleEmitterEditor::DrawUI(BaseComponent* component)
 		emitter->CleanUp();
 	}
 
+	ImGui::LabelText("", "Alive particles: %i / %i", emitter->GetParticles().Size(), emitter->GetParticles().Capacity());
+
 	ImGui::InputFloat2("Emit Area", &emitter->EmitArea[0], -1, ImGuiInputTextFlags_CharsDecimal);
 	ImGui::InputInt("Max Particles", &emitter->MaxParticles, -1);
 	ImGui::InputFloat("Fall Height", &emitter->FallHeight, -1, ImGuiInputTextFlags_CharsDecimal);
 	ImGui::InputFloat("Fall Speed", &emitter->FallSpeed, -1, ImGuiInputTextFlags_CharsDecimal);
 	ImGui::InputFloat("Particle's LifeTime", &emitter->LifeTime, -1, ImGuiInputTextFlags_CharsDecimal);
+
+	int seed = int(emitter->Seed);
+	if (ImGui::InputInt("Seed", &seed))
+	{
+		emitter->Seed = unsigned(seed);
+		emitter->CleanUp();
+	}
 }
 
 REGISTER_COMPONENT_EDITOR(ParticleEmitterEditor)
@@ -0,0 +1,52 @@
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <cstddef>
+#include <new>
+
+class Allocator
+{
+public:
+	virtual ~Allocator() {}
+
+	virtual void* Allocate(size_t size) = 0;
+	virtual void Free(void* ptr) = 0;
+};
+
+/*
+ * Objects created through DECLARE_ALLOCATED_NEW remember the allocator that owns them in a small header,
+ * so a plain delete returns the memory to the right place. Objects created with a plain new live on the heap.
+ */
+namespace AllocatorUtils
+{
+	const size_t OWNER_HEADER_SIZE = 16;
+
+	inline void* AllocateOwned(size_t size, Allocator* owner)
+	{
+		char* memory = static_cast<char*>(owner != nullptr ? owner->Allocate(size + OWNER_HEADER_SIZE) : ::operator new(size + OWNER_HEADER_SIZE));
+		*reinterpret_cast<Allocator**>(memory) = owner;
+		return memory + OWNER_HEADER_SIZE;
+	}
+
+	inline void FreeOwned(void* ptr)
+	{
+		if (ptr == nullptr)
+			return;
+
+		char* memory = static_cast<char*>(ptr) - OWNER_HEADER_SIZE;
+		Allocator* owner = *reinterpret_cast<Allocator**>(memory);
+		if (owner != nullptr)
+			owner->Free(memory);
+		else
+			::operator delete(memory);
+	}
+}
+
+#define DECLARE_ALLOCATED_NEW \
+	public: \
+		static void* operator new(size_t size) { return AllocatorUtils::AllocateOwned(size, nullptr); } \
+		static void* operator new(size_t size, Allocator& allocator) { return AllocatorUtils::AllocateOwned(size, &allocator); } \
+		static void operator delete(void* ptr) { AllocatorUtils::FreeOwned(ptr); } \
+		static void operator delete(void* ptr, Allocator&) { AllocatorUtils::FreeOwned(ptr); }
+
+#endif // __ALLOCATOR_H__
@@ -0,0 +1,427 @@
+#include "AnimationCompression.h"
+#include "Engine.h"
+#include "ModuleSettings.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define QUANTISED_MAX 65535.f
+#define QUATERNION_COMPONENT_MAX 0.70710678f // No component other than the largest can exceed 1/sqrt(2)
+#define QUATERNION_COMPONENT_STEPS 32767.f // 15 bits, the top bits of the first two words hold the index
+#define HEAP_BLOCK_ALIGNMENT 16
+
+namespace
+{
+	uint16_t Quantise(float value, float min, float extent)
+	{
+		if (extent <= 0.f)
+			return 0;
+
+		float normalised = MIN(MAX((value - min) / extent, 0.f), 1.f);
+		return uint16_t(normalised * QUANTISED_MAX + 0.5f);
+	}
+
+	float Dequantise(uint16_t value, float min, float extent)
+	{
+		return min + value * (extent / QUANTISED_MAX);
+	}
+
+	void EncodeRotation(const Quat& rotation, uint16_t* output)
+	{
+		Quat q = rotation.Normalized();
+		float components[4] = { q.x, q.y, q.z, q.w };
+
+		unsigned largest = 0;
+		for (unsigned i = 1; i < 4; ++i)
+		{
+			if (fabsf(components[i]) > fabsf(components[largest]))
+				largest = i;
+		}
+
+		// q and -q are the same rotation, keep the dropped component positive so it can be rebuilt
+		float sign = components[largest] < 0.f ? -1.f : 1.f;
+
+		unsigned written = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+
+			float normalised = MIN(MAX(components[i] * sign / QUATERNION_COMPONENT_MAX, -1.f), 1.f);
+			output[written++] = uint16_t((normalised * 0.5f + 0.5f) * QUATERNION_COMPONENT_STEPS + 0.5f);
+		}
+
+		output[0] |= uint16_t((largest & 1) << 15);
+		output[1] |= uint16_t((largest >> 1) << 15);
+	}
+
+	Quat DecodeRotation(const uint16_t* input)
+	{
+		unsigned largest = (input[0] >> 15) | ((input[1] >> 15) << 1);
+
+		float components[4];
+		float sumSquares = 0.f;
+		unsigned read = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+
+			float normalised = (input[read++] & 0x7FFF) / QUATERNION_COMPONENT_STEPS * 2.f - 1.f;
+			components[i] = normalised * QUATERNION_COMPONENT_MAX;
+			sumSquares += components[i] * components[i];
+		}
+		components[largest] = sqrtf(MAX(1.f - sumSquares, 0.f));
+
+		return Quat(components[0], components[1], components[2], components[3]);
+	}
+
+	// acos of the dot product cannot resolve angles under about 1e-3 rad in floats, the tolerances are that small
+	float RotationAngle(const Quat& a, const Quat& b)
+	{
+		Quat difference = a.Conjugated() * b;
+		float sine = sqrtf(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+		return 2.f * atan2f(sine, fabsf(difference.w));
+	}
+
+	// Allocator header and rounding of a small heap block
+	size_t HeapBlockSize(size_t size)
+	{
+		size_t block = size + 2 * sizeof(void*);
+		return (block + HEAP_BLOCK_ALIGNMENT - 1) & ~size_t(HEAP_BLOCK_ALIGNMENT - 1);
+	}
+
+	template<typename ValueType>
+	size_t PointerPerKeySize(const std::vector<ValueType>& values)
+	{
+		return values.size() * (sizeof(float) + sizeof(ValueType*) + HeapBlockSize(sizeof(ValueType)));
+	}
+
+	// Largest speed between consecutive keys, the time quantisation shifts samples by up to half a step
+	template<typename ValueType, typename ErrorFunction>
+	float MaxSpeed(const std::vector<float>& times, const std::vector<ValueType>& values, ErrorFunction error)
+	{
+		float speed = 0.f;
+		for (size_t i = 1; i < values.size(); ++i)
+		{
+			float length = times[i] - times[i - 1];
+			if (length > 0.f)
+				speed = MAX(speed, error(values[i - 1], values[i]) / length);
+		}
+		return speed;
+	}
+
+	// Greedy reduction: a key is dropped while interpolating between the last kept key and the next
+	// one still reproduces every skipped key within the error
+	template<typename ValueType, typename InterpolateFunction, typename ErrorFunction>
+	std::vector<unsigned> ReduceKeys(const std::vector<float>& times, const std::vector<ValueType>& values, float maxError, InterpolateFunction interpolate, ErrorFunction error)
+	{
+		std::vector<unsigned> kept;
+		unsigned count = unsigned(values.size());
+		if (count == 0)
+			return kept;
+
+		kept.push_back(0);
+
+		// A constant track only needs one key, sampling it returns the first value at every time
+		bool constant = true;
+		for (unsigned key = 1; key < count && constant; ++key)
+			constant = error(values[0], values[key]) <= maxError;
+
+		if (constant)
+			return kept;
+
+		for (unsigned candidate = 1; candidate + 1 < count; ++candidate)
+		{
+			unsigned first = kept.back();
+			unsigned next = candidate + 1;
+			float length = times[next] - times[first];
+
+			bool canDrop = true;
+			for (unsigned skipped = first + 1; skipped < next && canDrop; ++skipped)
+			{
+				float t = length > 0.f ? (times[skipped] - times[first]) / length : 0.f;
+				canDrop = error(interpolate(values[first], values[next], t), values[skipped]) <= maxError;
+			}
+
+			if (!canDrop)
+				kept.push_back(candidate);
+		}
+
+		kept.push_back(count - 1);
+		return kept;
+	}
+
+	std::vector<unsigned> AllKeys(size_t count)
+	{
+		std::vector<unsigned> keys(count);
+		for (unsigned i = 0; i < count; ++i)
+			keys[i] = i;
+		return keys;
+	}
+
+	void WriteVectorTrack(const std::vector<float>& times, const std::vector<float3>& values, const std::vector<unsigned>& keys, float duration, Animation& clip, AnimationTrack& track)
+	{
+		track.FirstKey = uint32_t(clip.Keys.size() / Animation::KEY_STRIDE);
+		track.KeyCount = uint32_t(keys.size());
+		if (keys.empty())
+			return;
+
+		float3 min = values[keys[0]];
+		float3 max = values[keys[0]];
+		for (unsigned key : keys)
+		{
+			min = min.Min(values[key]);
+			max = max.Max(values[key]);
+		}
+		track.Min = min;
+		track.Extent = max - min;
+
+		for (unsigned key : keys)
+		{
+			clip.Keys.push_back(Quantise(times[key], 0.f, duration));
+			for (unsigned axis = 0; axis < 3; ++axis)
+				clip.Keys.push_back(Quantise(values[key][axis], track.Min[axis], track.Extent[axis]));
+		}
+	}
+
+	void WriteRotationTrack(const std::vector<float>& times, const std::vector<Quat>& values, const std::vector<unsigned>& keys, float duration, Animation& clip, AnimationTrack& track)
+	{
+		track.FirstKey = uint32_t(clip.Keys.size() / Animation::KEY_STRIDE);
+		track.KeyCount = uint32_t(keys.size());
+
+		for (unsigned key : keys)
+		{
+			clip.Keys.push_back(Quantise(times[key], 0.f, duration));
+
+			uint16_t components[3];
+			EncodeRotation(values[key], components);
+			clip.Keys.insert(clip.Keys.end(), components, components + 3);
+		}
+	}
+
+	// Returns the first key of the segment containing time, in the units of the quantised key times
+	unsigned FindKey(const uint16_t* keys, unsigned count, float time, unsigned cursor)
+	{
+		if (count < 2)
+			return 0;
+
+		if (cursor + 1 < count && keys[cursor * Animation::KEY_STRIDE] <= time)
+		{
+			if (time < keys[(cursor + 1) * Animation::KEY_STRIDE])
+				return cursor;
+
+			if (cursor + 2 < count && time < keys[(cursor + 2) * Animation::KEY_STRIDE])
+				return cursor + 1;
+		}
+
+		unsigned low = 0;
+		unsigned high = count - 1;
+		while (low + 1 < high)
+		{
+			unsigned middle = (low + high) / 2;
+			if (keys[middle * Animation::KEY_STRIDE] <= time)
+				low = middle;
+			else
+				high = middle;
+		}
+
+		return low;
+	}
+
+	float SegmentFactor(const uint16_t* first, const uint16_t* second, float time)
+	{
+		float length = float(second[0]) - float(first[0]);
+		if (length <= 0.f)
+			return 0.f;
+
+		return MIN(MAX((time - first[0]) / length, 0.f), 1.f);
+	}
+
+	float3 DecodeVector(const uint16_t* key, const AnimationTrack& track)
+	{
+		return float3(Dequantise(key[1], track.Min.x, track.Extent.x),
+			Dequantise(key[2], track.Min.y, track.Extent.y),
+			Dequantise(key[3], track.Min.z, track.Extent.z));
+	}
+
+	void SampleVector(const Animation& clip, const AnimationTrack& track, float time, unsigned& cursor, float3& result)
+	{
+		if (track.KeyCount == 0)
+			return;
+
+		const uint16_t* keys = &clip.Keys[track.FirstKey * Animation::KEY_STRIDE];
+		if (track.KeyCount == 1)
+		{
+			result = DecodeVector(keys, track);
+			return;
+		}
+
+		cursor = FindKey(keys, track.KeyCount, time, cursor);
+		const uint16_t* first = keys + cursor * Animation::KEY_STRIDE;
+		const uint16_t* second = first + Animation::KEY_STRIDE;
+		result = DecodeVector(first, track).Lerp(DecodeVector(second, track), SegmentFactor(first, second, time));
+	}
+
+	void SampleRotation(const Animation& clip, const AnimationTrack& track, float time, unsigned& cursor, Quat& result)
+	{
+		if (track.KeyCount == 0)
+			return;
+
+		const uint16_t* keys = &clip.Keys[track.FirstKey * Animation::KEY_STRIDE];
+		if (track.KeyCount == 1)
+		{
+			result = DecodeRotation(keys + 1);
+			return;
+		}
+
+		cursor = FindKey(keys, track.KeyCount, time, cursor);
+		const uint16_t* first = keys + cursor * Animation::KEY_STRIDE;
+		const uint16_t* second = first + Animation::KEY_STRIDE;
+
+		Quat from = DecodeRotation(first + 1);
+		Quat to = DecodeRotation(second + 1);
+		if (from.Dot(to) < 0.f)
+			to = Quat(-to.x, -to.y, -to.z, -to.w);
+
+		result = from.Slerp(to, SegmentFactor(first, second, time));
+	}
+}
+
+AnimationCompressionOptions AnimationCompression::GetOptionsFromSettings()
+{
+	std::shared_ptr<ModuleSettings> settings = App->GetModule<ModuleSettings>();
+
+	AnimationCompressionOptions options;
+	options.PositionError = settings->AnimationPositionError;
+	options.RotationError = settings->AnimationRotationError;
+	options.ScaleError = settings->AnimationScaleError;
+	options.ReduceKeys = options.PositionError > 0.f || options.RotationError > 0.f || options.ScaleError > 0.f;
+	return options;
+}
+
+void AnimationCompression::Compress(const std::vector<Channel>& channels, float duration, const AnimationCompressionOptions& options, Animation& clip)
+{
+	clip.Duration = duration;
+	clip.ChannelNames.clear();
+	clip.Tracks.clear();
+	clip.Keys.clear();
+
+	clip.ChannelNames.reserve(channels.size());
+	clip.Tracks.resize(channels.size() * size_t(AnimationTrackType::Count));
+
+	auto lerpVector = [](const float3& a, const float3& b, float t) { return a.Lerp(b, t); };
+	auto vectorError = [](const float3& a, const float3& b) { return a.Distance(b); };
+	auto slerp = [](const Quat& a, const Quat& b, float t) { return a.Dot(b) < 0.f ? a.Slerp(Quat(-b.x, -b.y, -b.z, -b.w), t) : a.Slerp(b, t); };
+
+	for (size_t i = 0; i < channels.size(); ++i)
+	{
+		const Channel& channel = channels[i];
+		clip.ChannelNames.push_back(channel.NodeName);
+
+		AnimationTrack* tracks = &clip.Tracks[i * size_t(AnimationTrackType::Count)];
+
+		std::vector<unsigned> positionKeys = options.ReduceKeys ?
+			ReduceKeys(channel.PositionTimes, channel.Positions, options.PositionError, lerpVector, vectorError) : AllKeys(channel.Positions.size());
+		std::vector<unsigned> rotationKeys = options.ReduceKeys ?
+			ReduceKeys(channel.RotationTimes, channel.Rotations, options.RotationError, slerp, RotationAngle) : AllKeys(channel.Rotations.size());
+		std::vector<unsigned> scaleKeys = options.ReduceKeys ?
+			ReduceKeys(channel.ScaleTimes, channel.Scales, options.ScaleError, lerpVector, vectorError) : AllKeys(channel.Scales.size());
+
+		WriteVectorTrack(channel.PositionTimes, channel.Positions, positionKeys, duration, clip, tracks[size_t(AnimationTrackType::Position)]);
+		WriteRotationTrack(channel.RotationTimes, channel.Rotations, rotationKeys, duration, clip, tracks[size_t(AnimationTrackType::Rotation)]);
+		WriteVectorTrack(channel.ScaleTimes, channel.Scales, scaleKeys, duration, clip, tracks[size_t(AnimationTrackType::Scale)]);
+	}
+
+	clip.Keys.shrink_to_fit();
+}
+
+size_t AnimationCompression::GetRawSize(const std::vector<Channel>& channels)
+{
+	size_t size = 0;
+	for (const Channel& channel : channels)
+	{
+		size += sizeof(Channel*) + HeapBlockSize(sizeof(Channel)) + channel.NodeName.capacity();
+		size += PointerPerKeySize(channel.Positions) + PointerPerKeySize(channel.Rotations) + PointerPerKeySize(channel.Scales);
+	}
+	return size;
+}
+
+void AnimationCompression::Sample(const Animation& clip, unsigned channel, float time, ChannelCursor& cursor, float3& position, Quat& rotation, float3& scale)
+{
+	// Search in the quantised time units so key times are compared without decoding them
+	float keyTime = clip.Duration > 0.f ? time / clip.Duration * QUANTISED_MAX : 0.f;
+
+	SampleVector(clip, clip.GetTrack(channel, AnimationTrackType::Position), keyTime, cursor.Position, position);
+	SampleRotation(clip, clip.GetTrack(channel, AnimationTrackType::Rotation), keyTime, cursor.Rotation, rotation);
+	SampleVector(clip, clip.GetTrack(channel, AnimationTrackType::Scale), keyTime, cursor.Scale, scale);
+}
+
+AnimationCompressionError AnimationCompression::MeasureError(const std::vector<Channel>& channels, const Animation& clip)
+{
+	AnimationCompressionError error;
+	float3 position, scale;
+	Quat rotation;
+
+	for (unsigned i = 0; i < channels.size(); ++i)
+	{
+		const Channel& channel = channels[i];
+
+		// One pass per track, so each one walks its keys forward from a fresh cursor
+		ChannelCursor cursor;
+		for (size_t key = 0; key < channel.Positions.size(); ++key)
+		{
+			Sample(clip, i, channel.PositionTimes[key], cursor, position, rotation, scale);
+			error.Position = MAX(error.Position, position.Distance(channel.Positions[key]));
+		}
+
+		cursor = ChannelCursor();
+		for (size_t key = 0; key < channel.Rotations.size(); ++key)
+		{
+			Sample(clip, i, channel.RotationTimes[key], cursor, position, rotation, scale);
+			error.Rotation = MAX(error.Rotation, RotationAngle(rotation, channel.Rotations[key]));
+		}
+
+		cursor = ChannelCursor();
+		for (size_t key = 0; key < channel.Scales.size(); ++key)
+		{
+			Sample(clip, i, channel.ScaleTimes[key], cursor, position, rotation, scale);
+			error.Scale = MAX(error.Scale, scale.Distance(channel.Scales[key]));
+		}
+	}
+
+	return error;
+}
+
+AnimationCompressionError AnimationCompression::GetErrorBound(const std::vector<Channel>& channels, float duration, const AnimationCompressionOptions& options, const Animation& clip)
+{
+	auto vectorError = [](const float3& a, const float3& b) { return a.Distance(b); };
+
+	// Sampling at a source time lands up to half a time step away from the quantised key
+	float timeStep = 0.5f * duration / QUANTISED_MAX;
+	AnimationCompressionError slack;
+	for (const Channel& channel : channels)
+	{
+		slack.Position = MAX(slack.Position, MaxSpeed(channel.PositionTimes, channel.Positions, vectorError) * timeStep);
+		slack.Rotation = MAX(slack.Rotation, MaxSpeed(channel.RotationTimes, channel.Rotations, RotationAngle) * timeStep);
+		slack.Scale = MAX(slack.Scale, MaxSpeed(channel.ScaleTimes, channel.Scales, vectorError) * timeStep);
+	}
+
+	// Half a step on every axis, and the smallest three error counted on both ends of the rebuilt rotation
+	AnimationCompressionError bound = slack;
+	bound.Rotation += 4.f * sqrtf(3.f) * QUATERNION_COMPONENT_MAX / QUATERNION_COMPONENT_STEPS;
+	for (unsigned i = 0; i < clip.GetChannelCount(); ++i)
+	{
+		bound.Position = MAX(bound.Position, slack.Position + clip.GetTrack(i, AnimationTrackType::Position).Extent.Length() / (2.f * QUANTISED_MAX));
+		bound.Scale = MAX(bound.Scale, slack.Scale + clip.GetTrack(i, AnimationTrackType::Scale).Extent.Length() / (2.f * QUANTISED_MAX));
+	}
+
+	if (options.ReduceKeys)
+	{
+		bound.Position += options.PositionError;
+		bound.Rotation += options.RotationError;
+		bound.Scale += options.ScaleError;
+	}
+
+	return bound;
+}
@@ -0,0 +1,47 @@
+#ifndef __ANIMATIONCOMPRESSION_H__
+#define __ANIMATIONCOMPRESSION_H__
+
+#include "ModuleAnimation.h"
+
+struct AnimationCompressionOptions
+{
+	bool ReduceKeys = true;
+	float PositionError = 0.001f; // Units
+	float RotationError = 0.001f; // Radians
+	float ScaleError = 0.001f;
+};
+
+// Largest difference between the source keys and the compressed clip sampled at their times
+struct AnimationCompressionError
+{
+	float Position = 0.f; // Units
+	float Rotation = 0.f; // Radians
+	float Scale = 0.f;
+};
+
+/*
+ * Quantised animation clips. Keys removed by the reduction are the ones linear interpolation of
+ * their neighbours reproduces within the error options, quantisation adds at most half a step
+ * of 1/65535 of the track bounds for positions and scales and about 2e-5 per quaternion component.
+ */
+namespace AnimationCompression
+{
+	// Tolerances of the animationPositionError, animationRotationError and animationScaleError settings
+	AnimationCompressionOptions GetOptionsFromSettings();
+
+	void Compress(const std::vector<Channel>& channels, float duration, const AnimationCompressionOptions& options, Animation& clip);
+
+	// Size of the channels in the layout clips had before compression, one pointer and heap block per key,
+	// to compare with Animation::GetMemoryUsage
+	size_t GetRawSize(const std::vector<Channel>& channels);
+
+	void Sample(const Animation& clip, unsigned channel, float time, ChannelCursor& cursor, float3& position, Quat& rotation, float3& scale);
+
+	// The clip must have been compressed from these channels
+	AnimationCompressionError MeasureError(const std::vector<Channel>& channels, const Animation& clip);
+	// Largest error MeasureError can find on a clip compressed from these channels with these options:
+	// the reduction tolerances plus the quantisation of the keys and of their times
+	AnimationCompressionError GetErrorBound(const std::vector<Channel>& channels, float duration, const AnimationCompressionOptions& options, const Animation& clip);
+}
+
+#endif // __ANIMATIONCOMPRESSION_H__
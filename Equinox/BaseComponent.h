@@ -1,6 +1,7 @@
 ﻿#ifndef __BASECOMPONENT_H__
 #define __BASECOMPONENT_H__
 #include "Globals.h"
+#include "Allocator.h"
 #include <typeindex>
 
 #define DEFINE_COMPONENT(ClassName) \
@@ -18,6 +19,7 @@ class GameObject;
 class BaseComponent
 {
 	friend class GameObject;
+	DECLARE_ALLOCATED_NEW
 public:
 	std::string Name = "BaseComponent";
 	bool Enabled = true;
@@ -105,3 +105,13 @@ AABB CameraComponent::GetFrustumAABB()
 {
 	return _frustum.MinimalEnclosingAABB();
 }
+
+const Frustum& CameraComponent::GetFrustum() const
+{
+	return _frustum;
+}
+
+Ray CameraComponent::GetPickingRay(float x, float y) const
+{
+	return _frustum.UnProjectFromNearPlane(x, y);
+}
@@ -32,6 +32,9 @@ public:
 	const vec& GetUp() const;
 	vec GetWorldRight() const;
 	AABB GetFrustumAABB();
+	const Frustum& GetFrustum() const;
+	// x and y in normalized device coordinates, [-1, 1] with y up
+	Ray GetPickingRay(float x, float y) const;
 
 private:
 	math::Frustum _frustum;
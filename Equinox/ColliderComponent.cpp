@@ -0,0 +1,32 @@
+﻿#include "ColliderComponent.h"
+#include "GameObject.h"
+
+ColliderComponent::ColliderComponent()
+{
+	_localBounds = AABB(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f));
+}
+
+ColliderComponent::~ColliderComponent()
+{
+}
+
+void ColliderComponent::FitToMeshes()
+{
+	AABB bounds = Parent->GetMeshBounds();
+	if (bounds.IsFinite())
+		SetLocalBounds(bounds);
+	else
+		SetLocalBounds(AABB(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+}
+
+void ColliderComponent::SetLocalBounds(const AABB& bounds)
+{
+	_localBounds = bounds;
+	if (Parent != nullptr)
+		Parent->InvalidateBounds();
+}
+
+const AABB& ColliderComponent::GetWorldBounds() const
+{
+	return Parent->BoundingBox;
+}
@@ -0,0 +1,32 @@
+﻿#ifndef __COMPONENT_COLLIDER_H__
+#define __COMPONENT_COLLIDER_H__
+#include "BaseComponent.h"
+#include <MathGeoLib/include/Geometry/AABB.h>
+
+/*
+ * Axis aligned box collider for GameObjects, only objects that have one take part in collisions.
+ * The GameObject uses these bounds instead of its meshes for its BoundingBox, so collision queries
+ * and camera culling share the level quadtree.
+ */
+class ColliderComponent :
+	public BaseComponent
+{
+	DEFINE_COMPONENT(ColliderComponent);
+
+public:
+	ColliderComponent();
+	~ColliderComponent();
+
+	// Encloses the meshes of the owner, or a unit box if it has none
+	void FitToMeshes();
+
+	const AABB& GetLocalBounds() const { return _localBounds; }
+	void SetLocalBounds(const AABB& bounds);
+
+	const AABB& GetWorldBounds() const;
+
+private:
+	AABB _localBounds;
+};
+
+#endif
@@ -1,5 +1,5 @@
 #include "CoordinateArrows.h"
-#include <GL/glew.h>
+#include "RenderDevice.h"
 
 CoordinateArrows::CoordinateArrows()
 {
@@ -8,82 +8,32 @@ CoordinateArrows::CoordinateArrows()
 
 void CoordinateArrows::Draw()
 {
-	glPushMatrix();
-	GLboolean light = glIsEnabled(GL_LIGHTING);
-	glDisable(GL_LIGHTING);
+	RenderDevice* device = RenderDevice::Current();
+	bool light = device->IsEnabled(RenderState::Lighting);
+	device->SetState(RenderState::Lighting, false);
 
-	//Draw Axis
-	glLineWidth(4.0);
-	glBegin(GL_LINES);
-	glColor3f(1, 0, 0);  glVertex3fv(Origin);  glVertex3fv(XP);    // X red axis
-	glColor3f(0, 1, 0);  glVertex3fv(Origin);  glVertex3fv(YP);    // Y green axis
-	glColor3f(0, 0, 1);  glVertex3fv(Origin);  glVertex3fv(ZP);    // z blue axis
-	glEnd();
+	float3 origin(Origin), x(XP), y(YP), z(ZP);
 
-	//Draw ArrowLikeShape
+	//Draw Axis and ArrowLikeShape
+	float3 xAxis[6] = { origin, x, x, float3(0.95f, 0.1f, 0), x, float3(0.95f, -0.1f, 0) };
+	float3 yAxis[6] = { origin, y, y, float3(0.1f, 0.95f, 0), y, float3(-0.1f, 0.95f, 0) };
+	float3 zAxis[6] = { origin, z, z, float3(0, 0.1f, 0.95f), z, float3(0, -0.1f, 0.95f) };
 
-	glLineWidth(4.0);
-	glBegin(GL_LINES);
-
-	//X
-	glColor3f(1, 0, 0);
-
-	glVertex3fv(XP); glVertex3f(0.95f, 0.1f, 0);
-	glVertex3fv(XP); glVertex3f(0.95f, -0.1f, 0);
-
-	//Y
-	glColor3f(0, 1, 0);
-
-	glVertex3fv(YP); glVertex3f(0.1f, 0.95f, 0);
-	glVertex3fv(YP); glVertex3f(-0.1f, 0.95f, 0);
-
-	//Y
-	glColor3f(0, 1, 0);
-
-	glVertex3fv(YP); glVertex3f(0.1f, 0.95f, 0);
-	glVertex3fv(YP); glVertex3f(-0.1f, 0.95f, 0);
-
-	//Z
-	glColor3f(0, 0, 1);
-
-	glVertex3fv(ZP); glVertex3f(0, 0.1f, 0.95f);
-	glVertex3fv(ZP); glVertex3f(0, -0.1f, 0.95f);
-
-	glEnd();
+	device->SetLineWidth(4.0);
+	device->SetColor(float4(1, 0, 0, 1));  device->DrawVertices(PrimitiveType::Lines, xAxis, 6);    // X red axis
+	device->SetColor(float4(0, 1, 0, 1));  device->DrawVertices(PrimitiveType::Lines, yAxis, 6);    // Y green axis
+	device->SetColor(float4(0, 0, 1, 1));  device->DrawVertices(PrimitiveType::Lines, zAxis, 6);    // z blue axis
 
 	//Draw Coords Names
-	glLineWidth(2.0);
-	glBegin(GL_LINES);
-
-	//X
-	glColor3f(1, 0, 0);
-
-	glVertex3f(1.2f, 0.05f, 0); glVertex3f(1.25f, -0.05f, 0);
-
-	glVertex3f(1.2f, -0.05f, 0); glVertex3f(1.25f, 0.05f, 0);
-
-	//Y
-	glColor3f(0, 1, 0);
-
-	glVertex3f(0, 1.2f, 0); glVertex3f(0, 1.25f, 0);
-
-	glVertex3f(0, 1.25f, 0); glVertex3f(-0.05f, 1.30f, 0);
-
-	glVertex3f(0, 1.25f, 0); glVertex3f(0.05f, 1.30f, 0);
-
-	//Z
-	glColor3f(0, 0, 1);
-
-	glVertex3f(0, -0.05f, 1.2f); glVertex3f(0, -0.05f, 1.25f);
-
-	glVertex3f(0, -0.05f, 1.25f); glVertex3f(0, 0.05f, 1.2f);
-
-	glVertex3f(0, 0.05f, 1.2f); glVertex3f(0, 0.05f, 1.25f);
+	float3 xName[4] = { float3(1.2f, 0.05f, 0), float3(1.25f, -0.05f, 0), float3(1.2f, -0.05f, 0), float3(1.25f, 0.05f, 0) };
+	float3 yName[6] = { float3(0, 1.2f, 0), float3(0, 1.25f, 0), float3(0, 1.25f, 0), float3(-0.05f, 1.30f, 0), float3(0, 1.25f, 0), float3(0.05f, 1.30f, 0) };
+	float3 zName[6] = { float3(0, -0.05f, 1.2f), float3(0, -0.05f, 1.25f), float3(0, -0.05f, 1.25f), float3(0, 0.05f, 1.2f), float3(0, 0.05f, 1.2f), float3(0, 0.05f, 1.25f) };
 
-	glEnd();
+	device->SetLineWidth(2.0);
+	device->SetColor(float4(1, 0, 0, 1));  device->DrawVertices(PrimitiveType::Lines, xName, 4);
+	device->SetColor(float4(0, 1, 0, 1));  device->DrawVertices(PrimitiveType::Lines, yName, 6);
+	device->SetColor(float4(0, 0, 1, 1));  device->DrawVertices(PrimitiveType::Lines, zName, 6);
 
-	glPopMatrix();
-	
 	if (light)
-		glEnable(GL_LIGHTING);
+		device->SetState(RenderState::Lighting, true);
 }
@@ -16,6 +16,9 @@
 #include "ModuleMeshManager.h"
 #include "ModuleCameraManager.h"
 #include "ProgramManager.h"
+#include "ModuleJobSystem.h"
+#include "ModuleParticles.h"
+#include "FramePipeline.h"
 
 using namespace std;
 
@@ -26,6 +29,7 @@ Engine::Engine()
 	state = State::CREATION;
 
 	// Order matters: they will init/start/pre/update/post in this order
+	AppendModule<ModuleSettings>(); // First, the window already depends on it
 	AppendModule<ModuleInput>();
 	AppendModule<ModuleWindow>();
 
@@ -36,7 +40,7 @@ Engine::Engine()
 	AppendModule<ModuleTextures>();
 	AppendModule<ModuleLighting>();
 	AppendModule<ModuleAudio>();
-	AppendModule<ModuleSettings>();
+	AppendModule<ModuleJobSystem>();
 	AppendModule<ModuleAnimation>();
 	_statsModule = AppendModule<ModuleStats>();
 
@@ -44,6 +48,7 @@ Engine::Engine()
 	AppendModule<ModuleMeshManager>();
 
 	// Game modules
+	AppendModule<ModuleParticles>(); // Simulates before the level is traversed to draw
 	AppendModule<ModuleLevelManager>();
 
 	// Modules to draw on top of game logic
@@ -166,6 +171,16 @@ bool Engine::Init()
 
 	// Start the first scene --
 
+	std::shared_ptr<ModuleSettings> settings = GetModule<ModuleSettings>();
+	if (settings->Headless)
+		_frameLimit = settings->HeadlessFrames;
+
+	if (settings->PipelinedFrames)
+	{
+		_pipeline = new FramePipeline;
+		LOG("Pipelined frames: the simulation runs a frame ahead of the submission");
+	}
+
 	return ret;
 }
 
@@ -173,22 +188,49 @@ update_status Engine::Update()
 {
 	update_status ret = UPDATE_CONTINUE;
 
+	ComplexTimer frameTimer;
+	frameTimer.Start();
+
 	float dt = _isPaused ? 0 : DeltaTime;
 
+	// The simulation of this frame ran while the previous one was submitted
+	if (_pipeline != nullptr)
+	{
+		ComplexTimer waitTimer;
+		waitTimer.Start();
+		_pipeline->Wait();
+		_statsModule->_simulation_wait_ms_sum += float(waitTimer.Stop() / 1000.0);
+	}
+
 	for(auto it = _modules.begin(); it != _modules.end() && ret == UPDATE_CONTINUE; ++it)
 		if((*it)->IsEnabled() == true) 
 			ret = (*it)->PreUpdate(dt);
 
+	if (_pipeline == nullptr && ret == UPDATE_CONTINUE)
+		simulate(dt);
+
 	for(auto it = _modules.begin(); it != _modules.end() && ret == UPDATE_CONTINUE; ++it)
 		if((*it)->IsEnabled() == true) 
 			ret = (*it)->Update(dt);
 
+	// Everything drawn is recorded by now, the next frame is simulated with this frame's delta time while it is submitted
+	if (_pipeline != nullptr && ret == UPDATE_CONTINUE)
+		_pipeline->Kick([this, dt]() { simulate(dt); });
+
 	for(auto it = _modules.begin(); it != _modules.end() && ret == UPDATE_CONTINUE; ++it)
 		if((*it)->IsEnabled() == true) 
 			ret = (*it)->PostUpdate(dt);
 
 	++_statsModule->_total_frames;
 
+	float frameMs = float(frameTimer.Stop() / 1000.0);
+	_statsModule->_frame_ms_sum += frameMs;
+	_statsModule->_min_frame_ms = MIN(_statsModule->_min_frame_ms, frameMs);
+	_statsModule->_max_frame_ms = MAX(_statsModule->_max_frame_ms, frameMs);
+
+	if (_frameLimit > 0 && _statsModule->_total_frames >= _frameLimit && ret == UPDATE_CONTINUE)
+		ret = UPDATE_STOP;
+
 	float currentFrameTime = float(_statsModule->_total_simple_time.Read() / 1E3);
 	DeltaTime = float(currentFrameTime - _timeFromLastFrame);
 	
@@ -198,9 +240,18 @@ update_status Engine::Update()
 
 	_timeFromLastFrame = currentFrameTime;
 
+	MemoryTracker::EndFrame();
+
 	return ret;
 }
 
+void Engine::simulate(float dt)
+{
+	for (const std::shared_ptr<Module>& module : _modules)
+		if (module->IsEnabled() == true)
+			module->Simulate(dt);
+}
+
 bool Engine::CleanUp()
 {
 	bool ret = true;
@@ -209,6 +260,13 @@ bool Engine::CleanUp()
 	LOG("Total Time: %i miliseconds", _statsModule->_total_simple_time.Stop());
 	LOG("Total Frames: %f", _statsModule->_total_frames);
 	LOG("Average FPS: %f", _statsModule->_current_avg);
+	if (_statsModule->_total_frames > 0)
+		LOG("Frame time: %.3f ms average, %.3f ms min, %.3f ms max", _statsModule->AverageFrameMs(), _statsModule->MinFrameMs(), _statsModule->MaxFrameMs());
+	if (_statsModule->_total_frames > 0 && _pipeline != nullptr)
+		LOG("Waited for the simulation: %.3f ms average", _statsModule->AverageSimulationWaitMs());
+
+	// The last frame kicked a simulation, it has to finish before the modules go away
+	RELEASE(_pipeline);
 
 	for(auto it = _modules.rbegin(); it != _modules.rend() && ret; ++it)
 		if((*it)->IsEnabled() == true) 
@@ -71,6 +71,8 @@ public:
 	float DeltaTime;
 
 private:
+	void simulate(float dt);
+
 	State state = CREATION;
 	UpdateState _updateState = UpdateState::Playing;
 	bool _isPaused = false;
@@ -81,6 +83,8 @@ private:
 	std::list<std::shared_ptr<Module>> _modules;
 
 	float _timeFromLastFrame = 0;
+	int _frameLimit = 0; // Only set for headless runs
+	class FramePipeline* _pipeline = nullptr;
 };
 
 extern Engine* App;
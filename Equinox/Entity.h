@@ -51,16 +51,18 @@ public:
 		return true;
 	}
 
-	// Callbacks
-	virtual bool OnCollision(Collider& origin, Collider& other)
-	{
-		return true;
-	}
+	// Collision callbacks, references are only valid during the call
+	virtual void OnCollisionEnter(Collider& origin, Collider& other) {}
+
+	// Called once per frame with every collider still touching origin
+	virtual void OnCollisionStay(Collider& origin, const std::vector<Collider*>& others) {}
+
+	virtual void OnCollisionExit(Collider& origin, Collider& other) {}
 
 public:
 	Entity* Parent;
 	iPoint3 Position;
-	Collider* FeetCollider = nullptr;
+	ColliderHandle FeetCollider;
 
 private:
 	bool _active = true;
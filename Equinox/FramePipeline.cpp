@@ -0,0 +1,60 @@
+#include "FramePipeline.h"
+
+FramePipeline::FramePipeline()
+{
+	_thread = std::thread(&FramePipeline::threadLoop, this);
+}
+
+FramePipeline::~FramePipeline()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_exit = true;
+	}
+	_stageKicked.notify_one();
+
+	_thread.join();
+}
+
+void FramePipeline::Kick(const std::function<void()>& stage)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stage = stage;
+		_running = true;
+	}
+	_stageKicked.notify_one();
+}
+
+void FramePipeline::Wait()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_stageFinished.wait(lock, [this]() { return !_running; });
+}
+
+void FramePipeline::threadLoop()
+{
+	while (true)
+	{
+		std::function<void()> stage;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_stageKicked.wait(lock, [this]() { return _exit || _running; });
+
+			if (_exit)
+				return;
+
+			stage.swap(_stage);
+		}
+
+		stage();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_running = false;
+		}
+		_stageFinished.notify_one();
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef __FRAMEPIPELINE_H__
+#define __FRAMEPIPELINE_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Second stage of the frame: a thread that runs the simulation of the next frame while the main
+ * thread submits the current one to GL. Only one stage is in flight, every Kick is preceded by a Wait.
+ */
+class FramePipeline
+{
+public:
+	FramePipeline();
+	~FramePipeline();
+
+	void Kick(const std::function<void()>& stage);
+	// Blocks until the stage kicked last has finished, returns right away if there is none
+	void Wait();
+
+private:
+	void threadLoop();
+
+	std::thread _thread;
+
+	std::mutex _mutex;
+	std::condition_variable _stageKicked;
+	std::condition_variable _stageFinished;
+
+	std::function<void()> _stage;
+	bool _running = false;
+	bool _exit = false;
+};
+
+#endif // __FRAMEPIPELINE_H__
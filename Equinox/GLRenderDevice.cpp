@@ -0,0 +1,265 @@
+#include "GLRenderDevice.h"
+
+namespace
+{
+	GLenum ToGL(RenderState state)
+	{
+		switch (state)
+		{
+			case RenderState::Lighting: return GL_LIGHTING;
+			case RenderState::ColorMaterial: return GL_COLOR_MATERIAL;
+			case RenderState::Texture2D: return GL_TEXTURE_2D;
+			case RenderState::Blend: return GL_BLEND;
+			case RenderState::AlphaTest: return GL_ALPHA_TEST;
+			case RenderState::DepthTest: return GL_DEPTH_TEST;
+			case RenderState::CullFace: return GL_CULL_FACE;
+			default: return GL_NONE;
+		}
+	}
+
+	GLenum ToGL(VertexArray array)
+	{
+		switch (array)
+		{
+			case VertexArray::Position: return GL_VERTEX_ARRAY;
+			case VertexArray::Normal: return GL_NORMAL_ARRAY;
+			case VertexArray::TextureCoords: return GL_TEXTURE_COORD_ARRAY;
+			default: return GL_NONE;
+		}
+	}
+
+	GLenum ToGL(BufferTarget target)
+	{
+		return target == BufferTarget::Indices ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+	}
+
+	GLenum ToGL(PrimitiveType type)
+	{
+		switch (type)
+		{
+			case PrimitiveType::Lines: return GL_LINES;
+			case PrimitiveType::Quads: return GL_QUADS;
+			default: return GL_TRIANGLES;
+		}
+	}
+}
+
+void GLRenderDevice::SetViewport(int x, int y, int width, int height)
+{
+	glViewport(x, y, width, height);
+}
+
+void GLRenderDevice::Clear(const float4& color)
+{
+	glClearColor(color.x, color.y, color.z, color.w);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void GLRenderDevice::SetCamera(const float* projection, const float* view)
+{
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(projection);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(view);
+}
+
+void GLRenderDevice::SetDepthWrite(bool enabled)
+{
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLRenderDevice::SetAlphaReference(float reference)
+{
+	glAlphaFunc(GL_GREATER, reference);
+}
+
+void GLRenderDevice::SetLineWidth(float width)
+{
+	glLineWidth(width);
+}
+
+void GLRenderDevice::SetColor(const float4& color)
+{
+	glColor4f(color.x, color.y, color.z, color.w);
+}
+
+void GLRenderDevice::SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess)
+{
+	glMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
+	glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
+	glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
+	glMaterialf(GL_FRONT, GL_SHININESS, shininess);
+}
+
+void GLRenderDevice::SetAmbientLight(const float* color)
+{
+	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, color);
+}
+
+void GLRenderDevice::SetLightEnabled(unsigned light, bool enabled)
+{
+	if (enabled)
+		glEnable(GL_LIGHT0 + light);
+	else
+		glDisable(GL_LIGHT0 + light);
+}
+
+void GLRenderDevice::SetLight(unsigned light, const float* ambient, const float* diffuse, const float* specular, const float* position, float cutOff, const float* direction)
+{
+	GLenum number = GL_LIGHT0 + light;
+	glLightfv(number, GL_AMBIENT, ambient);
+	glLightfv(number, GL_DIFFUSE, diffuse);
+	glLightfv(number, GL_SPECULAR, specular);
+	glLightfv(number, GL_POSITION, position);
+	glLightf(number, GL_SPOT_CUTOFF, cutOff);
+	glLightfv(number, GL_SPOT_DIRECTION, direction);
+}
+
+void GLRenderDevice::PushMatrix()
+{
+	glPushMatrix();
+}
+
+void GLRenderDevice::PopMatrix()
+{
+	glPopMatrix();
+}
+
+void GLRenderDevice::MultMatrix(const float4x4& matrix)
+{
+	float4x4 columnMajor = matrix.Transposed();
+	glMultMatrixf(columnMajor.ptr());
+}
+
+unsigned GLRenderDevice::CreateBuffer(BufferTarget target, const void* data, size_t bytes)
+{
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+
+	if (data != nullptr)
+	{
+		GLenum glTarget = ToGL(target);
+		glBindBuffer(glTarget, buffer);
+		glBufferData(glTarget, bytes, data, GL_STATIC_DRAW);
+	}
+
+	return buffer;
+}
+
+void GLRenderDevice::DeleteBuffer(unsigned buffer)
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLRenderDevice::BindBuffer(BufferTarget target, unsigned buffer)
+{
+	glBindBuffer(ToGL(target), buffer);
+}
+
+void GLRenderDevice::StreamBuffer(BufferTarget target, unsigned buffer, const void* data, size_t bytes)
+{
+	GLenum glTarget = ToGL(target);
+	glBindBuffer(glTarget, buffer);
+	glBufferData(glTarget, bytes, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(glTarget, 0, bytes, data);
+}
+
+void GLRenderDevice::SetVertexArray(VertexArray array, bool enabled)
+{
+	if (enabled)
+		glEnableClientState(ToGL(array));
+	else
+		glDisableClientState(ToGL(array));
+}
+
+void GLRenderDevice::SetVertexPointer(VertexArray array, int components, int stride, size_t offset)
+{
+	const void* pointer = reinterpret_cast<const void*>(offset);
+
+	switch (array)
+	{
+		case VertexArray::Position:
+			glVertexPointer(components, GL_FLOAT, stride, pointer);
+			break;
+		case VertexArray::Normal:
+			glNormalPointer(GL_FLOAT, stride, pointer);
+			break;
+		case VertexArray::TextureCoords:
+			glTexCoordPointer(components, GL_FLOAT, stride, pointer);
+			break;
+		default:
+			break;
+	}
+}
+
+void GLRenderDevice::SetVertexAttribute(const char* name, int components, unsigned buffer)
+{
+	GLint location = glGetAttribLocation(_program, name);
+	if (location < 0)
+		return;
+
+	glEnableVertexAttribArray(location);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, 0, nullptr);
+}
+
+void GLRenderDevice::DisableVertexAttribute(const char* name)
+{
+	GLint location = glGetAttribLocation(_program, name);
+	if (location >= 0)
+		glDisableVertexAttribArray(location);
+}
+
+void GLRenderDevice::UseProgram(unsigned program)
+{
+	_program = program;
+	glUseProgram(program);
+}
+
+void GLRenderDevice::SetUniform(const char* name, int value)
+{
+	glUniform1i(glGetUniformLocation(_program, name), value);
+}
+
+void GLRenderDevice::SetUniform(const char* name, const float4& value)
+{
+	glUniform4fv(glGetUniformLocation(_program, name), 1, value.ptr());
+}
+
+void GLRenderDevice::SetUniform(const char* name, const float4x4* matrices, size_t count)
+{
+	glUniformMatrix4fv(glGetUniformLocation(_program, name), GLsizei(count), GL_TRUE, matrices->ptr());
+}
+
+void GLRenderDevice::BindTexture(unsigned unit, unsigned texture)
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLRenderDevice::DrawIndexed(PrimitiveType type, unsigned indexCount)
+{
+	glDrawElements(ToGL(type), indexCount, GL_UNSIGNED_INT, nullptr);
+}
+
+void GLRenderDevice::DrawArrays(PrimitiveType type, unsigned first, unsigned count)
+{
+	glDrawArrays(ToGL(type), first, count);
+}
+
+void GLRenderDevice::DrawVertices(PrimitiveType type, const float3* vertices, size_t count)
+{
+	glBegin(ToGL(type));
+	for (size_t i = 0; i < count; ++i)
+		glVertex3fv(vertices[i].ptr());
+	glEnd();
+}
+
+void GLRenderDevice::applyState(RenderState state, bool enabled)
+{
+	if (enabled)
+		glEnable(ToGL(state));
+	else
+		glDisable(ToGL(state));
+}
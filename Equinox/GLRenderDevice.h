@@ -0,0 +1,57 @@
+#ifndef __GLRENDERDEVICE_H__
+#define __GLRENDERDEVICE_H__
+
+#include "RenderDevice.h"
+#include <GL/glew.h>
+
+// Sends every call straight to the GL context of the calling thread
+class GLRenderDevice : public RenderDevice
+{
+public:
+	const char* GetName() const override { return "GL"; }
+
+	void SetViewport(int x, int y, int width, int height) override;
+	void Clear(const float4& color) override;
+	void SetCamera(const float* projection, const float* view) override;
+
+	void SetDepthWrite(bool enabled) override;
+	void SetAlphaReference(float reference) override;
+	void SetLineWidth(float width) override;
+	void SetColor(const float4& color) override;
+	void SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess) override;
+
+	void SetAmbientLight(const float* color) override;
+	void SetLightEnabled(unsigned light, bool enabled) override;
+	void SetLight(unsigned light, const float* ambient, const float* diffuse, const float* specular, const float* position, float cutOff, const float* direction) override;
+
+	void PushMatrix() override;
+	void PopMatrix() override;
+	void MultMatrix(const float4x4& matrix) override;
+
+	unsigned CreateBuffer(BufferTarget target, const void* data, size_t bytes) override;
+	void DeleteBuffer(unsigned buffer) override;
+	void BindBuffer(BufferTarget target, unsigned buffer) override;
+	void StreamBuffer(BufferTarget target, unsigned buffer, const void* data, size_t bytes) override;
+	void SetVertexArray(VertexArray array, bool enabled) override;
+	void SetVertexPointer(VertexArray array, int components, int stride, size_t offset) override;
+	void SetVertexAttribute(const char* name, int components, unsigned buffer) override;
+	void DisableVertexAttribute(const char* name) override;
+
+	void UseProgram(unsigned program) override;
+	void SetUniform(const char* name, int value) override;
+	void SetUniform(const char* name, const float4& value) override;
+	void SetUniform(const char* name, const float4x4* matrices, size_t count) override;
+	void BindTexture(unsigned unit, unsigned texture) override;
+
+	void DrawIndexed(PrimitiveType type, unsigned indexCount) override;
+	void DrawArrays(PrimitiveType type, unsigned first, unsigned count) override;
+	void DrawVertices(PrimitiveType type, const float3* vertices, size_t count) override;
+
+protected:
+	void applyState(RenderState state, bool enabled) override;
+
+private:
+	GLuint _program = 0;
+};
+
+#endif // __GLRENDERDEVICE_H__
@@ -1,8 +1,12 @@
 ﻿#include "GameObject.h"
 #include "BaseComponent.h"
 #include "Globals.h"
-#include <GL/glew.h>
 #include "TransformComponent.h"
+#include "ColliderComponent.h"
+#include "MeshComponent.h"
+#include "ModuleMeshManager.h"
+#include "ModuleLevelManager.h"
+#include "Level.h"
 #include <MathGeoLib/include/Math/float4x4.h>
 #include "Engine.h"
 
@@ -72,6 +76,12 @@ void GameObject::AddComponent(BaseComponent* component)
 
 		if (component->GetComponentClassId() == TransformComponent::GetClassId())
 			_transform = static_cast<TransformComponent*>(component);
+		else if (component->GetComponentClassId() == ColliderComponent::GetClassId())
+			_collider = static_cast<ColliderComponent*>(component);
+		else if (component->GetComponentClassId() == MeshComponent::GetClassId() && _mesh == nullptr)
+			_mesh = static_cast<MeshComponent*>(component);
+
+		_boundsDirty = true;
 	}
 }
 
@@ -94,9 +104,16 @@ void GameObject::DeleteComponentByName(const std::string& name)
 		{
 			if ((*it)->GetComponentName() == name)
 			{
+				BaseComponent* component = *it;
+				if (component == _collider)
+					_collider = nullptr;
+				if (component == _mesh)
+					_mesh = nullptr;
+				_boundsDirty = true;
 				_components.erase(it);
-				(*it)->CleanUp();
-				RELEASE(*it);
+				component->CleanUp();
+				RELEASE(component);
+				break;
 			}
 		}
 	}
@@ -112,6 +129,47 @@ TransformComponent* GameObject::GetTransform() const
 	return _transform;
 }
 
+ColliderComponent* GameObject::GetCollider() const
+{
+	return _collider;
+}
+
+MeshComponent* GameObject::GetMeshComponent() const
+{
+	return _mesh;
+}
+
+float4x4 GameObject::GetWorldTransform() const
+{
+	float4x4 world = float4x4::identity;
+	for (const GameObject* node = this; node != nullptr; node = node->_parent)
+	{
+		if (node->_transform != nullptr)
+			world = node->_transform->GetTransformMatrix() * world;
+	}
+
+	return world;
+}
+
+AABB GameObject::GetMeshBounds() const
+{
+	AABB bounds;
+	bounds.SetNegativeInfinity();
+
+	if (_mesh != nullptr)
+	{
+		std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
+		for (MeshHandle meshHandle : _mesh->Meshes)
+		{
+			const Mesh* mesh = meshManager->GetMesh(meshHandle);
+			if (mesh != nullptr)
+				bounds.Enclose(mesh->boundingBox);
+		}
+	}
+
+	return bounds;
+}
+
 void GameObject::DrawBoundingBox()
 {
 	::DrawBoundingBox(BoundingBox);
@@ -119,18 +177,19 @@ void GameObject::DrawBoundingBox()
 
 void GameObject::DrawHierachy() const
 {
-	GLboolean light = glIsEnabled(GL_LIGHTING);
-	glDisable(GL_LIGHTING);
-	glColor4f(0.f, 0.f, 1.f, 1.f);
+	RenderDevice* device = RenderDevice::Current();
+	bool light = device->IsEnabled(RenderState::Lighting);
+	device->SetState(RenderState::Lighting, false);
+	device->SetColor(float4(0.f, 0.f, 1.f, 1.f));
 
 	float4x4 transform = float4x4::identity;
 	for (GameObject* child : _childs)
 		child->DrawHierachy(transform);
 
-	glColor4f(1.f, 1.f, 1.f, 1.f);
+	device->SetColor(float4(1.f, 1.f, 1.f, 1.f));
 
 	if (light)
-		glEnable(GL_LIGHTING);
+		device->SetState(RenderState::Lighting, true);
 }
 
 void GameObject::DrawHierachy(const float4x4& transformMatrix) const
@@ -139,12 +198,8 @@ void GameObject::DrawHierachy(const float4x4& transformMatrix) const
 
 	if (_parent && _parent->_transform)
 	{
-		glBegin(GL_LINES);
-		float3 parentPos = transformMatrix.Col3(3);
-		glVertex3fv(reinterpret_cast<GLfloat*>(&parentPos));
-		float3 position = localMatrix.Col3(3);
-		glVertex3fv(reinterpret_cast<GLfloat*>(&position));
-		glEnd();
+		float3 line[2] = { transformMatrix.Col3(3), localMatrix.Col3(3) };
+		RenderDevice::Current()->DrawVertices(PrimitiveType::Lines, line, 2);
 	}
 
 	for (GameObject* child : _childs)
@@ -154,11 +209,18 @@ void GameObject::DrawHierachy(const float4x4& transformMatrix) const
 
 void GameObject::Update(float dt)
 {
-	glPushMatrix();
+	RenderDevice* device = RenderDevice::Current();
+	device->PushMatrix();
 
 	for (BaseComponent* baseComponent : _componentsToRemove)
 	{
+		if (baseComponent == _collider)
+			_collider = nullptr;
+		if (baseComponent == _mesh)
+			_mesh = nullptr;
+		_boundsDirty = true;
 		_components.remove(baseComponent);
+		baseComponent->CleanUp();
 		RELEASE(baseComponent);
 	}
 	_componentsToRemove.clear();
@@ -198,14 +260,44 @@ void GameObject::Update(float dt)
 
 	_playState = App->GetUpdateState();
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	// Components may have moved the object, the childs build their world transform on top of this one
+	_worldTransform = _transform != nullptr ? _transform->GetTransformMatrix() : float4x4::identity;
+	if (_parent != nullptr)
+		_worldTransform = _parent->_worldTransform * _worldTransform;
+
+	updateBounds();
+
+	device->BindTexture(0, 0);
 
 	for (GameObject* child : _childs)
 	{
 		child->Update(dt);
 	}
 
-	glPopMatrix();
+	device->PopMatrix();
+}
+
+void GameObject::updateBounds()
+{
+	bool hasBounds = _collider != nullptr || _mesh != nullptr;
+	if (!_boundsDirty && (!hasBounds || _worldTransform.Equals(_boundsTransform, 1e-5f)))
+		return;
+
+	_boundsTransform = _worldTransform;
+	_boundsDirty = false;
+
+	AABB bounds;
+	if (_collider != nullptr)
+		bounds = _collider->GetLocalBounds();
+	else
+		bounds = GetMeshBounds();
+
+	if (bounds.IsFinite())
+		bounds.TransformAsAABB(_worldTransform);
+	else
+		bounds.SetNegativeInfinity();
+
+	App->GetModule<ModuleLevelManager>()->GetCurrentLevel().UpdateBounds(this, bounds);
 }
 
 bool GameObject::CleanUp()
@@ -4,13 +4,18 @@
 #include <string>
 #include <list>
 #include <MathGeoLib/include/Geometry/AABB.h>
+#include <MathGeoLib/include/Math/float4x4.h>
 #include "Engine.h"
+#include "Allocator.h"
 
 class BaseComponent;
 class TransformComponent;
+class ColliderComponent;
+class MeshComponent;
 
 class GameObject
 {
+	DECLARE_ALLOCATED_NEW
 
 public:
 	GameObject();
@@ -30,6 +35,15 @@ public:
 	void DeleteComponent(BaseComponent* component);
 
 	TransformComponent* GetTransform() const;
+	ColliderComponent* GetCollider() const;
+	MeshComponent* GetMeshComponent() const;
+	// Product of the transforms of this node and all its ancestors
+	float4x4 GetWorldTransform() const;
+
+	// Union of the bounds of every mesh of the object, in its local space
+	AABB GetMeshBounds() const;
+	// The world BoundingBox is recomputed on the next update, for changes that keep the transform
+	void InvalidateBounds() { _boundsDirty = true; }
 
 	void DrawBoundingBox();
 	void DrawHierachy() const;
@@ -40,17 +54,25 @@ public:
 
 	std::string Name = "GameObject";
 	bool Enabled = true;
-	AABB BoundingBox;
+	AABB BoundingBox; // World space, from the collider when there is one and from the meshes otherwise
 	bool VisibleOnCamera = false;
 
 private:
+	void updateBounds();
+
 	GameObject* _parent = nullptr;
 	TransformComponent* _transform = nullptr;
+	ColliderComponent* _collider = nullptr;
+	MeshComponent* _mesh = nullptr;
 	std::vector<GameObject*> _childs;
 	std::list<BaseComponent*> _componentsToRemove;
 	std::list<BaseComponent*> _components;
 	Engine::UpdateState _playState = Engine::UpdateState::Stopped;
 
+	float4x4 _worldTransform = float4x4::identity; // Refreshed by Update, before the childs update
+	float4x4 _boundsTransform = float4x4::identity; // World transform the BoundingBox was computed with
+	bool _boundsDirty = true;
+
 };
 
 #endif
@@ -4,6 +4,7 @@
 #include "MemLeaks.h"
 #include <GL/glew.h>
 #include <MathGeoLib/include/Geometry/AABB.h>
+#include "RenderDevice.h"
 
 #define LOG(format, ...) log(__FILE__, __LINE__, format, __VA_ARGS__)
 
@@ -57,66 +58,29 @@ typedef unsigned int uint;
 
 inline void DrawBoundingBox(const AABB& boundingBox)
 {
-	glPushMatrix();
+	if (!boundingBox.IsFinite())
+		return;
 
-	GLboolean light = glIsEnabled(GL_LIGHTING);
-	glDisable(GL_LIGHTING);
+	// Corner pairs of the twelve edges: left, back, right and front sides
+	static const int edges[24] = { 0, 1, 0, 2, 2, 3, 3, 1, 0, 4, 2, 6, 4, 6, 6, 7, 4, 5, 7, 5, 1, 5, 3, 7 };
 
-	if (boundingBox.IsFinite())
-	{
-		glLineWidth(3.f);
-		glBegin(GL_LINES);
-		glColor3f(0.f, 1.f, 0.f);
-		vec points[8];
-		boundingBox.GetCornerPoints(points);
+	vec points[8];
+	boundingBox.GetCornerPoints(points);
 
-		// LEFT SIDE
-		glVertex3fv(&points[0][0]);
-		glVertex3fv(&points[1][0]);
+	float3 lines[24];
+	for (int i = 0; i < 24; ++i)
+		lines[i] = points[edges[i]];
 
-		glVertex3fv(&points[0][0]);
-		glVertex3fv(&points[2][0]);
+	RenderDevice* device = RenderDevice::Current();
+	bool light = device->IsEnabled(RenderState::Lighting);
+	device->SetState(RenderState::Lighting, false);
 
-		glVertex3fv(&points[2][0]);
-		glVertex3fv(&points[3][0]);
-
-		glVertex3fv(&points[3][0]);
-		glVertex3fv(&points[1][0]);
-
-		// BACK SIDE
-		glVertex3fv(&points[0][0]);
-		glVertex3fv(&points[4][0]);
-
-		glVertex3fv(&points[2][0]);
-		glVertex3fv(&points[6][0]);
-
-		glVertex3fv(&points[4][0]);
-		glVertex3fv(&points[6][0]);
-
-		// RIGHT SIDE
-		glVertex3fv(&points[6][0]);
-		glVertex3fv(&points[7][0]);
-
-		glVertex3fv(&points[4][0]);
-		glVertex3fv(&points[5][0]);
-
-		glVertex3fv(&points[7][0]);
-		glVertex3fv(&points[5][0]);
-
-		// FRONT SIDE
-		glVertex3fv(&points[1][0]);
-		glVertex3fv(&points[5][0]);
-
-		glVertex3fv(&points[3][0]);
-		glVertex3fv(&points[7][0]);
-
-		glEnd();
-	}
+	device->SetLineWidth(3.f);
+	device->SetColor(float4(0.f, 1.f, 0.f, 1.f));
+	device->DrawVertices(PrimitiveType::Lines, lines, 24);
 
 	if (light)
-		glEnable(GL_LIGHTING);
-
-	glPopMatrix();
+		device->SetState(RenderState::Lighting, true);
 }
 
 #endif //__GLOBALS_H__
\ No newline at end of file
@@ -2,14 +2,28 @@
 #include "GameObject.h"
 #include "TransformComponent.h"
 #include "ModuleCameraManager.h"
+#include "ModuleMeshManager.h"
+#include "ModuleSettings.h"
+#include "ModuleJobSystem.h"
+#include "CameraComponent.h"
+#include "MeshComponent.h"
 #include "Quadtree.h"
 
 #include "IMGUI/imgui.h"
+#include <algorithm>
 #include <stack>
 
+namespace
+{
+	const unsigned MAX_OCCLUDERS = 16;
+	const unsigned OCCLUDER_TRIANGLE_BUDGET = 32768;
+	const float MIN_OCCLUDER_SIZE = 0.1f; // Bounding sphere radius over its distance to the camera
+	const size_t MESHES_PER_RENDER_JOB = 32;
+}
+
 Level::Level()
 {
-	_root = new GameObject;
+	_root = CreateGameObject();
 
 	vec minPoint = vec(-10000, -100, -10000);
 	vec maxPoint = vec(10000, 100, 10000);
@@ -21,6 +35,11 @@ Level::Level()
 
 Level::~Level()
 {
+	// Only left when the level is destroyed without CleanUp
+	RELEASE(_quadtree);
+
+	for (RecordingRenderDevice*& commands : _meshCommands)
+		RELEASE(commands);
 }
 
 bool Level::CleanUp()
@@ -33,25 +52,74 @@ bool Level::CleanUp()
 
 	RELEASE(_root);
 
+	// Every destructor has run by now, the memory goes back in blocks instead of object by object
+	_arena.Reset();
+
+	_componentPools.clear();
+
+	for (RecordingRenderDevice*& commands : _meshCommands)
+		RELEASE(commands);
+	_meshCommands.clear();
+	_queuedMeshes.clear();
+	_visibleObjects.clear();
+
 	return true;
 }
 
+GameObject* Level::CreateGameObject()
+{
+	MEMORY_TAG_SCOPE(MemoryTag::SceneGraph);
+	return new (_arena) GameObject;
+}
+
+PoolAllocator& Level::getComponentPool(std::type_index type, size_t size)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::SceneGraph);
+	std::unique_ptr<PoolAllocator>& pool = _componentPools[type];
+	if (pool == nullptr)
+		pool.reset(new PoolAllocator(size + AllocatorUtils::OWNER_HEADER_SIZE));
+
+	return *pool;
+}
+
 void Level::PreUpdate(float dt)
 {
 	
 }
 
-void Level::Update(float dt)
+void Level::Simulate(float dt)
 {
-	std::vector<GameObject*> visibleObjects;
-	_quadtree->CollectIntersections(visibleObjects, App->GetModule<ModuleCameraManager>()->GetMainCamera()->GetFrustumAABB());
+	// Pipelined, the camera and bounds are the ones the previous frame left, so what moves shows up a frame late
+	CameraComponent* camera = App->GetModule<ModuleCameraManager>()->GetMainCamera();
+
+	_visibleObjects.clear();
+	_quadtree->CollectUniqueIntersections(_visibleObjects, camera->GetFrustumAABB());
 
-	for (GameObject* go : visibleObjects)
+	if (App->GetModule<ModuleSettings>()->OcclusionCulling)
+		cullOccluded(*camera, _visibleObjects);
+}
+
+void Level::Update(float dt)
+{
+	for (GameObject* go : _visibleObjects)
 		go->VisibleOnCamera = true;
 
+	// Meshes only queue their draw while the scene graph updates. What else is drawn meanwhile (particles,
+	// gizmos) is recorded as well and submitted after them, so blended geometry still goes last.
+	RenderDevice* device = RenderDevice::Current();
+	_sceneCommands.InheritStates(*device);
+	_sceneCommands.BeginFrame();
+	RenderDevice::MakeCurrent(&_sceneCommands);
+
 	_root->Update(dt);
 
-	for (GameObject* go : visibleObjects)
+	RenderDevice::MakeCurrent(device);
+	_sceneCommands.EndFrame();
+
+	drawMeshes(_visibleObjects, *device);
+	_sceneCommands.Replay(*device);
+
+	for (GameObject* go : _visibleObjects)
 		go->VisibleOnCamera = false;
 }
 
@@ -77,8 +145,32 @@ void Level::RegenerateQuadtree() const
 	}
 }
 
+void Level::UpdateBounds(GameObject* gameObject, const AABB& bounds)
+{
+	_quadtree->Remove(gameObject);
+	gameObject->BoundingBox = bounds;
+	_quadtree->Insert(gameObject);
+}
+
 GameObject* Level::FindGameObject(const char* name)
 {
+	std::stack<GameObject*> gameObjects;
+	gameObjects.push(_root);
+
+	while (!gameObjects.empty())
+	{
+		GameObject* current = gameObjects.top();
+		gameObjects.pop();
+
+		if (current->Name == name)
+			return current;
+
+		for (GameObject* child : current->GetChilds())
+		{
+			gameObjects.push(child);
+		}
+	}
+
 	return nullptr;
 }
 
@@ -100,6 +192,109 @@ const Quadtree& Level::GetQuadtree() const
 	return *_quadtree;
 }
 
+void Level::drawMeshes(const std::vector<GameObject*>& visibleObjects, RenderDevice& device)
+{
+	_queuedMeshes.clear();
+	for (GameObject* gameObject : visibleObjects)
+	{
+		for (BaseComponent* component : gameObject->GetComponents())
+		{
+			if (component->GetComponentClassId() == MeshComponent::GetClassId() && static_cast<MeshComponent*>(component)->IsDrawQueued())
+				_queuedMeshes.push_back(static_cast<MeshComponent*>(component));
+		}
+	}
+
+	if (!App->GetModule<ModuleSettings>()->ParallelRenderRecording)
+	{
+		_renderJobCount = 0;
+		for (MeshComponent* mesh : _queuedMeshes)
+			mesh->Draw();
+		return;
+	}
+
+	_renderJobCount = unsigned((_queuedMeshes.size() + MESHES_PER_RENDER_JOB - 1) / MESHES_PER_RENDER_JOB);
+	while (_meshCommands.size() < _renderJobCount)
+		_meshCommands.push_back(new RecordingRenderDevice);
+
+	App->GetModule<ModuleJobSystem>()->ParallelFor(_renderJobCount, [this, &device](unsigned job)
+	{
+		RecordingRenderDevice* commands = _meshCommands[job];
+		commands->InheritStates(device);
+		commands->BeginFrame();
+
+		// The calling thread takes jobs too, so its own device is put back afterwards
+		RenderDevice* previous = RenderDevice::Current();
+		RenderDevice::MakeCurrent(commands);
+
+		size_t end = MIN(size_t(job + 1) * MESHES_PER_RENDER_JOB, _queuedMeshes.size());
+		for (size_t i = size_t(job) * MESHES_PER_RENDER_JOB; i < end; ++i)
+			_queuedMeshes[i]->Draw();
+
+		RenderDevice::MakeCurrent(previous);
+		commands->EndFrame();
+	});
+
+	// Submitted in job order, the draw order does not depend on which job finished first
+	for (unsigned job = 0; job < _renderJobCount; ++job)
+		_meshCommands[job]->Replay(device);
+}
+
+void Level::cullOccluded(CameraComponent& camera, std::vector<GameObject*>& visibleObjects)
+{
+	// Big meshes close to the camera hide the most. Meshes around the camera would need clipping and are left out.
+	float3 eye = camera.Position();
+	std::vector<std::pair<float, GameObject*>> occluders;
+	for (GameObject* gameObject : visibleObjects)
+	{
+		const MeshComponent* meshComponent = gameObject->GetMeshComponent();
+		if (!gameObject->Enabled || meshComponent == nullptr || !meshComponent->Enabled)
+			continue;
+
+		float radius = gameObject->BoundingBox.HalfSize().Length();
+		float distance = gameObject->BoundingBox.CenterPoint().Distance(eye);
+		if (distance > radius && radius >= MIN_OCCLUDER_SIZE * distance)
+			occluders.push_back(std::make_pair(radius / distance, gameObject));
+	}
+
+	std::sort(occluders.begin(), occluders.end(), [](const std::pair<float, GameObject*>& a, const std::pair<float, GameObject*>& b)
+	{
+		return a.first > b.first;
+	});
+
+	std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
+	_occlusionBuffer.Clear(camera.GetFrustum().ViewProjMatrix());
+
+	size_t triangleBudget = OCCLUDER_TRIANGLE_BUDGET;
+	for (size_t i = 0; i < occluders.size() && i < MAX_OCCLUDERS; ++i)
+	{
+		GameObject* occluder = occluders[i].second;
+		float4x4 world = occluder->GetWorldTransform();
+
+		for (MeshHandle handle : occluder->GetMeshComponent()->Meshes)
+		{
+			// Skinned meshes only have their bind pose on the CPU
+			const Mesh* mesh = meshManager->GetMesh(handle);
+			if (mesh == nullptr || mesh->skin != nullptr)
+				continue;
+
+			const std::vector<TrianglePack>& packs = mesh->bvh != nullptr ? mesh->bvh->GetPacks() : mesh->triangles;
+			size_t triangles = packs.size() * RAY_TRIANGLE_LANES;
+			if (triangles > triangleBudget)
+				continue;
+
+			triangleBudget -= triangles;
+			_occlusionBuffer.RasterizeTriangles(world, packs.data(), packs.size());
+		}
+	}
+
+	_occlusionBuffer.BuildPyramid();
+
+	visibleObjects.erase(std::remove_if(visibleObjects.begin(), visibleObjects.end(), [this](GameObject* gameObject)
+	{
+		return gameObject->GetMeshComponent() != nullptr && !_occlusionBuffer.IsVisible(gameObject->BoundingBox);
+	}), visibleObjects.end());
+}
+
 void Level::cleanUpNodes(GameObject* node)
 {
 	for(GameObject* child : node->GetChilds())
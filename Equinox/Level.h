@@ -4,6 +4,17 @@
 #include "Primitive.h"
 #include "GameObject.h"
 #include "Quadtree.h"
+#include "MemoryArena.h"
+#include "PoolAllocator.h"
+#include "OcclusionBuffer.h"
+#include "RecordingRenderDevice.h"
+
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+
+class CameraComponent;
+class MeshComponent;
 
 class Level
 {
@@ -12,11 +23,15 @@ public:
 	~Level();
 
 	void PreUpdate(float dt);
+	// Culls the scene for the next Update. With pipelined frames it runs while the previous frame is submitted.
+	void Simulate(float dt);
 	void Update(float dt);
 	void PostUpdate(float dt);
 	bool CleanUp();
 
 	void RegenerateQuadtree() const;
+	// Moves a node in the quadtree to its new world bounds
+	void UpdateBounds(GameObject* gameObject, const AABB& bounds);
 
 	GameObject* GetRootNode() { return _root; }
 	const GameObject* GetRootNode() const { return _root; }
@@ -26,13 +41,50 @@ public:
 
 	void AddToScene(GameObject* go);
 
+	// GameObjects and components built with the level share its arena and are released all at once with it
+	GameObject* CreateGameObject();
+
+	template<typename TComponent, typename... Args>
+	TComponent* CreateComponent(Args&&... args)
+	{
+		MEMORY_TAG_SCOPE(MemoryTag::SceneGraph);
+		return new (_arena) TComponent(std::forward<Args>(args)...);
+	}
+
+	// Components spawned while the level runs come from a free list pool of their type, so they can be destroyed one by one
+	template<typename TComponent, typename... Args>
+	TComponent* SpawnComponent(Args&&... args)
+	{
+		MEMORY_TAG_SCOPE(MemoryTag::SceneGraph);
+		return new (getComponentPool(typeid(TComponent), sizeof(TComponent))) TComponent(std::forward<Args>(args)...);
+	}
+
+	size_t GetArenaUsedBytes() const { return _arena.GetUsedBytes(); }
+
 	const Quadtree& GetQuadtree() const;
+	const OcclusionStats& GetOcclusionStats() const { return _occlusionBuffer.GetStats(); }
+	unsigned GetRenderJobCount() const { return _renderJobCount; }
 
 private:
 	void cleanUpNodes(GameObject* node);
+	// Draws the biggest visible meshes into the occlusion buffer and drops the objects hidden behind them
+	void cullOccluded(CameraComponent& camera, std::vector<GameObject*>& visibleObjects);
+	// Records the queued mesh draws into command buffers from the job system and submits them on the calling thread
+	void drawMeshes(const std::vector<GameObject*>& visibleObjects, RenderDevice& device);
+	PoolAllocator& getComponentPool(std::type_index type, size_t size);
 
 	Quadtree* _quadtree = nullptr;
 	GameObject* _root = nullptr;
+	OcclusionBuffer _occlusionBuffer;
+
+	RecordingRenderDevice _sceneCommands; // Drawn while updating the scene graph, submitted after the meshes
+	std::vector<RecordingRenderDevice*> _meshCommands; // One command buffer per render job, kept to reuse their memory
+	std::vector<MeshComponent*> _queuedMeshes;
+	std::vector<GameObject*> _visibleObjects; // Found by Simulate, drawn by Update
+	unsigned _renderJobCount = 0;
+
+	MemoryArena _arena;
+	std::unordered_map<std::type_index, std::unique_ptr<PoolAllocator>> _componentPools;
 };
 
 #endif // __LEVEL_H__
\ No newline at end of file
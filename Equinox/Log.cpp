@@ -1,17 +1,26 @@
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdio.h>
+#include <stdarg.h>
 #include "Globals.h"
 
 void log(const char file[], int line, const char* format, ...)
 {
-	static char tmp_string[4096];
-	static char tmp_string2[4096];
-	static va_list  ap;
+	// Jobs log too, so the buffers are per call
+	char tmp_string[4096];
+	char tmp_string2[4096];
+	va_list  ap;
 
 	// Construct the string from variable arguments
 	va_start(ap, format);
-	vsprintf_s(tmp_string, 4096, format, ap);
+	vsnprintf(tmp_string, 4096, format, ap);
 	va_end(ap);
-	sprintf_s(tmp_string2, 4096, "\n%s(%d) : %s", file, line, tmp_string);
+	snprintf(tmp_string2, 4096, "\n%s(%d) : %s", file, line, tmp_string);
+
+#ifdef _WIN32
 	OutputDebugString(tmp_string2);
-}
\ No newline at end of file
+#endif
+	// Also on stdout, so unattended runs can capture the log by redirecting it
+	fputs(tmp_string2, stdout);
+}
@@ -1,25 +1,31 @@
 ﻿#include "IMGUI/imgui.h"
 
 #include "MaterialComponent.h"
+#include "ModuleMaterialManager.h"
+#include "Engine.h"
 
 MaterialComponent::MaterialComponent()
 {
+	_materialManager = App->GetModule<ModuleMaterialManager>();
 }
 
 MaterialComponent::~MaterialComponent()
 {
+	for (MaterialHandle material : Materials)
+		_materialManager->Release(material);
 }
 
-unsigned MaterialComponent::AddMaterial(Material* material)
+unsigned MaterialComponent::AddMaterial(MaterialHandle material)
 {
 	int count = 0;
-	for (Material* mat : Materials)
+	for (MaterialHandle mat : Materials)
 	{
 		if (mat == material)
 			return count;
 		++count;
 	}
 
+	_materialManager->AddRef(material);
 	Materials.push_back(material);
 	return count;
 }
@@ -1,17 +1,18 @@
 ﻿#ifndef __COMPONENT_MATERIAL_H__
 #define __COMPONENT_MATERIAL_H__
 #include "BaseComponent.h"
+#include "ResourcePool.h"
 #include "MathGeoLib/include/Math/float4.h"
-#include <list>
+#include <vector>
 
 struct Material
 {
-	int id = -1;
 	float4 ambient = float4(1.0f, 1.0f, 1.0f, 1.0f);
 	float4 diffuse = float4(1.0f, 1.0f, 1.0f, 1.0f);
 	float4 specular = float4(0.0f, 0.0f, 0.0f, 0.0f);
 	float shininess = 0.0f;
-	unsigned texture = 0;
+	TextureHandle texture;
+	float4 uvTransform = float4(1.0f, 1.0f, 0.0f, 0.0f); // xy scale, zw offset, places the texture inside its atlas page
 	char FilePath[256] = { 0 };
 };
 
@@ -20,13 +21,17 @@ class MaterialComponent :
 {
 	DEFINE_COMPONENT(MaterialComponent);
 public:
-	std::vector<Material*> Materials;
+	std::vector<MaterialHandle> Materials;
 	
 public:
 	MaterialComponent();
 	~MaterialComponent();
 
-	unsigned AddMaterial(Material* material);
+	// Returns the index of the material in the component, referencing it if it was not already there
+	unsigned AddMaterial(MaterialHandle material);
+
+private:
+	std::shared_ptr<class ModuleMaterialManager> _materialManager;
 };
 
 #endif
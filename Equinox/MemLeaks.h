@@ -1,17 +1,18 @@
 #ifndef __MEMLEAKS_H__
 #define __MEMLEAKS_H__
 
-	#define _CRTDBG_MAP_ALLOC
-	#include <stdlib.h>
-	#include <crtdbg.h>
+	#include "MemoryTracker.h"
 
-	#ifdef _DEBUG
-		#ifndef DBG_NEW
-			#define DBG_NEW new ( _NORMAL_BLOCK , __FILE__ , __LINE__ )
-			#define new DBG_NEW
-		#endif
-	#endif  // _DEBUG
+	// operator new is replaced by the MemoryTracker, so the CRT debug new (and its file/line
+	// macro, which also breaks placement new) is no longer used
+	#ifdef _MSC_VER
+		#define _CRTDBG_MAP_ALLOC
+		#include <stdlib.h>
+		#include <crtdbg.h>
 
-	#define ReportMemoryLeaks() _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF)
+		#define ReportMemoryLeaks() { _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF); MemoryTracker::ReportLeaksAtExit(); }
+	#else
+		#define ReportMemoryLeaks() MemoryTracker::ReportLeaksAtExit()
+	#endif
 
 #endif // __MEMLEAKS_H__
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "MemoryArena.h"
+#include "Globals.h"
+
+MemoryArena::MemoryArena(size_t blockSize) : _blockSize(blockSize)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+	Reset();
+}
+
+void* MemoryArena::Allocate(size_t size)
+{
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	if (size > _remaining)
+	{
+		// Big requests get a block of their own so they do not waste the rest of the current one
+		if (size > _blockSize / 4)
+		{
+			char* block = new char[size];
+			_blocks.push_back(block);
+			_reservedBytes += size;
+			_usedBytes += size;
+			return block;
+		}
+
+		_current = new char[_blockSize];
+		_remaining = _blockSize;
+		_blocks.push_back(_current);
+		_reservedBytes += _blockSize;
+	}
+
+	char* memory = _current;
+	_current += size;
+	_remaining -= size;
+	_usedBytes += size;
+	return memory;
+}
+
+void MemoryArena::Reset()
+{
+	for (char* block : _blocks)
+		RELEASE_ARRAY(block);
+
+	_blocks.clear();
+	_current = nullptr;
+	_remaining = 0;
+	_usedBytes = 0;
+	_reservedBytes = 0;
+}
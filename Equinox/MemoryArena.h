@@ -0,0 +1,39 @@
+#ifndef __MEMORYARENA_H__
+#define __MEMORYARENA_H__
+
+#include "Allocator.h"
+#include <vector>
+
+/*
+ * Linear allocator for objects that share a lifetime. Individual frees are ignored,
+ * all the memory is returned at once by Reset, one block at a time.
+ */
+class MemoryArena : public Allocator
+{
+public:
+	explicit MemoryArena(size_t blockSize = 64 * 1024);
+	~MemoryArena();
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+	void* Allocate(size_t size) override;
+	void Free(void* ptr) override {}
+
+	void Reset();
+
+	size_t GetUsedBytes() const { return _usedBytes; }
+	size_t GetReservedBytes() const { return _reservedBytes; }
+
+private:
+	static const size_t ALIGNMENT = 16;
+
+	size_t _blockSize;
+	std::vector<char*> _blocks;
+	char* _current = nullptr;
+	size_t _remaining = 0;
+	size_t _usedBytes = 0;
+	size_t _reservedBytes = 0;
+};
+
+#endif // __MEMORYARENA_H__
@@ -0,0 +1,260 @@
+#include "MemoryTracker.h"
+#include "Globals.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+	struct TagCounters
+	{
+		std::atomic<size_t> Bytes;
+		std::atomic<size_t> PeakBytes;
+		std::atomic<size_t> Allocations;
+		std::atomic<size_t> FrameAllocations;
+		std::atomic<size_t> LastFrameAllocations;
+		std::atomic<size_t> ExternalBytes;
+		std::atomic<size_t> Budget;
+		std::atomic<bool> OverBudget;
+	};
+
+	// Static storage is zero initialized before any dynamic initializer can allocate
+	TagCounters counters[size_t(MemoryTag::Count)];
+	thread_local MemoryTag currentTag = MemoryTag::General;
+
+	const char* TAG_NAMES[size_t(MemoryTag::Count)] =
+	{
+		"General",
+		"SceneGraph",
+		"Meshes",
+		"Textures",
+		"Particles",
+		"Animation",
+		"Collision",
+		"Editor"
+	};
+
+	// Keeps the returned memory 16 byte aligned
+	const size_t HEADER_SIZE = 16;
+
+	struct AllocationHeader
+	{
+		size_t Size;
+		MemoryTag Tag;
+	};
+
+	static_assert(sizeof(AllocationHeader) <= HEADER_SIZE, "Allocation header does not fit");
+
+	void* TrackedAllocate(size_t size)
+	{
+		char* memory = static_cast<char*>(malloc(size + HEADER_SIZE));
+		if (memory == nullptr)
+			return nullptr;
+
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(memory);
+		header->Size = size;
+		header->Tag = currentTag;
+		MemoryTracker::TrackAllocation(header->Tag, size);
+
+		return memory + HEADER_SIZE;
+	}
+
+	void TrackedFree(void* ptr)
+	{
+		if (ptr == nullptr)
+			return;
+
+		char* memory = static_cast<char*>(ptr) - HEADER_SIZE;
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(memory);
+		MemoryTracker::TrackFree(header->Tag, header->Size);
+
+		free(memory);
+	}
+
+	void ReportLeaks()
+	{
+		for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+		{
+			size_t allocations = counters[i].Allocations.load();
+			if (allocations > 0)
+			{
+				LOG("Memory still allocated at exit in %s: %i allocations, %i bytes", TAG_NAMES[i], int(allocations), int(counters[i].Bytes.load()));
+			}
+		}
+	}
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	return tag < MemoryTag::Count ? TAG_NAMES[size_t(tag)] : "Unknown";
+}
+
+bool MemoryTracker::GetTagByName(const char* name, MemoryTag& tag)
+{
+	for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+	{
+		if (strcmp(TAG_NAMES[i], name) == 0)
+		{
+			tag = MemoryTag(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+MemoryTag MemoryTracker::GetCurrentTag()
+{
+	return currentTag;
+}
+
+void MemoryTracker::SetCurrentTag(MemoryTag tag)
+{
+	currentTag = tag;
+}
+
+void MemoryTracker::TrackAllocation(MemoryTag tag, size_t size)
+{
+	TagCounters& tagCounters = counters[size_t(tag)];
+	size_t bytes = tagCounters.Bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	tagCounters.Allocations.fetch_add(1, std::memory_order_relaxed);
+	tagCounters.FrameAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	size_t peak = tagCounters.PeakBytes.load(std::memory_order_relaxed);
+	while (bytes > peak && !tagCounters.PeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+	{
+	}
+}
+
+void MemoryTracker::TrackFree(MemoryTag tag, size_t size)
+{
+	TagCounters& tagCounters = counters[size_t(tag)];
+	tagCounters.Bytes.fetch_sub(size, std::memory_order_relaxed);
+	tagCounters.Allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::TrackExternal(MemoryTag tag, ptrdiff_t delta)
+{
+	counters[size_t(tag)].ExternalBytes.fetch_add(size_t(delta), std::memory_order_relaxed);
+}
+
+void MemoryTracker::SetExternal(MemoryTag tag, size_t bytes)
+{
+	counters[size_t(tag)].ExternalBytes.store(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, size_t bytes)
+{
+	counters[size_t(tag)].Budget.store(bytes);
+}
+
+bool MemoryTracker::IsOverBudget(MemoryTag tag)
+{
+	const TagCounters& tagCounters = counters[size_t(tag)];
+	size_t budget = tagCounters.Budget.load();
+	return budget > 0 && tagCounters.Bytes.load() + tagCounters.ExternalBytes.load() > budget;
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag)
+{
+	const TagCounters& tagCounters = counters[size_t(tag)];
+
+	MemoryTagStats stats;
+	stats.Bytes = tagCounters.Bytes.load();
+	stats.PeakBytes = tagCounters.PeakBytes.load();
+	stats.Allocations = tagCounters.Allocations.load();
+	stats.FrameAllocations = tagCounters.LastFrameAllocations.load();
+	stats.ExternalBytes = tagCounters.ExternalBytes.load();
+	stats.Budget = tagCounters.Budget.load();
+	return stats;
+}
+
+size_t MemoryTracker::GetFrameAllocations()
+{
+	size_t total = 0;
+	for (const TagCounters& tagCounters : counters)
+		total += tagCounters.LastFrameAllocations.load();
+
+	return total;
+}
+
+void MemoryTracker::EndFrame()
+{
+	for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+	{
+		TagCounters& tagCounters = counters[i];
+		tagCounters.LastFrameAllocations.store(tagCounters.FrameAllocations.exchange(0));
+
+		bool overBudget = IsOverBudget(MemoryTag(i));
+		if (overBudget && !tagCounters.OverBudget.load())
+		{
+			LOG("Memory budget exceeded in %s: %i / %i KB", TAG_NAMES[i],
+				int((tagCounters.Bytes.load() + tagCounters.ExternalBytes.load()) / 1024), int(tagCounters.Budget.load() / 1024));
+		}
+
+		tagCounters.OverBudget.store(overBudget);
+	}
+}
+
+void MemoryTracker::ReportLeaksAtExit()
+{
+	atexit(ReportLeaks);
+}
+
+// Global allocation functions ----------------
+
+void* operator new(size_t size)
+{
+	void* memory = TrackedAllocate(size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	TrackedFree(ptr);
+}
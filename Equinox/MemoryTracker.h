@@ -0,0 +1,82 @@
+#ifndef __MEMORYTRACKER_H__
+#define __MEMORYTRACKER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+enum class MemoryTag : uint8_t
+{
+	General = 0,
+	SceneGraph,
+	Meshes,
+	Textures,
+	Particles,
+	Animation,
+	Collision,
+	Editor,
+	Count
+};
+
+struct MemoryTagStats
+{
+	size_t Bytes = 0;            // Live heap bytes
+	size_t PeakBytes = 0;
+	size_t Allocations = 0;      // Live heap allocations
+	size_t FrameAllocations = 0; // Allocations made during the last finished frame
+	size_t ExternalBytes = 0;    // Memory owned outside the heap, e.g. GPU buffers and textures
+	size_t Budget = 0;           // 0 means no budget
+};
+
+/*
+ * Every operator new goes through the tracker, which accounts the bytes to the tag active on the
+ * calling thread. Counters are atomic so jobs can allocate while the editor reads the stats.
+ */
+namespace MemoryTracker
+{
+	const char* GetTagName(MemoryTag tag);
+	bool GetTagByName(const char* name, MemoryTag& tag);
+
+	MemoryTag GetCurrentTag();
+	void SetCurrentTag(MemoryTag tag);
+
+	void TrackAllocation(MemoryTag tag, size_t size);
+	void TrackFree(MemoryTag tag, size_t size);
+
+	// Adds or removes memory the heap does not see, like VRAM
+	void TrackExternal(MemoryTag tag, ptrdiff_t delta);
+	void SetExternal(MemoryTag tag, size_t bytes);
+
+	void SetBudget(MemoryTag tag, size_t bytes);
+	bool IsOverBudget(MemoryTag tag);
+
+	MemoryTagStats GetStats(MemoryTag tag);
+	size_t GetFrameAllocations();
+
+	// Closes the frame: latches the per frame counters and warns about the tags over their budget
+	void EndFrame();
+
+	void ReportLeaksAtExit();
+}
+
+class MemoryTagScope
+{
+public:
+	explicit MemoryTagScope(MemoryTag tag) : _previous(MemoryTracker::GetCurrentTag())
+	{
+		MemoryTracker::SetCurrentTag(tag);
+	}
+
+	~MemoryTagScope()
+	{
+		MemoryTracker::SetCurrentTag(_previous);
+	}
+
+private:
+	MemoryTag _previous;
+};
+
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
+#define MEMORY_TAG_SCOPE(tag) MemoryTagScope MEMORY_TAG_CONCAT(memoryTagScope, __LINE__)(tag)
+
+#endif // __MEMORYTRACKER_H__
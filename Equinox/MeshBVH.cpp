@@ -0,0 +1,303 @@
+#include "MeshBVH.h"
+#include "Globals.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <stack>
+
+static_assert(sizeof(BVHNode) == 32, "BVH nodes must stay 32 bytes");
+
+namespace
+{
+	const unsigned SAH_BINS = 12;
+	const float TRAVERSAL_COST = 1.f; // Relative to testing one triangle pack
+
+	struct Bounds
+	{
+		float Min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float Max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Grow(const float* point)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				Min[axis] = MIN(Min[axis], point[axis]);
+				Max[axis] = MAX(Max[axis], point[axis]);
+			}
+		}
+
+		void Grow(const Bounds& other)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				Min[axis] = MIN(Min[axis], other.Min[axis]);
+				Max[axis] = MAX(Max[axis], other.Max[axis]);
+			}
+		}
+
+		float HalfArea() const
+		{
+			float x = Max[0] - Min[0], y = Max[1] - Min[1], z = Max[2] - Min[2];
+			return x < 0.f ? 0.f : x * y + y * z + z * x;
+		}
+	};
+
+	struct BuildTask
+	{
+		uint32_t Node;
+		uint32_t Begin;
+		uint32_t End;
+		uint32_t Depth;
+	};
+
+	inline float PackCount(uint32_t triangles)
+	{
+		return float((triangles + RAY_TRIANGLE_LANES - 1) / RAY_TRIANGLE_LANES);
+	}
+
+	inline unsigned BinOf(float centroid, float min, float scale)
+	{
+		return MIN(unsigned((centroid - min) * scale), SAH_BINS - 1);
+	}
+
+	// Entry distance of the ray in the box, FLT_MAX when it misses or enters beyond maxDistance
+	inline float IntersectBox(const BVHNode& node, const float* origin, const float* invDirection, float maxDistance)
+	{
+		float tMin = 0.f, tMax = maxDistance;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t1 = (node.Min[axis] - origin[axis]) * invDirection[axis];
+			float t2 = (node.Max[axis] - origin[axis]) * invDirection[axis];
+			tMin = MAX(tMin, MIN(t1, t2));
+			tMax = MIN(tMax, MAX(t1, t2));
+		}
+
+		return tMin <= tMax ? tMin : FLT_MAX;
+	}
+}
+
+void MeshBVH::Build(const float3* vertices, const uint32_t* indices, size_t triangleCount)
+{
+	_nodes.clear();
+	_packs.clear();
+
+	if (triangleCount == 0)
+		return;
+
+	std::vector<Bounds> triangleBounds(triangleCount);
+	std::vector<float> centroids(triangleCount * 3);
+	std::vector<uint32_t> order(triangleCount);
+
+	for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+	{
+		for (int corner = 0; corner < 3; ++corner)
+			triangleBounds[triangle].Grow(vertices[indices[triangle * 3 + corner]].ptr());
+
+		for (int axis = 0; axis < 3; ++axis)
+			centroids[triangle * 3 + axis] = (triangleBounds[triangle].Min[axis] + triangleBounds[triangle].Max[axis]) * 0.5f;
+
+		order[triangle] = triangle;
+	}
+
+	_nodes.reserve(2 * (triangleCount / RAY_TRIANGLE_LANES) + 1);
+	_nodes.emplace_back();
+
+	std::vector<uint32_t> leafIndices;
+	std::stack<BuildTask> tasks;
+	tasks.push({ 0, 0, uint32_t(triangleCount), 0 });
+
+	while (!tasks.empty())
+	{
+		BuildTask task = tasks.top();
+		tasks.pop();
+
+		Bounds bounds, centroidBounds;
+		for (uint32_t i = task.Begin; i < task.End; ++i)
+		{
+			bounds.Grow(triangleBounds[order[i]]);
+			centroidBounds.Grow(&centroids[order[i] * 3]);
+		}
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			_nodes[task.Node].Min[axis] = bounds.Min[axis];
+			_nodes[task.Node].Max[axis] = bounds.Max[axis];
+		}
+
+		uint32_t count = task.End - task.Begin;
+		float leafCost = PackCount(count) * bounds.HalfArea();
+
+		// Binned SAH, costs count packs since that is what a leaf tests
+		int bestAxis = -1;
+		unsigned bestBin = 0;
+		float bestCost = FLT_MAX;
+
+		if (count > RAY_TRIANGLE_LANES && task.Depth < BVH_STACK_SIZE - 1)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+				if (extent <= 0.f)
+					continue;
+
+				Bounds binBounds[SAH_BINS];
+				uint32_t binCounts[SAH_BINS] = { 0 };
+				float scale = SAH_BINS / extent;
+
+				for (uint32_t i = task.Begin; i < task.End; ++i)
+				{
+					unsigned bin = BinOf(centroids[order[i] * 3 + axis], centroidBounds.Min[axis], scale);
+					binBounds[bin].Grow(triangleBounds[order[i]]);
+					++binCounts[bin];
+				}
+
+				float rightCosts[SAH_BINS];
+				Bounds right;
+				uint32_t rightCount = 0;
+				for (unsigned bin = SAH_BINS - 1; bin > 0; --bin)
+				{
+					right.Grow(binBounds[bin]);
+					rightCount += binCounts[bin];
+					rightCosts[bin] = PackCount(rightCount) * right.HalfArea();
+				}
+
+				Bounds left;
+				uint32_t leftCount = 0;
+				for (unsigned bin = 0; bin < SAH_BINS - 1; ++bin)
+				{
+					left.Grow(binBounds[bin]);
+					leftCount += binCounts[bin];
+
+					float cost = PackCount(leftCount) * left.HalfArea() + rightCosts[bin + 1];
+					if (leftCount > 0 && leftCount < count && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = bin;
+					}
+				}
+			}
+		}
+
+		bool split = bestAxis >= 0 && (count > BVH_MAX_LEAF_TRIANGLES || TRAVERSAL_COST * bounds.HalfArea() + bestCost < leafCost);
+		if (split)
+		{
+			float min = centroidBounds.Min[bestAxis];
+			float scale = SAH_BINS / (centroidBounds.Max[bestAxis] - min);
+			uint32_t* middle = std::partition(&order[task.Begin], &order[0] + task.End, [&](uint32_t triangle)
+			{
+				return BinOf(centroids[triangle * 3 + bestAxis], min, scale) <= bestBin;
+			});
+
+			uint32_t left = uint32_t(_nodes.size());
+			_nodes.emplace_back();
+			_nodes.emplace_back();
+
+			_nodes[task.Node].LeftOrFirst = left;
+			_nodes[task.Node].PackCount = 0;
+
+			uint32_t middleIndex = uint32_t(middle - &order[0]);
+			tasks.push({ left, task.Begin, middleIndex, task.Depth + 1 });
+			tasks.push({ left + 1, middleIndex, task.End, task.Depth + 1 });
+		}
+		else
+		{
+			leafIndices.clear();
+			for (uint32_t i = task.Begin; i < task.End; ++i)
+				leafIndices.insert(leafIndices.end(), &indices[order[i] * 3], &indices[order[i] * 3] + 3);
+
+			uint32_t firstPack = uint32_t(_packs.size());
+			RayTriangle::BuildPacks(vertices, leafIndices.data(), count, _packs);
+
+			// Packs number triangles inside the leaf, map them back to the mesh
+			for (size_t pack = firstPack; pack < _packs.size(); ++pack)
+			{
+				for (unsigned lane = 0; lane < RAY_TRIANGLE_LANES; ++lane)
+				{
+					uint32_t& triangle = _packs[pack].Triangle[lane];
+					if (triangle != 0xFFFFFFFF)
+						triangle = order[task.Begin + triangle];
+				}
+			}
+
+			_nodes[task.Node].LeftOrFirst = firstPack;
+			_nodes[task.Node].PackCount = uint32_t(_packs.size()) - firstPack;
+		}
+	}
+}
+
+bool MeshBVH::Intersect(const float3& origin, const float3& direction, RayTriangleHit& hit) const
+{
+	if (_nodes.empty())
+		return false;
+
+	const float* rayOrigin = origin.ptr();
+	float invDirection[3] = { 1.f / direction.x, 1.f / direction.y, 1.f / direction.z };
+
+	// Far children wait here with their entry distance, so they are skipped if a closer hit shows up
+	uint32_t stackNodes[BVH_STACK_SIZE];
+	float stackDistances[BVH_STACK_SIZE];
+	unsigned stackSize = 0;
+
+	bool found = false;
+	uint32_t current = 0;
+	if (IntersectBox(_nodes[0], rayOrigin, invDirection, hit.Distance) == FLT_MAX)
+		return false;
+
+	for (;;)
+	{
+		const BVHNode& node = _nodes[current];
+		if (node.PackCount > 0)
+		{
+			found |= RayTriangle::Intersect(origin, direction, &_packs[node.LeftOrFirst], node.PackCount, hit);
+		}
+		else
+		{
+			uint32_t nearChild = node.LeftOrFirst;
+			uint32_t farChild = node.LeftOrFirst + 1;
+			float nearDistance = IntersectBox(_nodes[nearChild], rayOrigin, invDirection, hit.Distance);
+			float farDistance = IntersectBox(_nodes[farChild], rayOrigin, invDirection, hit.Distance);
+
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+
+			if (nearDistance != FLT_MAX)
+			{
+				if (farDistance != FLT_MAX)
+				{
+					stackNodes[stackSize] = farChild;
+					stackDistances[stackSize] = farDistance;
+					++stackSize;
+				}
+
+				current = nearChild;
+				continue;
+			}
+		}
+
+		// The build caps the depth, so the stack never holds more than one node per level
+		bool popped = false;
+		while (stackSize > 0 && !popped)
+		{
+			--stackSize;
+			if (stackDistances[stackSize] < hit.Distance)
+			{
+				current = stackNodes[stackSize];
+				popped = true;
+			}
+		}
+
+		if (!popped)
+			break;
+	}
+
+	return found;
+}
+
+size_t MeshBVH::GetMemoryUsage() const
+{
+	return _nodes.capacity() * sizeof(BVHNode) + _packs.capacity() * sizeof(TrianglePack);
+}
@@ -0,0 +1,43 @@
+#ifndef __MESHBVH_H__
+#define __MESHBVH_H__
+
+#include "RayTriangle.h"
+#include <cstdint>
+#include <vector>
+
+#define BVH_MAX_LEAF_TRIANGLES 8
+#define BVH_STACK_SIZE 64
+
+// 32 bytes, two nodes per cache line. Children of an inner node are stored next to each other.
+struct BVHNode
+{
+	float Min[3];
+	uint32_t LeftOrFirst; // Inner node: index of the left child. Leaf: first triangle pack.
+	float Max[3];
+	uint32_t PackCount; // 0 for inner nodes
+};
+
+/*
+ * Triangle BVH of a single mesh, built with binned SAH splits. Leaf triangles are stored as
+ * TrianglePacks in leaf order, so a leaf is a contiguous run of SIMD tests.
+ */
+class MeshBVH
+{
+public:
+	void Build(const float3* vertices, const uint32_t* indices, size_t triangleCount);
+
+	// Same contract as RayTriangle::Intersect, triangle ids are the ones of the source mesh
+	bool Intersect(const float3& origin, const float3& direction, RayTriangleHit& hit) const;
+
+	bool IsEmpty() const { return _nodes.empty(); }
+	size_t GetNodeCount() const { return _nodes.size(); }
+	size_t GetMemoryUsage() const;
+	// Every triangle of the mesh in leaf order
+	const std::vector<TrianglePack>& GetPacks() const { return _packs; }
+
+private:
+	std::vector<BVHNode> _nodes;
+	std::vector<TrianglePack> _packs;
+};
+
+#endif // __MESHBVH_H__
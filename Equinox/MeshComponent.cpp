@@ -4,90 +4,307 @@
 #include <GL/glew.h>
 #include "IMGUI/imgui.h"
 #include "ProgramManager.h"
+#include "ModuleTextures.h"
+#include "ModuleMeshManager.h"
+#include "ModuleMaterialManager.h"
+#include "ModuleSettings.h"
+#include "TransformComponent.h"
+#include "ModuleCameraManager.h"
+#include "CameraComponent.h"
+#include "RenderDevice.h"
+#include "ModuleRender.h"
 
+#include <stack>
+
+namespace
+{
+	// Projected radius over half the screen height below which each LOD hands over to the next one
+	const float LOD_SCREEN_SIZES[MAX_MESH_LODS - 1] = { 0.3f, 0.12f, 0.05f };
+	const float LOD_HYSTERESIS = 1.2f;
+}
 
 MeshComponent::MeshComponent()
 {
 	_programManager = App->GetModule<ProgramManager>();
 	_shaderUnlit = _programManager->GetProgramByName("Unlit");
+	_moduleTextures = App->GetModule<ModuleTextures>();
+	_meshManager = App->GetModule<ModuleMeshManager>();
+	_materialManager = App->GetModule<ModuleMaterialManager>();
+	_cameraManager = App->GetModule<ModuleCameraManager>();
+	_shaderSkinned = _programManager->GetProgramByName("Skinned");
+	_gpuSkinning = App->GetModule<ModuleSettings>()->GpuSkinning;
 }
 
 MeshComponent::~MeshComponent()
 {
+	for (MeshHandle mesh : Meshes)
+		_meshManager->Release(mesh);
+}
+
+void MeshComponent::AddMesh(MeshHandle mesh)
+{
+	_meshManager->AddRef(mesh);
+	Meshes.push_back(mesh);
+
+	if (Parent != nullptr)
+		Parent->InvalidateBounds();
 }
 
 void MeshComponent::Update(float dt)
 {
 	if (Parent->VisibleOnCamera)
 	{
-		glEnable(GL_LIGHTING);
-		glEnable(GL_COLOR_MATERIAL);
+		selectLod();
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_NORMAL_ARRAY);
-
-		for (Mesh* mesh : Meshes)
+		for (MeshHandle meshHandle : Meshes)
 		{
-			glColor3f(1.f, 1.f, 1.f);
-			Material* mat = MaterialComponent->Materials[mesh->materialInComponent];
+			const Mesh* mesh = _meshManager->GetMesh(meshHandle);
+			Material* mat = _materialManager->GetMaterial(MaterialComponent->Materials[mesh->materialInComponent]);
 
-			glMaterialfv(GL_FRONT, GL_AMBIENT, reinterpret_cast<GLfloat*>(&mat->ambient));
-			glMaterialfv(GL_FRONT, GL_DIFFUSE, reinterpret_cast<GLfloat*>(&mat->diffuse));
-			glMaterialfv(GL_FRONT, GL_SPECULAR, reinterpret_cast<GLfloat*>(&mat->specular));
-			glMaterialf(GL_FRONT, GL_SHININESS, mat->shininess);
+			if (mesh->textureCoordsID && 0 != _moduleTextures->GetTextureId(mat->texture))
+				_moduleTextures->Touch(mat->texture);
 
-			glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexID);
-			glVertexPointer(3, GL_FLOAT, 0, nullptr);
+			if (mesh->skin != nullptr && !skinsOnGpu(*mesh->skin))
+				createSkinnedBuffers(*mesh->skin);
+		}
 
-			if (mesh->normalID != 0)
-			{
-				glBindBuffer(GL_ARRAY_BUFFER, mesh->normalID);
-				glNormalPointer(GL_FLOAT, 0, nullptr);
-			}
-			
-			_programManager->UseProgram(_shaderUnlit);
-			int diffuse_id = glGetUniformLocation(_shaderUnlit->id, "diffuse");
-			int useColor_id = glGetUniformLocation(_shaderUnlit->id, "useColor");
-			if (mesh->textureCoordsID && 0 != mat->texture)
+		_drawQueued = true;
+	}
+}
+
+void MeshComponent::EditorUpdate(float dt)
+{
+	Update(dt);
+}
+
+void MeshComponent::Draw()
+{
+	_drawQueued = false;
+
+	RenderDevice* device = RenderDevice::Current();
+	device->PushMatrix();
+	device->MultMatrix(Parent->GetWorldTransform());
+
+	device->SetState(RenderState::Lighting, true);
+	device->SetState(RenderState::ColorMaterial, true);
+
+	device->SetVertexArray(VertexArray::Position, true);
+	device->SetVertexArray(VertexArray::Normal, true);
+
+	for (size_t meshIndex = 0; meshIndex < Meshes.size(); ++meshIndex)
+	{
+		const Mesh* mesh = _meshManager->GetMesh(Meshes[meshIndex]);
+		Material* mat = _materialManager->GetMaterial(MaterialComponent->Materials[mesh->materialInComponent]);
+		unsigned texture = _moduleTextures->GetTextureId(mat->texture);
+
+		device->SetColor(float4(1.f, 1.f, 1.f, 1.f));
+		device->SetMaterial(mat->ambient.ptr(), mat->diffuse.ptr(), mat->specular.ptr(), mat->shininess);
+
+		GLuint vertexID = mesh->vertexID;
+		GLuint normalID = mesh->normalID;
+		std::shared_ptr<ShaderProgram> shader = _shaderUnlit;
+		bool boneAttributes = false;
+
+		if (mesh->skin != nullptr)
+		{
+			computePalette(meshIndex, *mesh->skin);
+
+			if (skinsOnGpu(*mesh->skin))
 			{
-				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-				glBindBuffer(GL_ARRAY_BUFFER, mesh->textureCoordsID);
-				glTexCoordPointer(3, GL_FLOAT, 0, nullptr);
-				glUniform1i(useColor_id, 0);
+				shader = _shaderSkinned;
 			}
 			else
 			{
-				
-				glUniform1i(useColor_id, 1);
+				skinOnCpu(*mesh->skin);
+				vertexID = mesh->skin->SkinnedVertexID;
+				normalID = mesh->normalID != 0 ? mesh->skin->SkinnedNormalID : 0;
 			}
+		}
 
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, mat->texture);
-			glUniform1i(diffuse_id, 0);
+		device->BindBuffer(BufferTarget::Vertices, vertexID);
+		device->SetVertexPointer(VertexArray::Position, 3, 0, 0);
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexesID);
-			glDrawElements(GL_TRIANGLES, mesh->num_indices, GL_UNSIGNED_INT, nullptr);
+		if (normalID != 0)
+		{
+			device->BindBuffer(BufferTarget::Vertices, normalID);
+			device->SetVertexPointer(VertexArray::Normal, 3, 0, 0);
+		}
+		
+		_programManager->UseProgram(shader);
 
-			glMaterialfv(GL_FRONT, GL_AMBIENT, DEFAULT_GL_AMBIENT);
-			glMaterialfv(GL_FRONT, GL_DIFFUSE, DEFAULT_GL_DIFFUSE);
-			glMaterialfv(GL_FRONT, GL_SPECULAR, DEFAULT_GL_SPECULAR);
-			glMaterialf(GL_FRONT, GL_SHININESS, DEFAULT_GL_SHININESS);
+		if (shader == _shaderSkinned)
+		{
+			device->SetUniform("palette", _palette.data(), _palette.size());
+			device->SetVertexAttribute("boneIndices", SKINNING_INFLUENCES, mesh->skin->BoneIndicesID);
+			device->SetVertexAttribute("boneWeights", SKINNING_INFLUENCES, mesh->skin->BoneWeightsID);
+			boneAttributes = true;
+		}
+		if (mesh->textureCoordsID && 0 != texture)
+		{
+			device->SetVertexArray(VertexArray::TextureCoords, true);
+			device->BindBuffer(BufferTarget::Vertices, mesh->textureCoordsID);
+			device->SetVertexPointer(VertexArray::TextureCoords, 3, 0, 0);
+			device->SetUniform("useColor", 0);
+			device->SetUniform("uvTransform", mat->uvTransform);
+		}
+		else
+		{
+			
+			device->SetUniform("useColor", 1);
+		}
+
+		device->BindTexture(0, texture);
+		device->SetUniform("diffuse", 0);
+
+		unsigned lod = MIN(_lod, unsigned(mesh->lods.size()));
+		_meshManager->CountLodDraw(lod);
+
+		if (lod == 0)
+		{
+			device->BindBuffer(BufferTarget::Indices, mesh->indexesID);
+			device->DrawIndexed(PrimitiveType::Triangles, mesh->num_indices);
+		}
+		else
+		{
+			device->BindBuffer(BufferTarget::Indices, mesh->lods[lod - 1].indexesID);
+			device->DrawIndexed(PrimitiveType::Triangles, mesh->lods[lod - 1].num_indices);
+		}
 
-			_programManager->UseDefaultProgram();
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		if (boneAttributes)
+		{
+			device->DisableVertexAttribute("boneIndices");
+			device->DisableVertexAttribute("boneWeights");
 		}
 
-		glDisableClientState(GL_NORMAL_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		device->SetMaterial(DEFAULT_GL_AMBIENT, DEFAULT_GL_DIFFUSE, DEFAULT_GL_SPECULAR, DEFAULT_GL_SHININESS);
 
-		glDisable(GL_COLOR_MATERIAL);
-		glDisable(GL_LIGHTING);
+		_programManager->UseDefaultProgram();
+		device->BindBuffer(BufferTarget::Vertices, 0);
+		device->BindBuffer(BufferTarget::Indices, 0);
 	}
+
+	device->SetVertexArray(VertexArray::Normal, false);
+	device->SetVertexArray(VertexArray::Position, false);
+	device->SetVertexArray(VertexArray::TextureCoords, false);
+
+	device->SetState(RenderState::ColorMaterial, false);
+	device->SetState(RenderState::Lighting, false);
+
+	device->PopMatrix();
 }
 
-void MeshComponent::EditorUpdate(float dt)
+void MeshComponent::selectLod()
 {
-	Update(dt);
+	CameraComponent* camera = _cameraManager->GetMainCamera();
+	if (camera == nullptr || !Parent->BoundingBox.IsFinite())
+	{
+		_lod = 0;
+		return;
+	}
+
+	float radius = Parent->BoundingBox.HalfSize().Length();
+	float distance = camera->Position().Distance(Parent->BoundingBox.CenterPoint());
+	float screenSize = distance > radius ? radius / (distance * tanf(camera->GetFrustum().VerticalFov() * 0.5f)) : 1.f;
+
+	while (_lod + 1 < MAX_MESH_LODS && screenSize < LOD_SCREEN_SIZES[_lod])
+		++_lod;
+
+	while (_lod > 0 && screenSize > LOD_SCREEN_SIZES[_lod - 1] * LOD_HYSTERESIS)
+		--_lod;
+}
+
+void MeshComponent::bindBones(size_t meshIndex, const MeshSkin& skin)
+{
+	// Bones are searched under the model the mesh belongs to, the node right below the level root
+	GameObject* modelRoot = Parent;
+	while (modelRoot->GetParent() != nullptr && modelRoot->GetParent()->GetParent() != nullptr)
+		modelRoot = modelRoot->GetParent();
+
+	std::vector<GameObject*>& bones = _meshBones[meshIndex];
+	bones.assign(skin.BoneNames.size(), nullptr);
+
+	std::stack<GameObject*> gameObjects;
+	gameObjects.push(modelRoot);
+
+	while (!gameObjects.empty())
+	{
+		GameObject* current = gameObjects.top();
+		gameObjects.pop();
+
+		for (size_t bone = 0; bone < skin.BoneNames.size(); ++bone)
+		{
+			if (bones[bone] == nullptr && current->Name == skin.BoneNames[bone])
+				bones[bone] = current;
+		}
+
+		for (GameObject* child : current->GetChilds())
+		{
+			gameObjects.push(child);
+		}
+	}
+
+	for (size_t bone = 0; bone < bones.size(); ++bone)
+	{
+		if (bones[bone] == nullptr)
+			LOG("Bone %s not found for mesh of %s, it will stay in bind pose", skin.BoneNames[bone].c_str(), Parent->Name.c_str());
+	}
+}
+
+void MeshComponent::computePalette(size_t meshIndex, const MeshSkin& skin)
+{
+	if (_meshBones.size() < Meshes.size())
+		_meshBones.resize(Meshes.size());
+
+	if (_meshBones[meshIndex].size() != skin.BoneNames.size())
+		bindBones(meshIndex, skin);
+
+	const std::vector<GameObject*>& bones = _meshBones[meshIndex];
+	float4x4 meshToWorldInverse = Parent->GetWorldTransform().Inverted();
+
+	_palette.resize(bones.size());
+	for (size_t bone = 0; bone < bones.size(); ++bone)
+	{
+		if (bones[bone] != nullptr)
+			_palette[bone] = meshToWorldInverse * bones[bone]->GetWorldTransform() * skin.InverseBindMatrices[bone];
+		else
+			_palette[bone] = float4x4::identity;
+	}
+}
+
+bool MeshComponent::skinsOnGpu(const MeshSkin& skin) const
+{
+	return _gpuSkinning && _shaderSkinned != nullptr && _shaderSkinned->linked && skin.BoneNames.size() <= MAX_SKINNING_BONES;
+}
+
+void MeshComponent::createSkinnedBuffers(MeshSkin& skin) const
+{
+	// Buffers can only be created on the main thread, the contents are streamed by the draw
+	RenderDevice* device = App->GetModule<ModuleRender>()->GetDevice();
+	if (skin.SkinnedVertexID == 0)
+		skin.SkinnedVertexID = device->CreateBuffer(BufferTarget::Vertices, nullptr, 0);
+
+	if (skin.SkinnedNormalID == 0 && skin.BindNormals.size() == skin.BindPositions.size())
+		skin.SkinnedNormalID = device->CreateBuffer(BufferTarget::Vertices, nullptr, 0);
+}
+
+void MeshComponent::skinOnCpu(const MeshSkin& skin)
+{
+	size_t vertexCount = skin.BindPositions.size();
+	bool hasNormals = skin.BindNormals.size() == vertexCount;
+
+	_skinnedPositions.resize(vertexCount);
+	_skinnedNormals.resize(hasNormals ? vertexCount : 0);
+
+	Skinning::SkinVertices(skin, _palette.data(), _palette.size(), _skinnedPositions.data(), hasNormals ? _skinnedNormals.data() : nullptr);
+
+	// Orphan the previous contents so the driver does not stall on last frame's draw
+	RenderDevice* device = RenderDevice::Current();
+	device->StreamBuffer(BufferTarget::Vertices, skin.SkinnedVertexID, _skinnedPositions.data(), sizeof(float3) * vertexCount);
+
+	if (hasNormals)
+	{
+		device->StreamBuffer(BufferTarget::Vertices, skin.SkinnedNormalID, _skinnedNormals.data(), sizeof(float3) * vertexCount);
+	}
+
+	device->BindBuffer(BufferTarget::Vertices, 0);
 }
@@ -2,13 +2,23 @@
 #define __COMPONENT_MESH_H__
 #include "BaseComponent.h"
 #include <GL/glew.h>
-#include <list>
+#include <vector>
 #include "MaterialComponent.h"
+#include "Skinning.h"
+#include "MeshBVH.h"
+
+#define MAX_MESH_LODS 4 // Including the full resolution mesh
+
+// Coarser index buffer over the vertices of the mesh
+struct MeshLod
+{
+	GLuint indexesID = 0;
+	unsigned num_indices = 0;
+};
 
 struct Mesh
 {
-	int id = -1;
-	int material = 0;
+	MaterialHandle material;
 	GLuint vertexID = 0;
 	GLuint normalID = 0;
 	GLuint textureCoordsID = 0;
@@ -17,7 +27,13 @@ struct Mesh
 	GLuint indexesID = 0;
 	unsigned num_vertices = 0;
 	unsigned num_indices = 0;
+	size_t gpuBytes = 0;
 	AABB boundingBox;
+	MeshSkin* skin = nullptr; // Only for meshes with bones
+	std::vector<MeshLod> lods; // LOD 1 onwards, LOD 0 is the mesh itself
+	// CPU copy of the triangles for scene queries, either as a BVH or as plain packs when the BVH is disabled
+	MeshBVH* bvh = nullptr;
+	std::vector<TrianglePack> triangles;
 };
 
 struct ShaderProgram;
@@ -30,21 +46,51 @@ public:
 	MeshComponent();
 	~MeshComponent();
 
+	// Picks the LOD and creates the GL buffers the draw needs, then queues the draw when visible
 	void Update(float dt) override;
 	void EditorUpdate(float dt) override;
 
+	// Records the queued draw to the current render device, with the world transform of the object.
+	// Only touches this component, so components can be drawn from different threads at once.
+	void Draw();
+	bool IsDrawQueued() const { return _drawQueued; }
+
 	const GLfloat DEFAULT_GL_AMBIENT[4] = { 0.2f, 0.2f, 0.2f, 1.f };
 	const GLfloat DEFAULT_GL_DIFFUSE[4] = { 0.8f, 0.8f, 0.8f, 1.f };
 	const GLfloat DEFAULT_GL_SPECULAR[4] = { 0.f, 0.f, 0.f, 1.f };
 	const GLfloat DEFAULT_GL_SHININESS = 0.f;	
 
-	std::list<Mesh*> Meshes;
+	// Keeps a reference to the mesh until the component is destroyed
+	void AddMesh(MeshHandle mesh);
+
+	std::vector<MeshHandle> Meshes;
 	MaterialComponent* MaterialComponent;
 
 private:
+	void bindBones(size_t meshIndex, const MeshSkin& skin);
+	void computePalette(size_t meshIndex, const MeshSkin& skin);
+	bool skinsOnGpu(const MeshSkin& skin) const;
+	void createSkinnedBuffers(MeshSkin& skin) const;
+	void skinOnCpu(const MeshSkin& skin);
+	// Picks the LOD from the projected size of the bounding box, switching back to finer LODs a bit later to avoid popping
+	void selectLod();
+
 	std::shared_ptr<class ProgramManager> _programManager;
+	std::shared_ptr<class ModuleMeshManager> _meshManager;
+	std::shared_ptr<class ModuleMaterialManager> _materialManager;
+	std::shared_ptr<class ModuleTextures> _moduleTextures;
+	std::shared_ptr<class ModuleCameraManager> _cameraManager;
 
 	std::shared_ptr<ShaderProgram> _shaderUnlit;
+	std::shared_ptr<ShaderProgram> _shaderSkinned;
+	bool _gpuSkinning = true;
+	unsigned _lod = 0;
+	bool _drawQueued = false;
+
+	std::vector<std::vector<GameObject*>> _meshBones; // Bone nodes of every skinned mesh, bound on first draw
+	std::vector<float4x4> _palette;
+	std::vector<float3> _skinnedPositions;
+	std::vector<float3> _skinnedNormals;
 };
 
 #endif
@@ -0,0 +1,102 @@
+#include "MeshSimplifier.h"
+#include "Globals.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cfloat>
+
+void MeshSimplifier::ClusterVertices(const float3* vertices, size_t vertexCount, const uint32_t* indices, size_t triangleCount,
+	unsigned gridResolution, std::vector<uint32_t>& simplifiedIndices)
+{
+	simplifiedIndices.clear();
+	if (vertexCount == 0 || triangleCount == 0 || gridResolution == 0)
+		return;
+
+	float3 min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		min = min.Min(vertices[v]);
+		max = max.Max(vertices[v]);
+	}
+
+	float3 size = max - min;
+	float cellSize = MAX(size.x, MAX(size.y, size.z)) / gridResolution;
+	if (cellSize <= 0.f)
+	{
+		simplifiedIndices.assign(indices, indices + triangleCount * 3);
+		return;
+	}
+
+	struct Cluster
+	{
+		float3 Sum = float3::zero;
+		unsigned Count = 0;
+		uint32_t Representative = 0;
+		float BestDistance = FLT_MAX;
+	};
+
+	// Cell of every vertex, and the mean position of every cell
+	std::unordered_map<uint64_t, uint32_t> cellToCluster;
+	std::vector<Cluster> clusters;
+	std::vector<uint32_t> vertexCluster(vertexCount);
+
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		uint64_t x = uint64_t((vertices[v].x - min.x) / cellSize);
+		uint64_t y = uint64_t((vertices[v].y - min.y) / cellSize);
+		uint64_t z = uint64_t((vertices[v].z - min.z) / cellSize);
+		uint64_t cell = (x << 42) | (y << 21) | z;
+
+		auto it = cellToCluster.find(cell);
+		if (it == cellToCluster.end())
+		{
+			it = cellToCluster.emplace(cell, uint32_t(clusters.size())).first;
+			clusters.emplace_back();
+		}
+
+		Cluster& cluster = clusters[it->second];
+		cluster.Sum += vertices[v];
+		++cluster.Count;
+		vertexCluster[v] = it->second;
+	}
+
+	// The vertex closest to the mean stands for the cell, keeping its normal and UVs
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		Cluster& cluster = clusters[vertexCluster[v]];
+		float3 mean = cluster.Sum / float(cluster.Count);
+		float distance = vertices[v].DistanceSq(mean);
+		if (distance < cluster.BestDistance)
+		{
+			cluster.BestDistance = distance;
+			cluster.Representative = uint32_t(v);
+		}
+	}
+
+	// Several triangles can collapse onto the same one, keep only the first. Keys are exact up to 2^21 vertices.
+	bool removeDuplicates = vertexCount < (size_t(1) << 21);
+	std::unordered_set<uint64_t> emitted;
+
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		uint32_t a = clusters[vertexCluster[indices[t * 3]]].Representative;
+		uint32_t b = clusters[vertexCluster[indices[t * 3 + 1]]].Representative;
+		uint32_t c = clusters[vertexCluster[indices[t * 3 + 2]]].Representative;
+
+		if (a == b || b == c || a == c)
+			continue;
+
+		if (removeDuplicates)
+		{
+			uint32_t sorted[3] = { a, b, c };
+			std::sort(sorted, sorted + 3);
+			if (!emitted.insert((uint64_t(sorted[0]) << 42) | (uint64_t(sorted[1]) << 21) | sorted[2]).second)
+				continue;
+		}
+
+		simplifiedIndices.push_back(a);
+		simplifiedIndices.push_back(b);
+		simplifiedIndices.push_back(c);
+	}
+}
@@ -0,0 +1,20 @@
+#ifndef __MESHSIMPLIFIER_H__
+#define __MESHSIMPLIFIER_H__
+
+#include <MathGeoLib/include/Math/float3.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Mesh simplification for LOD generation. Vertex clustering snaps every vertex to a representative
+ * of its grid cell and drops the triangles that collapse, the result indexes the original vertices
+ * so all the LODs of a mesh share its vertex buffers.
+ */
+namespace MeshSimplifier
+{
+	// gridResolution is the number of cells along the longest side of the mesh bounds
+	void ClusterVertices(const float3* vertices, size_t vertexCount, const uint32_t* indices, size_t triangleCount,
+		unsigned gridResolution, std::vector<uint32_t>& simplifiedIndices);
+}
+
+#endif // __MESHSIMPLIFIER_H__
@@ -60,6 +60,12 @@ public:
 		return UPDATE_CONTINUE;
 	}
 
+	// Advances the simulation, between the pre updates and the updates. With pipelined frames it runs for the
+	// next frame on another thread during the post updates, which must not read what it writes. No GL here.
+	virtual void Simulate(float DeltaTime)
+	{
+	}
+
 	virtual bool CleanUp() 
 	{ 
 		return true; 
@@ -1,4 +1,91 @@
 ﻿#include "ModuleAnimation.h"
+#include "Engine.h"
+#include "GameObject.h"
+#include "TransformComponent.h"
+#include "AnimationCompression.h"
+#include "ModuleJobSystem.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+
+#define ANIMATION_BATCH_SIZE 16 // Instances evaluated by a single job
+
+size_t Animation::GetMemoryUsage() const
+{
+	size_t names = 0;
+	for (const std::string& name : ChannelNames)
+		names += name.capacity();
+
+	return sizeof(Animation) + names + ChannelNames.capacity() * sizeof(std::string) +
+		Tracks.capacity() * sizeof(AnimationTrack) + Keys.capacity() * sizeof(uint16_t);
+}
+
+void AnimationPose::Resize(size_t bones)
+{
+	Positions.resize(bones, float3::zero);
+	Rotations.resize(bones, Quat::identity);
+	Scales.resize(bones, float3::one);
+}
+
+namespace
+{
+	void CollectNodes(GameObject* root, std::unordered_map<std::string, GameObject*>& nodes)
+	{
+		std::queue<GameObject*> pending;
+		pending.push(root);
+		while (!pending.empty())
+		{
+			GameObject* node = pending.front();
+			pending.pop();
+
+			nodes.emplace(node->Name, node);
+			for (GameObject* child : node->GetChilds())
+				pending.push(child);
+		}
+	}
+
+	void AdvanceLayer(AnimationLayer& layer, float dt)
+	{
+		float duration = layer.Clip->Duration;
+
+		layer.Time += dt * layer.Speed;
+		if (layer.Loop && duration > 0.f)
+		{
+			layer.Time = fmodf(layer.Time, duration);
+			if (layer.Time < 0.f)
+				layer.Time += duration;
+		}
+		else
+			layer.Time = MIN(MAX(layer.Time, 0.f), duration);
+
+		if (layer.Weight < layer.TargetWeight)
+			layer.Weight = MIN(layer.Weight + layer.FadeSpeed * dt, layer.TargetWeight);
+		else if (layer.Weight > layer.TargetWeight)
+			layer.Weight = MAX(layer.Weight - layer.FadeSpeed * dt, layer.TargetWeight);
+	}
+
+	// Rotations are accumulated as plain 4D vectors on the same hemisphere and normalised afterwards
+	void AccumulateRotation(Quat& accumulated, const Quat& rotation, float weight)
+	{
+		float sign = accumulated.Dot(rotation) < 0.f ? -weight : weight;
+		accumulated.x += rotation.x * sign;
+		accumulated.y += rotation.y * sign;
+		accumulated.z += rotation.z * sign;
+		accumulated.w += rotation.w * sign;
+	}
+
+	Quat NormalisedOrIdentity(const Quat& rotation)
+	{
+		float lengthSq = rotation.Dot(rotation);
+		if (lengthSq <= 1e-12f)
+			return Quat::identity;
+
+		float inverseLength = 1.f / sqrtf(lengthSq);
+		return Quat(rotation.x * inverseLength, rotation.y * inverseLength, rotation.z * inverseLength, rotation.w * inverseLength);
+	}
+}
 
 ModuleAnimation::ModuleAnimation(bool start_enabled) : Module(start_enabled)
 {
@@ -8,15 +95,51 @@ ModuleAnimation::~ModuleAnimation()
 {
 }
 
+bool ModuleAnimation::Start()
+{
+	_jobSystem = App->GetModule<ModuleJobSystem>();
+	return true;
+}
+
+void ModuleAnimation::Simulate(float DeltaTime)
+{
+	// Animated transforms are restored from their backup when play stops, so only advance while playing
+	if (App->GetUpdateState() != Engine::UpdateState::Playing || _instances.empty())
+		return;
+
+	Evaluate(DeltaTime);
+}
+
+void ModuleAnimation::Evaluate(float dt, bool useJobs)
+{
+	if (useJobs)
+	{
+		// Instances only touch their own pose while evaluating, the scene graph is written once all are done
+		unsigned batches = unsigned((_instances.size() + ANIMATION_BATCH_SIZE - 1) / ANIMATION_BATCH_SIZE);
+		_jobSystem->ParallelFor(batches, [this, dt](unsigned batch)
+		{
+			size_t end = MIN(size_t(batch + 1) * ANIMATION_BATCH_SIZE, _instances.size());
+			for (size_t i = size_t(batch) * ANIMATION_BATCH_SIZE; i < end; ++i)
+				evaluate(_instances[i], dt);
+		});
+	}
+	else
+	{
+		for (AnimationInstance& instance : _instances)
+			evaluate(instance, dt);
+	}
+
+	for (const AnimationInstance& instance : _instances)
+		writeBack(instance);
+}
+
 bool ModuleAnimation::CleanUp()
 {
-	AnimationsMap::iterator it = _animations.begin();
+	_instances.clear();
+	_jobSystem = nullptr;
+
 	for (auto element : _animations)
 	{
-		for (Channel* channel : element.second->Channels)
-		{
-			RELEASE(channel);
-		}
 		element.second.reset();
 	}
 
@@ -27,7 +150,299 @@ bool ModuleAnimation::CleanUp()
 
 std::shared_ptr<Animation> ModuleAnimation::CreateAnimation(const std::string& name)
 {
+	MEMORY_TAG_SCOPE(MemoryTag::Animation);
 	std::shared_ptr<Animation> animation = std::make_shared<Animation>();
 	_animations[name] = animation;
 	return animation;
 }
+
+std::shared_ptr<Animation> ModuleAnimation::GetAnimation(const std::string& name) const
+{
+	AnimationsMap::const_iterator it = _animations.find(name);
+	return it != _animations.end() ? it->second : nullptr;
+}
+
+std::vector<std::string> ModuleAnimation::GetAnimationNames() const
+{
+	std::vector<std::string> names;
+	names.reserve(_animations.size());
+	for (const auto& element : _animations)
+		names.push_back(element.first);
+	return names;
+}
+
+unsigned ModuleAnimation::Play(const std::string& name, GameObject* root, bool loop, float speed)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::Animation);
+
+	if (root == nullptr)
+	{
+		LOG("Cannot play animation %s without a root node", name.c_str());
+		return 0;
+	}
+
+	AnimationInstance instance;
+	instance.Id = _lastInstanceId + 1;
+	instance.Root = root;
+
+	if (!addLayer(instance, name, AnimationBlendMode::Override, 1.f, loop, speed))
+		return 0;
+
+	_instances.push_back(std::move(instance));
+	return ++_lastInstanceId;
+}
+
+bool ModuleAnimation::CrossFade(unsigned instance, const std::string& name, float duration, bool loop, float speed)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::Animation);
+
+	AnimationInstance* animationInstance = findInstance(instance);
+	if (animationInstance == nullptr || !addLayer(*animationInstance, name, AnimationBlendMode::Override, 0.f, loop, speed))
+		return false;
+
+	float fadeSpeed = duration > 0.f ? 1.f / duration : FLT_MAX;
+	for (AnimationLayer& layer : animationInstance->Layers)
+	{
+		if (layer.Mode != AnimationBlendMode::Override)
+			continue;
+
+		layer.TargetWeight = 0.f;
+		layer.FadeSpeed = fadeSpeed;
+	}
+
+	AnimationLayer& fadeIn = animationInstance->Layers.back();
+	fadeIn.TargetWeight = 1.f;
+	if (duration <= 0.f)
+		fadeIn.Weight = 1.f;
+
+	return true;
+}
+
+bool ModuleAnimation::AddAdditive(unsigned instance, const std::string& name, float weight, bool loop, float speed)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::Animation);
+
+	AnimationInstance* animationInstance = findInstance(instance);
+	return animationInstance != nullptr && addLayer(*animationInstance, name, AnimationBlendMode::Additive, weight, loop, speed);
+}
+
+void ModuleAnimation::Stop(unsigned instance)
+{
+	_instances.erase(std::remove_if(_instances.begin(), _instances.end(),
+		[instance](const AnimationInstance& animationInstance) { return animationInstance.Id == instance; }), _instances.end());
+}
+
+void ModuleAnimation::StopAll()
+{
+	_instances.clear();
+}
+
+bool ModuleAnimation::IsPlaying(unsigned instance) const
+{
+	return std::any_of(_instances.begin(), _instances.end(),
+		[instance](const AnimationInstance& animationInstance) { return animationInstance.Id == instance; });
+}
+
+unsigned ModuleAnimation::GetInstance(const GameObject* root) const
+{
+	for (const AnimationInstance& instance : _instances)
+	{
+		if (instance.Root == root)
+			return instance.Id;
+	}
+
+	return 0;
+}
+
+AnimationInstance* ModuleAnimation::findInstance(unsigned id)
+{
+	for (AnimationInstance& instance : _instances)
+	{
+		if (instance.Id == id)
+			return &instance;
+	}
+
+	return nullptr;
+}
+
+bool ModuleAnimation::addLayer(AnimationInstance& instance, const std::string& name, AnimationBlendMode mode, float weight, bool loop, float speed)
+{
+	std::shared_ptr<Animation> clip = GetAnimation(name);
+	if (clip == nullptr)
+	{
+		LOG("Cannot play animation %s", name.c_str());
+		return false;
+	}
+
+	// Index the hierarchy once instead of searching it for every channel
+	std::unordered_map<std::string, GameObject*> nodes;
+	CollectNodes(instance.Root, nodes);
+
+	AnimationLayer layer;
+	layer.Clip = clip;
+	layer.Mode = mode;
+	layer.Loop = loop;
+	layer.Speed = speed;
+	layer.Weight = weight;
+	layer.TargetWeight = weight;
+	layer.Cursors.resize(clip->GetChannelCount());
+	layer.ChannelBones.resize(clip->GetChannelCount(), -1);
+
+	unsigned bound = 0;
+	for (size_t i = 0; i < clip->GetChannelCount(); ++i)
+	{
+		layer.ChannelBones[i] = bindBone(instance, clip->ChannelNames[i], nodes);
+		if (layer.ChannelBones[i] >= 0)
+			++bound;
+	}
+
+	if (mode == AnimationBlendMode::Additive)
+	{
+		layer.Reference.Resize(clip->GetChannelCount());
+		for (size_t i = 0; i < clip->GetChannelCount(); ++i)
+		{
+			int bone = layer.ChannelBones[i];
+			if (bone < 0)
+				continue;
+
+			layer.Reference.Positions[i] = instance.BindPose.Positions[bone];
+			layer.Reference.Rotations[i] = instance.BindPose.Rotations[bone];
+			layer.Reference.Scales[i] = instance.BindPose.Scales[bone];
+
+			ChannelCursor cursor;
+			AnimationCompression::Sample(*clip, unsigned(i), 0.f, cursor, layer.Reference.Positions[i], layer.Reference.Rotations[i], layer.Reference.Scales[i]);
+		}
+	}
+
+	if (bound < clip->GetChannelCount())
+		LOG("Animation %s has %i of %i channels bound", name.c_str(), bound, int(clip->GetChannelCount()));
+
+	instance.Layers.push_back(std::move(layer));
+	return true;
+}
+
+int ModuleAnimation::bindBone(AnimationInstance& instance, const std::string& nodeName, const std::unordered_map<std::string, GameObject*>& nodes)
+{
+	auto bone = instance.BoneIndices.find(nodeName);
+	if (bone != instance.BoneIndices.end())
+		return bone->second;
+
+	auto node = nodes.find(nodeName);
+	if (node == nodes.end() || node->second->GetTransform() == nullptr)
+		return -1;
+
+	TransformComponent* transform = node->second->GetTransform();
+	int index = int(instance.Bones.size());
+	instance.Bones.push_back(transform);
+	instance.BoneIndices[nodeName] = index;
+
+	instance.BindPose.Positions.push_back(transform->Position);
+	instance.BindPose.Rotations.push_back(transform->Rotation);
+	instance.BindPose.Scales.push_back(transform->Scale);
+
+	instance.Pose.Resize(instance.Bones.size());
+	instance.OverrideWeights.resize(instance.Bones.size());
+
+	return index;
+}
+
+void ModuleAnimation::evaluate(AnimationInstance& instance, float dt) const
+{
+	for (AnimationLayer& layer : instance.Layers)
+		AdvanceLayer(layer, dt);
+
+	// Layers that finished fading out
+	instance.Layers.erase(std::remove_if(instance.Layers.begin(), instance.Layers.end(),
+		[](const AnimationLayer& layer) { return layer.Weight <= 0.f && layer.TargetWeight <= 0.f; }), instance.Layers.end());
+
+	AnimationPose& pose = instance.Pose;
+	const AnimationPose& bindPose = instance.BindPose;
+	size_t boneCount = instance.Bones.size();
+
+	for (size_t bone = 0; bone < boneCount; ++bone)
+	{
+		pose.Positions[bone] = float3::zero;
+		pose.Rotations[bone] = Quat(0.f, 0.f, 0.f, 0.f);
+		pose.Scales[bone] = float3::zero;
+		instance.OverrideWeights[bone] = 0.f;
+	}
+
+	for (AnimationLayer& layer : instance.Layers)
+	{
+		if (layer.Mode != AnimationBlendMode::Override || layer.Weight <= 0.f)
+			continue;
+
+		for (size_t channel = 0; channel < layer.ChannelBones.size(); ++channel)
+		{
+			int bone = layer.ChannelBones[channel];
+			if (bone < 0)
+				continue;
+
+			float3 position = bindPose.Positions[bone];
+			Quat rotation = bindPose.Rotations[bone];
+			float3 scale = bindPose.Scales[bone];
+			AnimationCompression::Sample(*layer.Clip, unsigned(channel), layer.Time, layer.Cursors[channel], position, rotation, scale);
+
+			pose.Positions[bone] += position * layer.Weight;
+			AccumulateRotation(pose.Rotations[bone], rotation, layer.Weight);
+			pose.Scales[bone] += scale * layer.Weight;
+			instance.OverrideWeights[bone] += layer.Weight;
+		}
+	}
+
+	for (size_t bone = 0; bone < boneCount; ++bone)
+	{
+		float weight = instance.OverrideWeights[bone];
+		if (weight < 1.f)
+		{
+			float bindWeight = 1.f - weight;
+			pose.Positions[bone] += bindPose.Positions[bone] * bindWeight;
+			AccumulateRotation(pose.Rotations[bone], bindPose.Rotations[bone], bindWeight);
+			pose.Scales[bone] += bindPose.Scales[bone] * bindWeight;
+		}
+		else
+		{
+			pose.Positions[bone] /= weight;
+			pose.Scales[bone] /= weight;
+		}
+
+		pose.Rotations[bone] = NormalisedOrIdentity(pose.Rotations[bone]);
+	}
+
+	for (AnimationLayer& layer : instance.Layers)
+	{
+		if (layer.Mode != AnimationBlendMode::Additive || layer.Weight <= 0.f)
+			continue;
+
+		for (size_t channel = 0; channel < layer.ChannelBones.size(); ++channel)
+		{
+			int bone = layer.ChannelBones[channel];
+			if (bone < 0)
+				continue;
+
+			float3 position = layer.Reference.Positions[channel];
+			Quat rotation = layer.Reference.Rotations[channel];
+			float3 scale = layer.Reference.Scales[channel];
+			AnimationCompression::Sample(*layer.Clip, unsigned(channel), layer.Time, layer.Cursors[channel], position, rotation, scale);
+
+			pose.Positions[bone] += (position - layer.Reference.Positions[channel]) * layer.Weight;
+			pose.Scales[bone] += (scale - layer.Reference.Scales[channel]) * layer.Weight;
+
+			Quat delta = layer.Reference.Rotations[channel].Conjugated() * rotation;
+			if (delta.w < 0.f)
+				delta = delta.Neg();
+			pose.Rotations[bone] = NormalisedOrIdentity(pose.Rotations[bone] * Quat::identity.Slerp(delta, layer.Weight));
+		}
+	}
+}
+
+void ModuleAnimation::writeBack(const AnimationInstance& instance) const
+{
+	for (size_t bone = 0; bone < instance.Bones.size(); ++bone)
+	{
+		TransformComponent* transform = instance.Bones[bone];
+		transform->Position = instance.Pose.Positions[bone];
+		transform->Rotation = instance.Pose.Rotations[bone];
+		transform->Scale = instance.Pose.Scales[bone];
+	}
+}
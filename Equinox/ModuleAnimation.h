@@ -3,19 +3,121 @@
 
 #include "Module.h"
 #include <map>
+#include <cstdint>
+#include <unordered_map>
 #include <MathGeoLib/include/Math/float3.h>
+#include <MathGeoLib/include/Math/Quat.h>
 
+class GameObject;
+class TransformComponent;
+
+// Keys as imported, sorted by time in seconds. Only kept until the clip is compressed.
 struct Channel
 {
 	std::string NodeName;
-	std::vector<float3*> Positions;
-	std::vector<Quat*> Rotations;
+
+	std::vector<float> PositionTimes;
+	std::vector<float3> Positions;
+
+	std::vector<float> RotationTimes;
+	std::vector<Quat> Rotations;
+
+	std::vector<float> ScaleTimes;
+	std::vector<float3> Scales;
+};
+
+enum class AnimationTrackType
+{
+	Position,
+	Rotation,
+	Scale,
+	Count
+};
+
+// Every key is 4 uint16 in Animation::Keys: the time quantised over the clip duration followed by
+// three components, positions and scales relative to the track bounds and rotations as smallest three
+struct AnimationTrack
+{
+	uint32_t FirstKey = 0;
+	uint32_t KeyCount = 0;
+	float3 Min = float3::zero;
+	float3 Extent = float3::zero;
 };
 
 struct Animation
 {
-	double Duration = 0.f;
-	std::vector<Channel*> Channels;
+	static const unsigned KEY_STRIDE = 4;
+
+	float Duration = 0.f; // Seconds
+	std::vector<std::string> ChannelNames;
+	std::vector<AnimationTrack> Tracks; // AnimationTrackType::Count tracks per channel
+	std::vector<uint16_t> Keys;
+
+	size_t GetChannelCount() const { return ChannelNames.size(); }
+
+	const AnimationTrack& GetTrack(size_t channel, AnimationTrackType type) const
+	{
+		return Tracks[channel * size_t(AnimationTrackType::Count) + size_t(type)];
+	}
+
+	size_t GetMemoryUsage() const;
+};
+
+// Last key used by each track of a channel, playback mostly moves forward so lookups start there
+struct ChannelCursor
+{
+	unsigned Position = 0;
+	unsigned Rotation = 0;
+	unsigned Scale = 0;
+};
+
+// Local transforms of the bones an instance animates, indexed by bone
+struct AnimationPose
+{
+	std::vector<float3> Positions;
+	std::vector<Quat> Rotations;
+	std::vector<float3> Scales;
+
+	void Resize(size_t bones);
+};
+
+enum class AnimationBlendMode
+{
+	Override, // Weighted average with the other override layers, the bind pose fills the missing weight
+	Additive  // Difference to the first frame of the clip, applied on top of the blended pose
+};
+
+struct AnimationLayer
+{
+	std::shared_ptr<Animation> Clip;
+	AnimationBlendMode Mode = AnimationBlendMode::Override;
+	float Time = 0.f;
+	float Speed = 1.f;
+	bool Loop = true;
+
+	float Weight = 1.f;
+	float TargetWeight = 1.f;
+	float FadeSpeed = 0.f; // Weight change per second towards TargetWeight
+
+	std::vector<int> ChannelBones; // Bone of every clip channel, -1 when the node is not in the hierarchy
+	std::vector<ChannelCursor> Cursors;
+	AnimationPose Reference; // Additive layers only, indexed by channel
+};
+
+struct AnimationInstance
+{
+	unsigned Id = 0;
+	GameObject* Root = nullptr;
+
+	std::vector<TransformComponent*> Bones;
+	std::unordered_map<std::string, int> BoneIndices;
+	AnimationPose BindPose;
+
+	std::vector<AnimationLayer> Layers;
+
+	// Evaluation output, written back to the bones once every instance is evaluated
+	AnimationPose Pose;
+	std::vector<float> OverrideWeights;
 };
 
 class ModuleAnimation : public Module
@@ -24,14 +126,50 @@ public:
 	ModuleAnimation(bool start_enabled = true);
 	~ModuleAnimation();
 
+	bool Start() override;
+	void Simulate(float DeltaTime) override;
+	bool CleanUp() override;
+
 	std::shared_ptr<Animation> CreateAnimation(const std::string& name);
+	std::shared_ptr<Animation> GetAnimation(const std::string& name) const;
+	std::vector<std::string> GetAnimationNames() const;
 
-	bool CleanUp() override;
+	// Binds the animation channels to the transforms of the nodes with the same name under root
+	// and returns the instance id, or 0 if the animation does not exist
+	unsigned Play(const std::string& name, GameObject* root, bool loop = true, float speed = 1.f);
+
+	// Fades the new clip in while every override layer playing fades out over the duration
+	bool CrossFade(unsigned instance, const std::string& name, float duration, bool loop = true, float speed = 1.f);
+	bool AddAdditive(unsigned instance, const std::string& name, float weight, bool loop = true, float speed = 1.f);
+
+	void Stop(unsigned instance);
+	void StopAll();
+	bool IsPlaying(unsigned instance) const;
+	// Id of the instance playing on root, 0 if there is none
+	unsigned GetInstance(const GameObject* root) const;
+
+	size_t GetInstanceCount() const { return _instances.size(); }
+
+	// Advances every instance by dt and writes the poses to the bones, Simulate calls it while playing.
+	// Without jobs the instances are evaluated one after another on the calling thread.
+	void Evaluate(float dt, bool useJobs = true);
 
 private:
 	typedef std::map<std::string, std::shared_ptr<Animation>> AnimationsMap;
 
+	AnimationInstance* findInstance(unsigned id);
+	bool addLayer(AnimationInstance& instance, const std::string& name, AnimationBlendMode mode, float weight, bool loop, float speed);
+	int bindBone(AnimationInstance& instance, const std::string& nodeName, const std::unordered_map<std::string, GameObject*>& nodes);
+
+	void evaluate(AnimationInstance& instance, float dt) const;
+	void writeBack(const AnimationInstance& instance) const;
+
 	AnimationsMap _animations;
+
+	unsigned _lastInstanceId = 0;
+	std::vector<AnimationInstance> _instances;
+
+	std::shared_ptr<class ModuleJobSystem> _jobSystem;
 };
 
-#endif // __MODULEANIMATION_H__
\ No newline at end of file
+#endif // __MODULEANIMATION_H__
@@ -4,7 +4,20 @@
 #include "ModuleRender.h"
 #include "ModuleCollision.h"
 #include "Entity.h"
+#include "ModuleLevelManager.h"
+#include "Level.h"
+#include "ColliderComponent.h"
+#include <MathGeoLib/include/Geometry/LineSegment.h>
 #include <SDL.h>
+#include <algorithm>
+
+namespace
+{
+	uint64_t ContactKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+	}
+}
 
 using namespace std;
 
@@ -20,47 +33,44 @@ bool ShouldColide[6][6] =
 
 ModuleCollision::ModuleCollision()
 {
+	// The table is read both ways so pairs do not depend on the order the sweep visits them in
+	for (int i = 0; i <= NONE; ++i)
+	{
+		_collisionMasks[i] = 0;
+		for (int j = 0; j <= NONE; ++j)
+		{
+			if (ShouldColide[i][j] || ShouldColide[j][i])
+				_collisionMasks[i] |= 1u << j;
+		}
+	}
 }
 
 // Destructor
 ModuleCollision::~ModuleCollision()
 {}
 
+bool ModuleCollision::Start()
+{
+	_levelManager = App->GetModule<ModuleLevelManager>();
+
+	return true;
+}
+
 update_status ModuleCollision::PreUpdate(float DeltaTime)
 {
-	// Remove all colliders scheduled for deletion
-	for (list<Collider*>::iterator it = colliders.begin(); it != colliders.end();)
-	{
-		if ((*it)->to_delete == true)
-		{
-			RELEASE(*it);
-			it = colliders.erase(it);
-		}
-		else
-			++it;
-	}
+	processRemovals();
 
 	return UPDATE_CONTINUE;
 }
 
 update_status ModuleCollision::Update(float DeltaTime)
 {
-	for (list<Collider*>::iterator it = colliders.begin(); it != colliders.end();)
-	{
-		Collider* col = *it;
-		for (list<Collider*>::iterator it2 = ++it; it2 != colliders.end(); ++it2)
-		{
-			Collider* other = *it2;
-			if (ShouldColide[col->type][other->type] && col->CheckCollision(other->rect))
-			{
-				if (col->attached)
-					col->attached->OnCollision(*col, *other);
-				if (other->attached)
-					other->attached->OnCollision(*other, *col);
-			}
-		}
-	}
-	// After making it work, review that you are doing the minumum checks possible
+	MEMORY_TAG_SCOPE(MemoryTag::Collision);
+
+	updateSweep();
+	findCandidatePairs();
+	updateContacts();
+	dispatchStayEvents();
 
 	if(App->GetModule<ModuleInput>()->GetKey(SDL_SCANCODE_F1) == KEY_DOWN)
 		debug = !debug;
@@ -73,12 +83,12 @@ update_status ModuleCollision::Update(float DeltaTime)
 
 void ModuleCollision::DebugDraw()
 {
-	for (list<Collider*>::iterator it = colliders.begin(); it != colliders.end(); ++it)
+	for (const Collider& collider : _colliders)
 	{
 		SDL_Color color = { 255, 0, 0, 0 };
-		if ((*it)->type == PLAYER_ATTACK)
+		if (collider.type == PLAYER_ATTACK)
 			color.g = 255;
-		//App->renderer->DrawQuad((*it)->rect, color.r, color.g, color.b, 80);
+		//App->renderer->DrawQuad(collider.rect, color.r, color.g, color.b, 80);
 		//we will move all the module to be compatible with OpenGL
 	}
 }
@@ -88,22 +98,345 @@ bool ModuleCollision::CleanUp()
 {
 	LOG("Freeing all colliders");
 
-	for (list<Collider*>::iterator it = colliders.begin(); it != colliders.end(); ++it)
-		RELEASE(*it);
+	_levelManager = nullptr;
+	_queryObjects.clear();
+	_queryColliders.clear();
 
-	colliders.clear();
+	_colliders.clear();
+	_denseToSlot.clear();
+	_slots.clear();
+	_freeSlots.clear();
+	_pendingRemovals.clear();
+	_sweep.clear();
+	_candidatePairs.clear();
+	_contacts.clear();
+	_currentContacts.clear();
+	_stayContacts.clear();
+	_stayBatch.clear();
 
 	return true;
 }
 
-Collider* ModuleCollision::AddCollider(const iRectangle3& rect, Entity* attached)
+ColliderHandle ModuleCollision::AddCollider(const iRectangle3& rect, Entity* attached)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::Collision);
+
+	uint32_t slotIndex;
+	if (!_freeSlots.empty())
+	{
+		slotIndex = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		slotIndex = uint32_t(_slots.size());
+		_slots.emplace_back();
+	}
+
+	ColliderSlot& slot = _slots[slotIndex];
+	slot.Dense = uint32_t(_colliders.size());
+	slot.Alive = true;
+
+	ColliderHandle handle;
+	handle.Index = slotIndex;
+	handle.Generation = slot.Generation;
+
+	_colliders.emplace_back(rect);
+	_denseToSlot.push_back(slotIndex);
+
+	Collider& collider = _colliders.back();
+	collider.attached = attached;
+	collider.handle = handle;
+
+	_sweep.push_back({ rect.Position.x, rect.Position.x + rect.w, handle });
+
+	return handle;
+}
+
+void ModuleCollision::RemoveCollider(ColliderHandle handle)
+{
+	if (!isAlive(handle))
+		return;
+
+	// Whoever removes the collider may be going away, so it gets no more callbacks
+	colliderAt(handle.Index).attached = nullptr;
+	_pendingRemovals.push_back(handle);
+}
+
+Collider* ModuleCollision::GetCollider(ColliderHandle handle)
+{
+	return isAlive(handle) ? &colliderAt(handle.Index) : nullptr;
+}
+
+bool ModuleCollision::isAlive(ColliderHandle handle) const
+{
+	return handle.Index < _slots.size() && _slots[handle.Index].Alive && _slots[handle.Index].Generation == handle.Generation;
+}
+
+void ModuleCollision::processRemovals()
+{
+	if (_pendingRemovals.empty())
+		return;
+
+	// Exit callbacks may remove more colliders, those wait for the next frame
+	std::vector<ColliderHandle> removals;
+	removals.swap(_pendingRemovals);
+
+	for (ColliderHandle& handle : removals)
+	{
+		if (isAlive(handle))
+			_slots[handle.Index].Alive = false;
+		else
+			handle.Index = ColliderHandle::INVALID_INDEX; // Removed twice
+	}
+
+	// Surviving partners of removed colliders leave their contacts now, while both are still stored
+	size_t kept = 0;
+	for (uint64_t key : _contacts)
+	{
+		uint32_t a = uint32_t(key >> 32);
+		uint32_t b = uint32_t(key);
+		if (_slots[a].Alive && _slots[b].Alive)
+		{
+			_contacts[kept++] = key;
+			continue;
+		}
+
+		if (Entity* entity = colliderAt(a).attached)
+			entity->OnCollisionExit(colliderAt(a), colliderAt(b));
+		if (Entity* entity = colliderAt(b).attached)
+			entity->OnCollisionExit(colliderAt(b), colliderAt(a));
+	}
+	_contacts.resize(kept);
+
+	// Swap with the last collider so removal is O(1) and the array stays dense
+	for (ColliderHandle handle : removals)
+	{
+		if (handle.Index == ColliderHandle::INVALID_INDEX)
+			continue;
+
+		ColliderSlot& slot = _slots[handle.Index];
+		uint32_t last = uint32_t(_colliders.size() - 1);
+		if (slot.Dense != last)
+		{
+			_colliders[slot.Dense] = _colliders[last];
+			_denseToSlot[slot.Dense] = _denseToSlot[last];
+			_slots[_denseToSlot[slot.Dense]].Dense = slot.Dense;
+		}
+
+		_colliders.pop_back();
+		_denseToSlot.pop_back();
+
+		++slot.Generation;
+		_freeSlots.push_back(handle.Index);
+	}
+}
+
+void ModuleCollision::updateSweep()
+{
+	// Entries of removed colliders are dropped in the same pass that refreshes the extents
+	size_t kept = 0;
+	for (const SweepEntry& entry : _sweep)
+	{
+		if (!isAlive(entry.Handle))
+			continue;
+
+		const iRectangle3& rect = colliderAt(entry.Handle.Index).rect;
+		_sweep[kept++] = { rect.Position.x, rect.Position.x + rect.w, entry.Handle };
+	}
+	_sweep.resize(kept);
+
+	// Colliders barely move between frames, so the array is almost sorted and insertion sort stays close to linear
+	for (size_t i = 1; i < _sweep.size(); ++i)
+	{
+		SweepEntry entry = _sweep[i];
+		size_t j = i;
+		for (; j > 0 && _sweep[j - 1].MinX > entry.MinX; --j)
+			_sweep[j] = _sweep[j - 1];
+
+		_sweep[j] = entry;
+	}
+}
+
+void ModuleCollision::findCandidatePairs()
+{
+	_candidatePairs.clear();
+
+	for (size_t i = 0; i < _sweep.size(); ++i)
+	{
+		const SweepEntry& entry = _sweep[i];
+		unsigned mask = _collisionMasks[colliderAt(entry.Handle.Index).type];
+		if (mask == 0)
+			continue;
+
+		// Only colliders starting before this one ends can overlap it on the sweep axis
+		for (size_t j = i + 1; j < _sweep.size() && _sweep[j].MinX <= entry.MaxX; ++j)
+		{
+			uint32_t other = _sweep[j].Handle.Index;
+			if (mask & (1u << colliderAt(other).type))
+				_candidatePairs.push_back(std::make_pair(entry.Handle.Index, other));
+		}
+	}
+}
+
+void ModuleCollision::updateContacts()
+{
+	_currentContacts.clear();
+	for (const std::pair<uint32_t, uint32_t>& pair : _candidatePairs)
+	{
+		if (colliderAt(pair.first).CheckCollision(colliderAt(pair.second).rect))
+			_currentContacts.push_back(ContactKey(pair.first, pair.second));
+	}
+
+	std::sort(_currentContacts.begin(), _currentContacts.end());
+
+	// Callbacks may add colliders and move the array, so colliders are looked up again for every call
+	auto notify = [this](uint32_t origin, uint32_t other, bool enter)
+	{
+		if (Entity* entity = colliderAt(origin).attached)
+		{
+			if (enter)
+				entity->OnCollisionEnter(colliderAt(origin), colliderAt(other));
+			else
+				entity->OnCollisionExit(colliderAt(origin), colliderAt(other));
+		}
+	};
+
+	// Both lists are sorted, one merge tells new, ongoing and finished contacts apart
+	_stayContacts.clear();
+	size_t current = 0, previous = 0;
+	while (current < _currentContacts.size() || previous < _contacts.size())
+	{
+		bool fromCurrent = previous == _contacts.size() || (current < _currentContacts.size() && _currentContacts[current] <= _contacts[previous]);
+		bool fromPrevious = current == _currentContacts.size() || (previous < _contacts.size() && _contacts[previous] <= _currentContacts[current]);
+
+		uint64_t key = fromCurrent ? _currentContacts[current] : _contacts[previous];
+		uint32_t a = uint32_t(key >> 32);
+		uint32_t b = uint32_t(key);
+
+		if (fromCurrent && fromPrevious)
+		{
+			_stayContacts.push_back(std::make_pair(a, b));
+			_stayContacts.push_back(std::make_pair(b, a));
+		}
+		else
+		{
+			notify(a, b, fromCurrent);
+			notify(b, a, fromCurrent);
+		}
+
+		if (fromCurrent)
+			++current;
+		if (fromPrevious)
+			++previous;
+	}
+
+	_contacts.swap(_currentContacts);
+}
+
+void ModuleCollision::dispatchStayEvents()
+{
+	std::sort(_stayContacts.begin(), _stayContacts.end());
+
+	// One call per collider with every contact it still has
+	for (size_t begin = 0; begin < _stayContacts.size();)
+	{
+		uint32_t origin = _stayContacts[begin].first;
+		size_t end = begin;
+		while (end < _stayContacts.size() && _stayContacts[end].first == origin)
+			++end;
+
+		if (Entity* entity = colliderAt(origin).attached)
+		{
+			_stayBatch.clear();
+			for (size_t i = begin; i < end; ++i)
+				_stayBatch.push_back(&colliderAt(_stayContacts[i].second));
+
+			entity->OnCollisionStay(colliderAt(origin), _stayBatch);
+		}
+
+		begin = end;
+	}
+}
+
+template<typename TYPE>
+void ModuleCollision::collectColliders(const TYPE& primitive, std::vector<ColliderComponent*>& colliders) const
+{
+	_queryObjects.clear();
+	_levelManager->GetCurrentLevel().GetQuadtree().CollectUniqueIntersections(_queryObjects, primitive);
+
+	for (GameObject* gameObject : _queryObjects)
+	{
+		ColliderComponent* collider = gameObject->GetCollider();
+		if (collider != nullptr && collider->Enabled && gameObject->Enabled)
+			colliders.push_back(collider);
+	}
+}
+
+bool ModuleCollision::Overlap(const AABB& box, std::vector<ColliderComponent*>& colliders) const
+{
+	size_t previousSize = colliders.size();
+	collectColliders(box, colliders);
+
+	return colliders.size() > previousSize;
+}
+
+bool ModuleCollision::Raycast(const Ray& ray, float maxDistance, ColliderHit& hit) const
+{
+	_queryColliders.clear();
+	collectColliders(LineSegment(ray, maxDistance), _queryColliders);
+
+	hit.Collider = nullptr;
+	hit.Distance = maxDistance;
+
+	for (ColliderComponent* collider : _queryColliders)
+	{
+		float dNear, dFar;
+		if (collider->GetWorldBounds().Intersects(ray, dNear, dFar) && dNear <= hit.Distance)
+		{
+			hit.Collider = collider;
+			hit.Distance = MAX(dNear, 0.f);
+		}
+	}
+
+	if (hit.Collider != nullptr)
+		hit.Point = ray.GetPoint(hit.Distance);
+
+	return hit.Collider != nullptr;
+}
+
+bool ModuleCollision::Sweep(const AABB& box, const float3& direction, float distance, ColliderHit& hit) const
 {
-	Collider* ret = new Collider(rect);
-	ret->attached = attached;
+	AABB swept = box;
+	swept.Enclose(AABB(box.minPoint + direction * distance, box.maxPoint + direction * distance));
+
+	_queryColliders.clear();
+	collectColliders(swept, _queryColliders);
+
+	hit.Collider = nullptr;
+	hit.Distance = distance;
+
+	// Growing every target by the half size of the box turns the sweep into a raycast from its center
+	float3 halfSize = box.HalfSize();
+	Ray ray(box.CenterPoint(), direction);
+
+	for (ColliderComponent* collider : _queryColliders)
+	{
+		const AABB& bounds = collider->GetWorldBounds();
+		AABB expanded(bounds.minPoint - halfSize, bounds.maxPoint + halfSize);
+
+		float dNear, dFar;
+		if (expanded.Intersects(ray, dNear, dFar) && dNear <= hit.Distance && dFar >= 0.f)
+		{
+			hit.Collider = collider;
+			hit.Distance = MAX(dNear, 0.f);
+		}
+	}
 
-	colliders.push_back(ret);
+	if (hit.Collider != nullptr)
+		hit.Point = hit.Collider->GetWorldBounds().ClosestPoint(ray.GetPoint(hit.Distance));
 
-	return ret;
+	return hit.Collider != nullptr;
 }
 
 // -----------------------------------------------------
@@ -1,11 +1,15 @@
 #ifndef __ModuleCollision_H__
 #define __ModuleCollision_H__
 
-#include <list>
+#include <vector>
+#include <cstdint>
 #include "Module.h"
 #include "Notifiable.h"
 #include "ModuleRender.h"
 #include "Rectangle3.h"
+#include "ResourcePool.h"
+#include <MathGeoLib/include/Geometry/AABB.h>
+#include <MathGeoLib/include/Geometry/Ray.h>
 
 enum CollisionType
 {
@@ -22,12 +26,15 @@ extern bool ShouldColide[6][6];
 // enemy shots will collide with other enemies ? and against walls ?
 
 class Entity;
+struct Collider;
+
+typedef ResourceHandle<Collider> ColliderHandle;
 
 struct Collider
 {
 	iRectangle3 rect = iRectangle3(0, 0, 0, 0, 0);
-	bool to_delete = false;
 	CollisionType type = NONE;
+	ColliderHandle handle;
 
 	Entity* attached = nullptr;
 
@@ -45,6 +52,17 @@ struct Collider
 	bool CheckCollision(const iRectangle3& r) const;
 };
 
+class GameObject;
+class ColliderComponent;
+class ModuleLevelManager;
+
+struct ColliderHit
+{
+	ColliderComponent* Collider = nullptr;
+	float Distance = 0.f;
+	float3 Point = float3::zero;
+};
+
 class ModuleCollision : public Module
 {
 public:
@@ -52,18 +70,79 @@ public:
 	ModuleCollision();
 	~ModuleCollision();
 
+	bool Start() override;
 	update_status PreUpdate(float DeltaTime);
 	update_status Update(float DeltaTime);
 
 	bool CleanUp();
 
-	Collider* AddCollider(const iRectangle3& rect, Entity* attached);
+	ColliderHandle AddCollider(const iRectangle3& rect, Entity* attached);
+	// The collider stays alive until the next PreUpdate, where it gets its exit events
+	void RemoveCollider(ColliderHandle handle);
+
+	// Colliders live in a dense array that moves when colliders are added, do not keep the pointer
+	Collider* GetCollider(ColliderHandle handle);
+	size_t GetColliderCount() const { return _colliders.size(); }
+
 	void DebugDraw();
 
+	// GameObject collider queries, they run against the quadtree of the current level
+	bool Overlap(const AABB& box, std::vector<ColliderComponent*>& colliders) const;
+	bool Raycast(const Ray& ray, float maxDistance, ColliderHit& hit) const;
+	// Moves box along direction (normalized) and reports the first collider it touches
+	bool Sweep(const AABB& box, const float3& direction, float distance, ColliderHit& hit) const;
+
 private:
+	// Maps a handle to the collider position in the dense array
+	struct ColliderSlot
+	{
+		uint32_t Dense = 0;
+		uint32_t Generation = 0;
+		bool Alive = false;
+	};
+
+	// Collider extent on the sweep axis, kept sorted by MinX between frames
+	struct SweepEntry
+	{
+		int MinX;
+		int MaxX;
+		ColliderHandle Handle;
+	};
+
+	bool isAlive(ColliderHandle handle) const;
+	Collider& colliderAt(uint32_t slot) { return _colliders[_slots[slot].Dense]; }
+
+	void processRemovals();
+	void updateSweep();
+	void findCandidatePairs();
+	void updateContacts();
+	void dispatchStayEvents();
+
+	template<typename TYPE>
+	void collectColliders(const TYPE& primitive, std::vector<ColliderComponent*>& colliders) const;
 
-	std::list<Collider*> colliders;
 	bool debug = false;
+
+	std::shared_ptr<ModuleLevelManager> _levelManager;
+	mutable std::vector<GameObject*> _queryObjects;
+	mutable std::vector<ColliderComponent*> _queryColliders;
+
+	std::vector<Collider> _colliders;
+	std::vector<uint32_t> _denseToSlot;
+	std::vector<ColliderSlot> _slots;
+	std::vector<uint32_t> _freeSlots;
+	std::vector<ColliderHandle> _pendingRemovals;
+
+	// Bit j of _collisionMasks[i] is set when types i and j collide
+	unsigned _collisionMasks[NONE + 1];
+	std::vector<SweepEntry> _sweep;
+	std::vector<std::pair<uint32_t, uint32_t>> _candidatePairs;
+
+	// Overlapping slot pairs packed as (low << 32 | high), sorted so frames can be diffed with a merge
+	std::vector<uint64_t> _contacts;
+	std::vector<uint64_t> _currentContacts;
+	std::vector<std::pair<uint32_t, uint32_t>> _stayContacts;
+	std::vector<Collider*> _stayBatch;
 };
 
 #endif // __ModuleCollision_H__
\ No newline at end of file
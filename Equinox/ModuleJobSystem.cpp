@@ -0,0 +1,123 @@
+#include "ModuleJobSystem.h"
+#include "Engine.h"
+#include "ModuleSettings.h"
+
+namespace
+{
+	thread_local bool insideJob = false;
+}
+
+ModuleJobSystem::ModuleJobSystem(bool start_enabled) : Module(start_enabled), _nextJob(0), _finishedJobs(0)
+{
+}
+
+ModuleJobSystem::~ModuleJobSystem()
+{
+}
+
+bool ModuleJobSystem::Start()
+{
+	int workerCount = App->GetModule<ModuleSettings>()->WorkerThreads;
+	if (workerCount <= 0)
+		workerCount = MAX(int(std::thread::hardware_concurrency()) - 1, 0); // The main thread works too
+
+	_exit = false;
+	for (int i = 0; i < workerCount; ++i)
+		_workers.emplace_back(&ModuleJobSystem::workerLoop, this);
+
+	LOG("Job system started with %i worker threads", workerCount);
+
+	return true;
+}
+
+bool ModuleJobSystem::CleanUp()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_exit = true;
+	}
+	_wakeWorkers.notify_all();
+
+	for (std::thread& worker : _workers)
+		worker.join();
+	_workers.clear();
+
+	return true;
+}
+
+void ModuleJobSystem::ParallelFor(unsigned count, const std::function<void(unsigned)>& job)
+{
+	if (count == 0)
+		return;
+
+	// Inline jobs already run under the caller's tag
+	if (insideJob || _workers.empty() || count == 1)
+	{
+		for (unsigned i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		_jobTag = MemoryTracker::GetCurrentTag();
+		_jobCount = count;
+		_nextJob = 0;
+		_finishedJobs = 0;
+		++_batch;
+	}
+	_wakeWorkers.notify_all();
+
+	runJobs();
+
+	// Workers still leaving runJobs would otherwise take indices from the next batch
+	std::unique_lock<std::mutex> lock(_mutex);
+	_batchFinished.wait(lock, [this, count]() { return _finishedJobs == count && _activeWorkers == 0; });
+	_job = nullptr;
+}
+
+void ModuleJobSystem::workerLoop()
+{
+	insideJob = true;
+
+	unsigned lastBatch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wakeWorkers.wait(lock, [this, lastBatch]() { return _exit || (_job != nullptr && _batch != lastBatch); });
+
+			if (_exit)
+				return;
+
+			lastBatch = _batch;
+			++_activeWorkers;
+		}
+
+		runJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			--_activeWorkers;
+		}
+		_batchFinished.notify_one();
+	}
+}
+
+void ModuleJobSystem::runJobs()
+{
+	bool wasInsideJob = insideJob;
+	insideJob = true;
+
+	MEMORY_TAG_SCOPE(_jobTag);
+
+	unsigned index;
+	while ((index = _nextJob++) < _jobCount)
+	{
+		(*_job)(index);
+		++_finishedJobs;
+	}
+
+	insideJob = wasInsideJob;
+}
@@ -0,0 +1,52 @@
+#ifndef __MODULEJOBSYSTEM_H__
+#define __MODULEJOBSYSTEM_H__
+
+#include "Module.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed pool of worker threads for data parallel work. ParallelFor blocks until every index has
+ * been processed and the calling thread takes jobs too, so it never idles while the workers run.
+ */
+class ModuleJobSystem : public Module
+{
+public:
+	ModuleJobSystem(bool start_enabled = true);
+	~ModuleJobSystem();
+
+	bool Start() override;
+	bool CleanUp() override;
+
+	// Runs job(index) for every index in [0, count). Nested calls from a job run inline. Only one thread
+	// outside the pool calls it at a time: the main thread, or the frame pipeline while the main thread submits.
+	void ParallelFor(unsigned count, const std::function<void(unsigned)>& job);
+
+	unsigned GetWorkerCount() const { return unsigned(_workers.size()); }
+
+private:
+	void workerLoop();
+	void runJobs();
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _wakeWorkers;
+	std::condition_variable _batchFinished;
+
+	const std::function<void(unsigned)>* _job = nullptr;
+	MemoryTag _jobTag = MemoryTag::General; // Tag of the caller, so job allocations are charged to it
+	unsigned _jobCount = 0;
+	unsigned _activeWorkers = 0;
+	unsigned _batch = 0;
+	std::atomic<unsigned> _nextJob;
+	std::atomic<unsigned> _finishedJobs;
+	bool _exit = false;
+};
+
+#endif // __MODULEJOBSYSTEM_H__
@@ -3,6 +3,9 @@
 #include "ModuleAnimation.h"
 #include "TransformComponent.h"
 #include "ModuleLevelManager.h"
+#include "ModuleMeshManager.h"
+#include "ModuleMaterialManager.h"
+#include "ModuleTextures.h"
 
 ModuleLevelManager::ModuleLevelManager()
 {
@@ -32,6 +35,11 @@ update_status ModuleLevelManager::PreUpdate(float DeltaTime)
 	return UPDATE_CONTINUE;
 }
 
+void ModuleLevelManager::Simulate(float DeltaTime)
+{
+	_currentLevel->Simulate(DeltaTime);
+}
+
 update_status ModuleLevelManager::Update(float DeltaTime)
 {
 	_currentLevel->Update(DeltaTime);
@@ -55,10 +63,18 @@ bool ModuleLevelManager::CleanUp()
 
 void ModuleLevelManager::ChangeLevel(const std::shared_ptr<Level> level)
 {
+	// Animation instances point to transforms of the old level
+	App->GetModule<ModuleAnimation>()->StopAll();
+
 	_currentLevel->CleanUp();
 	_currentLevel.reset();
 
 	_currentLevel = level;
+
+	// Resources are released in dependency order: meshes reference materials and materials reference textures
+	App->GetModule<ModuleMeshManager>()->ReleaseUnused();
+	App->GetModule<ModuleMaterialManager>()->ReleaseUnused();
+	App->GetModule<ModuleTextures>()->ReleaseUnused();
 }
 
 Level& ModuleLevelManager::GetCurrentLevel()
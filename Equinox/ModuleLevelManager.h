@@ -13,6 +13,7 @@ public:
 	bool Init() override;
 	bool Start() override;
 	update_status PreUpdate(float DeltaTime) override;
+	void Simulate(float DeltaTime) override;
 	update_status Update(float DeltaTime) override;
 	update_status PostUpdate(float DeltaTime) override;
 	bool CleanUp() override;
@@ -49,7 +49,8 @@ update_status ModuleLighting::PreUpdate(float DeltaTime)
 update_status ModuleLighting::Update(float DeltaTime)
 {
 	//TODO: it will be nice to add something similar to a gizmod to "see" the light source object in the editor.
-	glEnable(GL_LIGHTING);	
+	RenderDevice* device = RenderDevice::Current();
+	device->SetState(RenderState::Lighting, true);
 
 	if(!EnableAmbientLight)
 	{
@@ -57,32 +58,25 @@ update_status ModuleLighting::Update(float DeltaTime)
 		memcpy(AmbientLight, default_point, sizeof(GLfloat) * 4);
 	}
 	
-	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, AmbientLight);
+	device->SetAmbientLight(AmbientLight);
 
 	for (Light* light : Lights)
 	{
 		if(light->IsEnabled)
 		{
-			glEnable(light->Number);
+			device->SetLightEnabled(light->Number - GL_LIGHT0, true);
 
 			DrawGizmo(light);
-						
-			glLightfv(light->Number, GL_AMBIENT, light->Ambient);
-			glLightfv(light->Number, GL_DIFFUSE, light->Diffuse);
-			glLightfv(light->Number, GL_SPECULAR, light->Specular);
 
-			glLightfv(light->Number, GL_POSITION, light->Position);
-
-			glLightf(light->Number, GL_SPOT_CUTOFF, light->CutOff);
-			glLightfv(light->Number, GL_SPOT_DIRECTION, light->Direction);
+			device->SetLight(light->Number - GL_LIGHT0, light->Ambient, light->Diffuse, light->Specular, light->Position, light->CutOff, light->Direction);
 
 		}
 		else
 		{
-			glDisable(light->Number);
+			device->SetLightEnabled(light->Number - GL_LIGHT0, false);
 		}
 	}
-	glDisable(GL_LIGHTING);
+	device->SetState(RenderState::Lighting, false);
 
 	return UPDATE_CONTINUE;
 }
@@ -160,29 +154,16 @@ int ModuleLighting::GetLabelByType(LightType type)
 
 void ModuleLighting::DrawGizmo(Light* light)
 {
-	glPushMatrix();
+	RenderDevice* device = RenderDevice::Current();
+
 	//Draw Axis
-	glLineWidth(2.0);
-	glBegin(GL_LINES);
-	GLfloat XP[3]{ 0,0,0 };
-	GLfloat YP[3]{ 0,0,0 };
-	GLfloat ZP[3]{ 0,0,0 };
-
-	XP[0] = light->Position[0] + 1;
-	XP[1] = light->Position[1];
-	XP[2] = light->Position[2];
-
-	YP[0] = light->Position[0];
-	YP[1] = light->Position[1] + 1;
-	YP[2] = light->Position[2];
-
-	ZP[0] = light->Position[0];
-	ZP[1] = light->Position[1];
-	ZP[2] = light->Position[2] + 1;
-
-	glColor3f(1, 0, 0);  glVertex3fv(light->Position);  glVertex3fv(XP);    // X red axis
-	glColor3f(0, 1, 0);  glVertex3fv(light->Position);  glVertex3fv(YP);    // Y green axis
-	glColor3f(0, 0, 1);  glVertex3fv(light->Position);  glVertex3fv(ZP);    // z blue axis
-	glEnd();
-	glPopMatrix();
+	device->SetLineWidth(2.0);
+	float3 position(light->Position[0], light->Position[1], light->Position[2]);
+	float3 XP[2] = { position, position + float3(1, 0, 0) };
+	float3 YP[2] = { position, position + float3(0, 1, 0) };
+	float3 ZP[2] = { position, position + float3(0, 0, 1) };
+
+	device->SetColor(float4(1, 0, 0, 1));  device->DrawVertices(PrimitiveType::Lines, XP, 2);    // X red axis
+	device->SetColor(float4(0, 1, 0, 1));  device->DrawVertices(PrimitiveType::Lines, YP, 2);    // Y green axis
+	device->SetColor(float4(0, 0, 1, 1));  device->DrawVertices(PrimitiveType::Lines, ZP, 2);    // z blue axis
 }
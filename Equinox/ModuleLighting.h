@@ -3,7 +3,6 @@
 
 #include "Module.h"
 #include "GL/glew.h"
-#include <gl/GL.h>
 #include <string>
 
 enum LightType
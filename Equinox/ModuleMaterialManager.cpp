@@ -1,5 +1,7 @@
 #include "ModuleMaterialManager.h"
 #include "MaterialComponent.h"
+#include "ModuleTextures.h"
+#include "Engine.h"
 
 
 ModuleMaterialManager::ModuleMaterialManager()
@@ -14,33 +16,48 @@ ModuleMaterialManager::~ModuleMaterialManager()
 bool ModuleMaterialManager::CleanUp()
 {
 	LOG("Cleaning materials and MaterialManager");
-	LOG("%i materials were loaded", _materialContainer.size());
+	LOG("%i materials were loaded", _materialPool.Size());
 
-	for (auto materialPair : _materialContainer)
+	_materialPool.Clear([this](MaterialHandle, Material& material)
 	{
-		RELEASE(materialPair.second);
-	}
+		destroy(material);
+	});
 
-	_materialContainer.clear();
 	return true;
 }
 
-Material* ModuleMaterialManager::CreateMaterial()
+MaterialHandle ModuleMaterialManager::CreateMaterial()
 {
-	Material* mat = new Material;
-	mat->id = _lastId++;
-	_materialContainer[mat->id] = mat;
-	return mat;
+	return _materialPool.Create();
 }
 
-Material* ModuleMaterialManager::GetMaterial(int material)
+Material* ModuleMaterialManager::GetMaterial(MaterialHandle handle)
 {
-	const auto it = _materialContainer.find(material);
-	
-	if (it == _materialContainer.end())
+	return _materialPool.Get(handle);
+}
+
+void ModuleMaterialManager::AddRef(MaterialHandle handle)
+{
+	_materialPool.AddRef(handle);
+}
+
+void ModuleMaterialManager::Release(MaterialHandle handle)
+{
+	_materialPool.Release(handle);
+}
+
+size_t ModuleMaterialManager::ReleaseUnused()
+{
+	size_t released = _materialPool.ReleaseUnused([this](MaterialHandle, Material& material)
 	{
-		return nullptr;
-	}
+		destroy(material);
+	});
 
-	return it->second;
+	LOG("%i unused materials were freed", released);
+	return released;
+}
+
+void ModuleMaterialManager::destroy(Material& material)
+{
+	App->GetModule<ModuleTextures>()->Release(material.texture);
 }
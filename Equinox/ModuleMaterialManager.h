@@ -1,8 +1,6 @@
 #pragma once
 #include "Module.h"
-#include <unordered_map>
-
-struct Material;
+#include "ResourcePool.h"
 
 class ModuleMaterialManager :
 	public Module
@@ -13,12 +11,18 @@ public:
 
 	bool CleanUp() override;
 
-	Material* CreateMaterial();
-	Material* GetMaterial(int material);
+	MaterialHandle CreateMaterial();
+	Material* GetMaterial(MaterialHandle handle);
+
+	void AddRef(MaterialHandle handle);
+	void Release(MaterialHandle handle);
+
+	// Frees every material without references, returns the number of materials freed
+	size_t ReleaseUnused();
 
 private:
-	int _lastId = 0;
+	void destroy(Material& material);
 
-	std::unordered_map<int, Material*> _materialContainer;
+	ResourcePool<Material> _materialPool;
 };
 
@@ -1,10 +1,16 @@
 #include "ModuleMeshManager.h"
+#include "ModuleMaterialManager.h"
 #include "MeshComponent.h"
+#include "Engine.h"
+#include "ModuleRender.h"
+#include "RenderDevice.h"
 
 #include <cassert>
 
 ModuleMeshManager::ModuleMeshManager()
 {
+	for (std::atomic<unsigned>& draws : _lodDraws)
+		draws = 0;
 }
 
 
@@ -12,37 +18,92 @@ ModuleMeshManager::~ModuleMeshManager()
 {
 }
 
+update_status ModuleMeshManager::PreUpdate(float DeltaTime)
+{
+	for (std::atomic<unsigned>& draws : _lodDraws)
+		draws = 0;
+
+	return UPDATE_CONTINUE;
+}
+
 bool ModuleMeshManager::CleanUp()
 {
 	LOG("Cleaning meshes and MeshManager");
-	LOG("%i meshes were loaded", _meshContainer.size());
+	LOG("%i meshes were loaded", _meshPool.Size());
 
-	for (auto meshPair : _meshContainer)
+	_meshPool.Clear([this](MeshHandle, Mesh& mesh)
 	{
-		RELEASE(meshPair.second);
-	}
-
-	_meshContainer.clear();
+		destroy(mesh);
+	});
 
 	return true;
 }
 
-Mesh* ModuleMeshManager::CreateMesh()
+MeshHandle ModuleMeshManager::CreateMesh()
+{
+	return _meshPool.Create();
+}
+
+Mesh* ModuleMeshManager::GetMesh(MeshHandle handle)
+{
+	return _meshPool.Get(handle);
+}
+
+const Mesh* ModuleMeshManager::GetMesh(MeshHandle handle) const
+{
+	return _meshPool.Get(handle);
+}
+
+void ModuleMeshManager::AddRef(MeshHandle handle)
 {
-	Mesh* mesh = new Mesh;
-	mesh->id = _lastId++;
-	_meshContainer[mesh->id] = mesh;
-	return mesh;
+	_meshPool.AddRef(handle);
 }
 
-Mesh* ModuleMeshManager::GetMeshById(int id) const
+void ModuleMeshManager::Release(MeshHandle handle)
 {
-	const auto it = _meshContainer.find(id);
+	_meshPool.Release(handle);
+}
+
+size_t ModuleMeshManager::ReleaseUnused()
+{
+	size_t released = _meshPool.ReleaseUnused([this](MeshHandle, Mesh& mesh)
+	{
+		destroy(mesh);
+	});
+
+	LOG("%i unused meshes were freed", released);
+	return released;
+}
+
+void ModuleMeshManager::destroy(Mesh& mesh)
+{
+	RenderDevice* device = App->GetModule<ModuleRender>()->GetDevice();
 
-	if (it == _meshContainer.end())
+	GLuint buffers[] = { mesh.vertexID, mesh.normalID, mesh.textureCoordsID, mesh.indexesID };
+	for (GLuint buffer : buffers)
 	{
-		return nullptr;
+		if (buffer != 0)
+			device->DeleteBuffer(buffer);
 	}
 
-	return it->second;
+	if (mesh.skin != nullptr)
+	{
+		GLuint skinBuffers[] = { mesh.skin->BoneIndicesID, mesh.skin->BoneWeightsID, mesh.skin->SkinnedVertexID, mesh.skin->SkinnedNormalID };
+		for (GLuint buffer : skinBuffers)
+		{
+			if (buffer != 0)
+				device->DeleteBuffer(buffer);
+		}
+
+		RELEASE(mesh.skin);
+	}
+
+	RELEASE(mesh.bvh);
+
+	for (MeshLod& lod : mesh.lods)
+		device->DeleteBuffer(lod.indexesID);
+
+	MemoryTracker::TrackExternal(MemoryTag::Meshes, -ptrdiff_t(mesh.gpuBytes));
+
+	App->GetModule<ModuleMaterialManager>()->Release(mesh.material);
 }
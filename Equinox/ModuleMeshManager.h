@@ -1,9 +1,8 @@
 #pragma once
 #include "Module.h"
-
-#include <unordered_map>
-
-struct Mesh;
+#include "ResourcePool.h"
+#include "MeshComponent.h"
+#include <atomic>
 
 class ModuleMeshManager :
 	public Module
@@ -12,14 +11,27 @@ public:
 	ModuleMeshManager();
 	~ModuleMeshManager();
 
+	update_status PreUpdate(float DeltaTime) override;
 	bool CleanUp() override;
 
-	Mesh* CreateMesh();
-	Mesh* GetMeshById(int id) const;
+	MeshHandle CreateMesh();
+	Mesh* GetMesh(MeshHandle handle);
+	const Mesh* GetMesh(MeshHandle handle) const;
+
+	void AddRef(MeshHandle handle);
+	void Release(MeshHandle handle);
+
+	// Frees the GPU buffers of every mesh without references, returns the number of meshes freed
+	size_t ReleaseUnused();
+
+	// Meshes drawn at each LOD this frame, meshes are drawn from several threads
+	void CountLodDraw(unsigned lod) { _lodDraws[lod].fetch_add(1, std::memory_order_relaxed); }
+	unsigned GetLodDrawCount(unsigned lod) const { return _lodDraws[lod]; }
 
 private:
-	int _lastId = 0;
+	void destroy(Mesh& mesh);
 
-	std::unordered_map<int, Mesh*> _meshContainer;
+	ResourcePool<Mesh> _meshPool;
+	std::atomic<unsigned> _lodDraws[MAX_MESH_LODS];
 };
 
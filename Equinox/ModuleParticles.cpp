@@ -0,0 +1,84 @@
+#include "ModuleParticles.h"
+#include "Engine.h"
+#include "ModuleJobSystem.h"
+#include "ParticleEmitter.h"
+#include "ParticleSimulation.h"
+#include <algorithm>
+
+// Particles integrated by a single job, a multiple of the SIMD lane width so chunks stay aligned
+#define PARTICLE_CHUNK_SIZE (ParticleBuffer::LANE_WIDTH * 2048)
+
+ModuleParticles::ModuleParticles(bool start_enabled) : Module(start_enabled)
+{
+}
+
+ModuleParticles::~ModuleParticles()
+{
+}
+
+bool ModuleParticles::Start()
+{
+	_jobSystem = App->GetModule<ModuleJobSystem>();
+	return true;
+}
+
+void ModuleParticles::Simulate(float DeltaTime)
+{
+	MEMORY_TAG_SCOPE(MemoryTag::Particles);
+
+	_activeEmitters.clear();
+	for (ParticleEmitter* emitter : _emitters)
+	{
+		if (emitter->IsSimulating())
+			_activeEmitters.push_back(emitter);
+	}
+
+	if (_activeEmitters.empty())
+		return;
+
+	// Each emitter owns its random stream, so emission gives the same particles whatever thread runs it
+	_jobSystem->ParallelFor(unsigned(_activeEmitters.size()), [this, DeltaTime](unsigned index)
+	{
+		_activeEmitters[index]->Emit(DeltaTime);
+	});
+
+	_chunks.clear();
+	for (ParticleEmitter* emitter : _activeEmitters)
+	{
+		unsigned size = emitter->_particles.Size();
+		for (unsigned begin = 0; begin < size; begin += PARTICLE_CHUNK_SIZE)
+			_chunks.push_back({ emitter, begin, std::min(begin + PARTICLE_CHUNK_SIZE, size) });
+	}
+
+	_jobSystem->ParallelFor(unsigned(_chunks.size()), [this, DeltaTime](unsigned index)
+	{
+		const SimulationChunk& chunk = _chunks[index];
+		ParticleSimulation::Integrate(chunk.Emitter->_particles, chunk.Begin, chunk.End, DeltaTime);
+	});
+
+	// Compaction reorders the whole buffer, it stays sequential inside an emitter to keep the order stable
+	_jobSystem->ParallelFor(unsigned(_activeEmitters.size()), [this](unsigned index)
+	{
+		ParticleSimulation::CompactDead(_activeEmitters[index]->_particles);
+	});
+}
+
+bool ModuleParticles::CleanUp()
+{
+	_emitters.clear();
+	_activeEmitters.clear();
+	_chunks.clear();
+	_jobSystem = nullptr;
+
+	return true;
+}
+
+void ModuleParticles::AddEmitter(ParticleEmitter* emitter)
+{
+	_emitters.push_back(emitter);
+}
+
+void ModuleParticles::RemoveEmitter(const ParticleEmitter* emitter)
+{
+	_emitters.erase(std::remove(_emitters.begin(), _emitters.end(), emitter), _emitters.end());
+}
@@ -0,0 +1,43 @@
+#ifndef __MODULEPARTICLES_H__
+#define __MODULEPARTICLES_H__
+
+#include "Module.h"
+#include <vector>
+
+class ParticleEmitter;
+class ModuleJobSystem;
+
+/*
+ * Particle simulation phase. Runs before the scene is traversed for rendering: emission is done
+ * per emitter and integration is split in fixed size chunks across the job system, so the emitters
+ * only have to draw their buffers during the GameObject update.
+ */
+class ModuleParticles : public Module
+{
+public:
+	ModuleParticles(bool start_enabled = true);
+	~ModuleParticles();
+
+	bool Start() override;
+	void Simulate(float DeltaTime) override;
+	bool CleanUp() override;
+
+	void AddEmitter(ParticleEmitter* emitter);
+	void RemoveEmitter(const ParticleEmitter* emitter);
+
+private:
+	struct SimulationChunk
+	{
+		ParticleEmitter* Emitter;
+		unsigned Begin;
+		unsigned End;
+	};
+
+	std::vector<ParticleEmitter*> _emitters;
+	std::vector<ParticleEmitter*> _activeEmitters;
+	std::vector<SimulationChunk> _chunks;
+
+	std::shared_ptr<ModuleJobSystem> _jobSystem;
+};
+
+#endif // __MODULEPARTICLES_H__
@@ -3,10 +3,11 @@
 #include "ModuleRender.h"
 #include "ModuleWindow.h"
 #include "ModuleInput.h"
+#include "ModuleSettings.h"
+#include "GLRenderDevice.h"
+#include "RecordingRenderDevice.h"
 #include "SDL/include/SDL.h"
-#include <windows.h>
 #include "GL/glew.h"
-#include <gl/GL.h>
 #include "Plane.h"
 #include "ModuleAnimation.h"
 #include "CoordinateArrows.h"
@@ -30,92 +31,82 @@ bool ModuleRender::Init()
 	_moduleWindow = App->GetModule<ModuleWindow>();
 	_moduleInput = App->GetModule<ModuleInput>();
 	_cameraManager = App->GetModule<ModuleCameraManager>();
+	std::shared_ptr<ModuleSettings> settings = App->GetModule<ModuleSettings>();
+
+	// Headless runs have no window to create a context on, their frames are always recorded
+	if (settings->Headless || settings->RenderBackend == "recording")
+		_device = new RecordingRenderDevice;
+	else
+	{
+		if (settings->RenderBackend != "gl")
+			LOG("Unknown render backend %s, using GL", settings->RenderBackend.c_str());
+		_device = new GLRenderDevice;
+	}
+
+	LOG("Render backend: %s", _device->GetName());
+
+	if (settings->PipelinedFrames)
+		_frameCommands = new RecordingRenderDevice;
+
+	RenderDevice::MakeCurrent(_frameCommands != nullptr ? _frameCommands : _device);
 	return true;
 }
 
 bool ModuleRender::Start()
 {
-	LOG("Creating Renderer context");
-	bool ret = true;
-	context = SDL_GL_CreateContext(_moduleWindow->window);
+	// The recording backend never reaches GL, so it runs without a context
+	if (_device->HasContext() && !createContext())
+		return false;
 
-	if (context == nullptr)
+	_device->SetState(RenderState::DepthTest, true);
+	_device->SetState(RenderState::CullFace, true);
+	_device->SetState(RenderState::ColorMaterial, true);
+	_device->SetState(RenderState::Texture2D, true);
+	_device->SetState(RenderState::Blend, true);
+
+	int w, h;
+	_moduleWindow->GetWindowSize(w, h);
+
+	CameraComponent* camera = _cameraManager->GetMainCamera();
+	if (nullptr != camera)
 	{
-		LOG("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
-		ret = false;
+		camera->SetAspectRatio(float(w) / float(h));
 	}
-	else
-	{
-		GLenum err = glewInit();
-
-		if (err != GLEW_OK)
-		{
-			LOG("Error initialising GLEW: %s", glewGetErrorString(err));
-			return false;
-		}
-
-		LOG("Using Glew %s", glewGetString(GLEW_VERSION));
-		LOG("Vendor: %s", glGetString(GL_VENDOR));
-		LOG("Renderer: %s", glGetString(GL_RENDERER));
-		LOG("OpenGL version supported %s", glGetString(GL_VERSION));
-		LOG("GLSL: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
-
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-
-		glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
-		glClearDepth(1.0f);
-		glClearColor(0, 0, 0, 1.f);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_CULL_FACE);
-		glEnable(GL_COLOR_MATERIAL);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-
-		int w, h;
-		_moduleWindow->GetWindowSize(w, h);
-		CameraComponent* camera = _cameraManager->GetMainCamera();
-		if (nullptr != camera)
-		{
-			camera->SetAspectRatio(float(w) / float(h));
-		}
 
-		Quat rotation_plane = Quat::FromEulerXYZ(DEG2RAD(0.f), DEG2RAD(0.f), DEG2RAD(0.f));
-		objects.push_back(new ::Plane(float3(0, 0.f, -5.f), rotation_plane, 60));
+	Quat rotation_plane = Quat::FromEulerXYZ(DEG2RAD(0.f), DEG2RAD(0.f), DEG2RAD(0.f));
+	objects.push_back(new ::Plane(float3(0, 0.f, -5.f), rotation_plane, 60));
 
-		objects.push_back(new CoordinateArrows());
+	objects.push_back(new CoordinateArrows());
 
+	if (context != nullptr)
 		SetVSync(-1);
-	}
-	return ret;
+
+	return true;
 }
 
 update_status ModuleRender::PreUpdate(float DeltaTime)
-{	
-	
+{
 	CameraComponent* camera = _cameraManager->GetMainCamera();
 
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glLoadMatrixf(camera->GetProjectionMatrix());
+	_device->BeginFrame();
+	if (_frameCommands != nullptr)
+	{
+		_frameCommands->InheritStates(*_device);
+		_frameCommands->BeginFrame();
+	}
+
+	RenderDevice* device = RenderDevice::Current();
 
 	if (_moduleInput->GetWindowEvent(WE_RESIZE))
 	{
 		int w, h;
 		_moduleWindow->GetWindowSize(w, h);
 		camera->SetAspectRatio(float(w) / float(h));
-		glViewport(0, 0, w, h);
+		device->SetViewport(0, 0, w, h);
 	}
 
-	glClearColor(0, 0, 0, 1.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	glLoadMatrixf(camera->GetViewMatrix());
+	device->Clear(float4(0, 0, 0, 1.f));
+	device->SetCamera(camera->GetProjectionMatrix(), camera->GetViewMatrix());
 
 	return UPDATE_CONTINUE;
 }
@@ -133,7 +124,19 @@ update_status ModuleRender::Update(float DeltaTime)
 
 update_status ModuleRender::PostUpdate(float DeltaTime)
 {
-	SDL_GL_SwapWindow(_moduleWindow->window);
+	if (_frameCommands != nullptr)
+	{
+		_frameCommands->EndFrame();
+		_frameCommands->Replay(*_device);
+	}
+
+	_device->EndFrame();
+
+	if (_overlay)
+		_overlay();
+
+	if (context != nullptr)
+		SDL_GL_SwapWindow(_moduleWindow->window);
 
 	return UPDATE_CONTINUE;
 }
@@ -144,39 +147,78 @@ bool ModuleRender::CleanUp()
 	LOG("Destroying renderer");
 
 	//Destroy window
+	for (std::list<Primitive*>::iterator it = objects.begin(); it != objects.end(); ++it)
+	{
+		(*it)->CleanUp();
+		RELEASE(*it);
+	}
+
 	if (context != nullptr)
 	{
 		SDL_GL_DeleteContext(context);
 	}
 
-	for (std::list<Primitive*>::iterator it = objects.begin(); it != objects.end(); ++it)
+	_overlay = nullptr;
+	RenderDevice::MakeCurrent(nullptr);
+	RELEASE(_frameCommands);
+	RELEASE(_device);
+
+	return true;
+}
+
+bool ModuleRender::createContext()
+{
+	LOG("Creating Renderer context");
+
+	context = SDL_GL_CreateContext(_moduleWindow->window);
+
+	if (context == nullptr)
 	{
-		(*it)->CleanUp();
-		RELEASE(*it);
+		LOG("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	GLenum err = glewInit();
+
+	if (err != GLEW_OK)
+	{
+		LOG("Error initialising GLEW: %s", glewGetErrorString(err));
+		return false;
 	}
 
+	LOG("Using Glew %s", glewGetString(GLEW_VERSION));
+	LOG("Vendor: %s", glGetString(GL_VENDOR));
+	LOG("Renderer: %s", glGetString(GL_RENDERER));
+	LOG("OpenGL version supported %s", glGetString(GL_VERSION));
+	LOG("GLSL: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+	glClearDepth(1.0f);
+	glClearColor(0, 0, 0, 1.f);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
 	return true;
 }
 
-using PFNWGLSWAPINTERVALFARPROC = BOOL(APIENTRY *)(int);
 void ModuleRender::SetVSync(int interval) const
 {
-	PFNWGLSWAPINTERVALFARPROC wglSwapIntervalEXT = reinterpret_cast<PFNWGLSWAPINTERVALFARPROC>(wglGetProcAddress("wglSwapIntervalEXT"));
-
-	if (wglSwapIntervalEXT)
+	// SDL picks the swap control extension of the platform. -1 asks for late swap tearing, which not every driver has.
+	if (SDL_GL_SetSwapInterval(interval) == 0)
+	{
+		LOG("VSync changed");
+	}
+	else if (interval == -1 && SDL_GL_SetSwapInterval(1) == 0)
 	{
-		if (wglSwapIntervalEXT(interval))
-		{
-			LOG("VSync changed");
-		}
-		else
-		{
-			LOG("VSync change failed");
-		}
+		LOG("Late swap tearing unsupported, VSync changed");
 	}
 	else
 	{
-		LOG("VSync change unsupported");
+		LOG("VSync change failed: %s", SDL_GetError());
 	}
 }
 
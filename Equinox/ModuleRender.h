@@ -3,12 +3,15 @@
 
 #include "Module.h"
 #include "Rectangle3.h"
+#include <functional>
 
 #define CHECKERS_WIDTH 64
 #define CHECKERS_HEIGHT 64
 
 class Primitive;
 class Level;
+class RenderDevice;
+class RecordingRenderDevice;
 
 class ModuleRender : public Module
 {
@@ -25,15 +28,27 @@ public:
 	bool CleanUp();
 	void SetVSync(int interval) const;
 
+	RenderDevice* GetDevice() const { return _device; }
+	// Drawn straight with GL over the submitted frame, right before presenting it
+	void SetOverlay(const std::function<void()>& overlay) { _overlay = overlay; }
+
 public:
 	void* context = nullptr;
 		
+private:
+	bool createContext();
+
 private:
 	std::list<Primitive*> objects;
 
 	std::shared_ptr<class ModuleWindow> _moduleWindow;
 	std::shared_ptr<class ModuleInput> _moduleInput;
 	std::shared_ptr<class ModuleCameraManager> _cameraManager;
+
+	RenderDevice* _device = nullptr;
+	// With pipelined frames the whole frame is recorded here and submitted in PostUpdate, while the next one simulates
+	RecordingRenderDevice* _frameCommands = nullptr;
+	std::function<void()> _overlay;
 };
 
 #endif // __MODULERENDER_H__
@@ -20,6 +20,69 @@ bool ModuleSettings::Init()
 			MaxFps = static_cast<int>(json_object_get_number(settings, "maxFps"));
 		else
 			MaxFps = 60;
+
+		if (json_object_has_value(settings, "textureBudgetMB"))
+			TextureBudgetMB = static_cast<int>(json_object_get_number(settings, "textureBudgetMB"));
+
+		if (json_object_has_value(settings, "compressTextures"))
+			CompressTextures = json_object_get_boolean(settings, "compressTextures") == 1;
+
+		if (json_object_has_value(settings, "atlasTextures"))
+			AtlasTextures = json_object_get_boolean(settings, "atlasTextures") == 1;
+
+		if (json_object_has_value(settings, "workerThreads"))
+			WorkerThreads = static_cast<int>(json_object_get_number(settings, "workerThreads"));
+
+		if (json_object_has_value(settings, "animationPositionError"))
+			AnimationPositionError = static_cast<float>(json_object_get_number(settings, "animationPositionError"));
+
+		if (json_object_has_value(settings, "animationRotationError"))
+			AnimationRotationError = static_cast<float>(json_object_get_number(settings, "animationRotationError"));
+
+		if (json_object_has_value(settings, "animationScaleError"))
+			AnimationScaleError = static_cast<float>(json_object_get_number(settings, "animationScaleError"));
+
+		if (json_object_has_value(settings, "gpuSkinning"))
+			GpuSkinning = json_object_get_boolean(settings, "gpuSkinning") == 1;
+
+		if (json_object_has_value(settings, "meshBVH"))
+			BuildMeshBVH = json_object_get_boolean(settings, "meshBVH") == 1;
+
+		if (json_object_has_value(settings, "meshLods"))
+			MeshLods = static_cast<unsigned>(json_object_get_number(settings, "meshLods"));
+
+		if (json_object_has_value(settings, "occlusionCulling"))
+			OcclusionCulling = json_object_get_boolean(settings, "occlusionCulling") == 1;
+
+		if (json_object_has_value(settings, "headless"))
+			Headless = json_object_get_boolean(settings, "headless") == 1;
+
+		if (json_object_has_value(settings, "headlessFrames"))
+			HeadlessFrames = static_cast<int>(json_object_get_number(settings, "headlessFrames"));
+
+		if (json_object_has_value(settings, "pipelinedFrames"))
+			PipelinedFrames = json_object_get_boolean(settings, "pipelinedFrames") == 1;
+
+		if (json_object_has_value(settings, "parallelRenderRecording"))
+			ParallelRenderRecording = json_object_get_boolean(settings, "parallelRenderRecording") == 1;
+
+		if (json_object_has_value(settings, "renderBackend"))
+			RenderBackend = json_object_get_string(settings, "renderBackend");
+
+		JSON_Object* budgets = json_object_get_object(settings, "memoryBudgetsMB");
+		if (budgets != nullptr)
+		{
+			for (size_t i = 0; i < json_object_get_count(budgets); ++i)
+			{
+				const char* name = json_object_get_name(budgets, i);
+				MemoryTag tag;
+				if (MemoryTracker::GetTagByName(name, tag))
+					MemoryTracker::SetBudget(tag, size_t(json_object_get_number(budgets, name) * 1024 * 1024));
+				else
+					LOG("Unknown memory tag %s in the memory budgets", name);
+			}
+		}
+
 		return true;
 	}
 
@@ -3,6 +3,7 @@
 
 #include "Module.h"
 #include "parson.h"
+#include <string>
 
 class ModuleSettings : public Module
 {
@@ -14,6 +15,23 @@ public:
 	bool CleanUp() override;
 
 	int MaxFps = 0;
+	int TextureBudgetMB = 0;
+	bool CompressTextures = true;
+	bool AtlasTextures = true;
+	int WorkerThreads = 0; // 0 uses one worker per spare hardware thread
+	// Largest error the key reduction of imported animations may add to each kind of track, 0 keeps every key
+	float AnimationPositionError = 0.001f; // Units
+	float AnimationRotationError = 0.001f; // Radians
+	float AnimationScaleError = 0.0005f; // Scale factor
+	bool GpuSkinning = true;
+	bool BuildMeshBVH = true; // Triangle BVH per imported mesh for precise scene queries
+	unsigned MeshLods = 3; // Simplified levels generated per imported mesh
+	bool OcclusionCulling = true;
+	bool Headless = false; // No window, GL context or editor UI, frames are recorded. For unattended performance runs.
+	int HeadlessFrames = 0; // Frames to run before quitting when headless, 0 runs until closed
+	bool PipelinedFrames = true; // Simulates the next frame while the current one is submitted, one frame of latency
+	bool ParallelRenderRecording = true; // Meshes are recorded to command buffers by jobs and submitted by the main thread
+	std::string RenderBackend = "gl"; // "gl" draws, "recording" only records and validates the frame, with no GL context
 
 private:
 	JSON_Value* rootValue = nullptr;
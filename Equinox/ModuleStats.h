@@ -2,6 +2,7 @@
 #include "Module.h"
 #include "SimpleTimer.h"
 #include "ComplexTimer.h"
+#include <cfloat>
 
 class ModuleStats :
 	public Module
@@ -17,12 +18,22 @@ public:
 	int Uptime() const { return _total_simple_time.Read(); }
 	float DeltaTime() const { return _delta_time; }
 	float FrameCount() const { return _total_frames; }
+	// Time spent running the updates of every module, per frame
+	float AverageFrameMs() const { return _total_frames > 0.f ? _frame_ms_sum / _total_frames : 0.f; }
+	float MinFrameMs() const { return _min_frame_ms; }
+	float MaxFrameMs() const { return _max_frame_ms; }
+	// Time the main thread waited for the simulation of the frame with pipelined frames, per frame
+	float AverageSimulationWaitMs() const { return _total_frames > 0.f ? _simulation_wait_ms_sum / _total_frames : 0.f; }
 
 private:
 	float _total_frames = 0.f;
 	float _delta_time = 0.f;
 	float _current_avg = 0;
 	float _current_fps = 0.f;
+	float _frame_ms_sum = 0.f;
+	float _min_frame_ms = FLT_MAX;
+	float _max_frame_ms = 0.f;
+	float _simulation_wait_ms_sum = 0.f;
 	ComplexTimer _total_complex_time;
 	SimpleTimer _total_simple_time;
 };
@@ -1,13 +1,23 @@
 #include "Globals.h"
 #include "Engine.h"
 #include "ModuleRender.h"
+#include "RenderDevice.h"
 #include "ModuleTextures.h"
+#include "ModuleSettings.h"
+#include "TextureStreamer.h"
 #include "SDL/include/SDL.h"
 
 #include "SDL_image/include/SDL_image.h"
 #include <IL/ilut.h>
 #include <cassert>
 
+// Atlas pages keep a short mip chain, so packed textures are aligned to whole compression blocks on every level
+#define ATLAS_PAGE_SIZE 2048
+#define ATLAS_MIP_LEVELS 4
+#define ATLAS_CELL_SIZE (4 << (ATLAS_MIP_LEVELS - 1))
+#define ATLAS_PADDING 16
+#define ATLAS_MAX_TEXTURE_SIZE 256
+
 using namespace std;
 
 ModuleTextures::ModuleTextures()
@@ -38,90 +48,472 @@ bool ModuleTextures::Init()
 	return ret;
 }
 
+bool ModuleTextures::Start()
+{
+	std::shared_ptr<ModuleSettings> settings = App->GetModule<ModuleSettings>();
+	_cookOptions.Compress = settings->CompressTextures;
+	_memoryBudget = size_t(settings->TextureBudgetMB) * 1024 * 1024;
+	_useAtlas = settings->AtlasTextures;
+
+	_hasContext = App->GetModule<ModuleRender>()->GetDevice()->HasContext();
+
+	// Without a context the cooked blocks are what would be resident on a desktop GPU
+	_supportsS3TC = !_hasContext || GLEW_EXT_texture_compression_s3tc != 0;
+	if (!_supportsS3TC)
+	{
+		LOG("S3TC is not supported, compressed textures will be expanded on upload");
+	}
+
+	_streamer = new TextureStreamer;
+
+	return true;
+}
+
+update_status ModuleTextures::PostUpdate(float DeltaTime)
+{
+	uploadStreamed();
+	enforceBudget();
+	++_frame;
+
+	MemoryTracker::SetExternal(MemoryTag::Textures, _residentBytes);
+
+	return UPDATE_CONTINUE;
+}
+
 // Called before quitting
 bool ModuleTextures::CleanUp()
 {
 	LOG("Freeing textures and Texture Manager");
 
-	for (TextureMap::iterator it = _textures.begin(); it != _textures.end(); ++it)
+	RELEASE(_streamer);
+
+	_texturePool.Clear([this](TextureHandle, Texture& texture)
+	{
+		destroy(texture);
+	});
+
+	for (AtlasPage* page : _atlasPages)
 	{
-		glDeleteTextures(1, &it->second);
+		if (page != nullptr && _hasContext)
+			glDeleteTextures(1, &page->GLId);
+		RELEASE(page);
 	}
 
-	_textures.clear();
+	_atlasPages.clear();
+	_texturesByPath.clear();
+	_atlasedTexturesByPath.clear();
+	_residentBytes = 0;
 	return true;
 }
 
-// Load new texture from file path
-unsigned ModuleTextures::Load(const string& path)
+// Load new texture from file path, cooking it first if needed
+TextureHandle ModuleTextures::Load(const string& path, bool allowAtlas)
 {
-	TextureMap::iterator it = _textures.find(path);
+	MEMORY_TAG_SCOPE(MemoryTag::Textures);
+	if (allowAtlas)
+	{
+		auto it = _atlasedTexturesByPath.find(path);
+		if (it != _atlasedTexturesByPath.end())
+			return it->second;
+	}
 
-	if (it != _textures.end())
+	// A texture with its own GL texture is valid for every material
+	auto it = _texturesByPath.find(path);
+	if (it != _texturesByPath.end())
 		return it->second;
 
-	unsigned textureID = 0;
+	string cookedPath = TextureCooker::GetCookedPath(path);
+
+	CookedTexture cooked;
+	bool upToDate = TextureCooker::IsCookedUpToDate(path, cookedPath) && TextureCooker::Load(cookedPath, cooked) &&
+		_cookOptions.Compress == (cooked.Format != CookedTextureFormat::RGBA8);
+
+	if (!upToDate && TextureCooker::Cook(path, cookedPath, _cookOptions))
+	{
+		TextureCooker::Load(cookedPath, cooked);
+	}
+
+	if (cooked.Mips.empty())
+	{
+		LOG("Could not load texture %s", path.c_str());
+		return TextureHandle();
+	}
+
+	TextureHandle handle = _texturePool.Create();
+	Texture* texture = _texturePool.Get(handle);
+	texture->Path = path;
+	texture->CookedPath = cookedPath;
+	texture->LastUsedFrame = _frame;
+	texture->Width = cooked.Mips[0].Width;
+	texture->Height = cooked.Mips[0].Height;
+
+	bool atlased = allowAtlas && _useAtlas && addToAtlas(*texture, cooked);
+	if (!atlased)
+	{
+		if (_hasContext)
+			glGenTextures(1, &texture->GLId);
+		upload(*texture, cooked.Format, cooked.Mips.data(), unsigned(cooked.Mips.size()), 0);
+	}
+
+	if (atlased)
+		_atlasedTexturesByPath[path] = handle;
+	else
+		_texturesByPath[path] = handle;
+
+	return handle;
+}
+
+unsigned ModuleTextures::GetTextureId(TextureHandle handle) const
+{
+	const Texture* texture = _texturePool.Get(handle);
+	return texture != nullptr ? texture->GLId : 0;
+}
+
+float4 ModuleTextures::GetUVTransform(TextureHandle handle) const
+{
+	const Texture* texture = _texturePool.Get(handle);
+	return texture != nullptr ? texture->UVTransform : float4(1.f, 1.f, 0.f, 0.f);
+}
+
+bool ModuleTextures::GetTextureSize(TextureHandle handle, unsigned& width, unsigned& height) const
+{
+	const Texture* texture = _texturePool.Get(handle);
+	if (texture == nullptr)
+		return false;
+
+	width = texture->Width;
+	height = texture->Height;
+	return true;
+}
+
+void ModuleTextures::AddRef(TextureHandle handle)
+{
+	_texturePool.AddRef(handle);
+}
+
+void ModuleTextures::Release(TextureHandle handle)
+{
+	_texturePool.Release(handle);
+}
+
+size_t ModuleTextures::ReleaseUnused()
+{
+	size_t released = _texturePool.ReleaseUnused([this](TextureHandle, Texture& texture)
+	{
+		destroy(texture);
+	});
+
+	LOG("%i unused textures were freed", released);
+	return released;
+}
+
+size_t ModuleTextures::GetAtlasPageCount() const
+{
+	size_t count = 0;
+	for (AtlasPage* page : _atlasPages)
+	{
+		if (page != nullptr)
+			++count;
+	}
+	return count;
+}
+
+void ModuleTextures::Touch(TextureHandle handle)
+{
+	Texture* texture = _texturePool.Get(handle);
+	if (texture != nullptr)
+	{
+		texture->LastUsedFrame = _frame;
+	}
+}
+
+bool ModuleTextures::upload(Texture& texture, CookedTextureFormat format, const CookedMipLevel* mips, unsigned mipCount, unsigned firstMip)
+{
+	if (mipCount == 0)
+		return false;
+
+	GLenum compressedFormat = format == CookedTextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	bool uploadCompressed = format != CookedTextureFormat::RGBA8 && _supportsS3TC;
+
+	if (texture.MipSizes.empty())
+		texture.MipSizes.resize(firstMip + mipCount);
+
+	if (_hasContext)
+		glBindTexture(GL_TEXTURE_2D, texture.GLId);
+
+	size_t residentBytes = 0;
+	std::vector<uint8_t> expanded;
+	for (unsigned i = 0; i < mipCount; ++i)
+	{
+		const CookedMipLevel& level = mips[i];
+		size_t levelSize;
+
+		if (uploadCompressed)
+		{
+			if (_hasContext)
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, compressedFormat, level.Width, level.Height, 0, GLsizei(level.Data.size()), level.Data.data());
+			levelSize = level.Data.size();
+		}
+		else
+		{
+			TextureCooker::Decompress(format, level, expanded);
+			if (_hasContext)
+				glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.Width, level.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, expanded.data());
+			levelSize = expanded.size();
+		}
 
-	ILuint imageID;
-	ilGenImages(1, &imageID);
-	ilBindImage(imageID);
+		texture.MipSizes[firstMip + i] = levelSize;
+		residentBytes += levelSize;
+	}
 
-	ilLoadImage(path.c_str());
+	if (_hasContext)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(mipCount - 1));
 
-	ILubyte* data = ilGetData();
-	if (!data) {
-		ilBindImage(0);
-		ilDeleteImages(1, &imageID);
-		return 0;
+		glBindTexture(GL_TEXTURE_2D, 0);
 	}
 
-	ILinfo ImageInfo;
-	iluGetImageInfo(&ImageInfo);
-	if (ImageInfo.Origin == IL_ORIGIN_UPPER_LEFT)
+	_residentBytes = _residentBytes - texture.ResidentBytes + residentBytes;
+	texture.ResidentBytes = residentBytes;
+	texture.FirstResidentMip = firstMip;
+
+	return true;
+}
+
+void ModuleTextures::uploadStreamed()
+{
+	std::vector<StreamedTexture> finished;
+	if (!_streamer->CollectFinished(finished))
+		return;
+
+	for (StreamedTexture& streamed : finished)
 	{
-		iluFlipImage();
+		// The texture may have been freed while its levels were being read
+		Texture* texture = _texturePool.Get(streamed.Handle);
+		if (texture == nullptr)
+			continue;
+
+		if (streamed.Loaded)
+			upload(*texture, streamed.Cooked.Format, streamed.Cooked.Mips.data(), unsigned(streamed.Cooked.Mips.size()), streamed.FirstMip);
+		else
+			LOG("Could not stream texture %s", texture->Path.c_str());
 	}
+}
 
-	int channels = ilGetInteger(IL_IMAGE_CHANNELS);
+void ModuleTextures::destroy(Texture& texture)
+{
+	if (texture.AtlasPage >= 0)
+	{
+		releaseAtlasPage(texture.AtlasPage);
+		_atlasedTexturesByPath.erase(texture.Path);
+	}
+	else
+	{
+		if (_hasContext)
+			glDeleteTextures(1, &texture.GLId);
+		_texturesByPath.erase(texture.Path);
+	}
+
+	_residentBytes -= texture.ResidentBytes;
+}
+
+bool ModuleTextures::addToAtlas(Texture& texture, const CookedTexture& cooked)
+{
+	if (texture.Width > ATLAS_MAX_TEXTURE_SIZE || texture.Height > ATLAS_MAX_TEXTURE_SIZE)
+		return false;
 
-	if (channels == 3)
-		ilConvertImage(IL_RGB, IL_UNSIGNED_BYTE);
-	else if (channels == 4)
-		ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+	bool compressed = cooked.Format != CookedTextureFormat::RGBA8 && _supportsS3TC;
+	GLenum internalFormat = GL_RGBA;
+	if (compressed)
+		internalFormat = cooked.Format == CookedTextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 
-	int width = ilGetInteger(IL_IMAGE_WIDTH);
-	int height = ilGetInteger(IL_IMAGE_HEIGHT);
+	// The packer works in cells, the padding on the right and top keeps neighbours from bleeding into the lower mips
+	stbrp_rect rect;
+	rect.id = 0;
+	rect.w = stbrp_coord((texture.Width + ATLAS_PADDING + ATLAS_CELL_SIZE - 1) / ATLAS_CELL_SIZE);
+	rect.h = stbrp_coord((texture.Height + ATLAS_PADDING + ATLAS_CELL_SIZE - 1) / ATLAS_CELL_SIZE);
+	rect.was_packed = 0;
+
+	int pageIndex = -1;
+	for (size_t i = 0; i < _atlasPages.size() && pageIndex < 0; ++i)
+	{
+		AtlasPage* page = _atlasPages[i];
+		if (page != nullptr && page->InternalFormat == internalFormat)
+		{
+			stbrp_pack_rects(&page->Context, &rect, 1);
+			if (rect.was_packed)
+				pageIndex = int(i);
+		}
+	}
 
-	data = ilGetData();
+	if (pageIndex < 0)
+	{
+		pageIndex = createAtlasPage(internalFormat);
+		stbrp_pack_rects(&_atlasPages[pageIndex]->Context, &rect, 1);
+		if (!rect.was_packed)
+		{
+			releaseAtlasPage(pageIndex);
+			return false;
+		}
+	}
 
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	AtlasPage* page = _atlasPages[pageIndex];
+	++page->TextureCount;
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	unsigned x = rect.x * ATLAS_CELL_SIZE;
+	unsigned y = rect.y * ATLAS_CELL_SIZE;
 
-	glTexImage2D(GL_TEXTURE_2D, 0, ilGetInteger(IL_IMAGE_FORMAT), width, height, 0,
-		ilGetInteger(IL_IMAGE_FORMAT), GL_UNSIGNED_BYTE, data);
+	if (_hasContext)
+	{
+		glBindTexture(GL_TEXTURE_2D, page->GLId);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+		std::vector<uint8_t> expanded;
+		for (unsigned level = 0; level < ATLAS_MIP_LEVELS && level < cooked.Mips.size(); ++level)
+		{
+			const CookedMipLevel& mip = cooked.Mips[level];
+			if (compressed)
+			{
+				// Block data always covers whole 4x4 blocks, the padding leaves room for the rounded size
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, x >> level, y >> level, (mip.Width + 3) & ~3u, (mip.Height + 3) & ~3u,
+					internalFormat, GLsizei(mip.Data.size()), mip.Data.data());
+			}
+			else
+			{
+				TextureCooker::Decompress(cooked.Format, mip, expanded);
+				glTexSubImage2D(GL_TEXTURE_2D, level, x >> level, y >> level, mip.Width, mip.Height, GL_RGBA, GL_UNSIGNED_BYTE, expanded.data());
+			}
+		}
 
-	ilDeleteImage(imageID);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 
-	_textures[path] = textureID;
+	texture.GLId = page->GLId;
+	texture.AtlasPage = pageIndex;
+	texture.UVTransform = float4(float(texture.Width) / ATLAS_PAGE_SIZE, float(texture.Height) / ATLAS_PAGE_SIZE,
+		float(x) / ATLAS_PAGE_SIZE, float(y) / ATLAS_PAGE_SIZE);
 
-	return textureID;
+	return true;
 }
 
-// Free texture from memory
-void ModuleTextures::Unload(unsigned id)
+int ModuleTextures::createAtlasPage(GLenum internalFormat)
 {
-	for (TextureMap::iterator it = _textures.begin(); it != _textures.end(); ++it)
+	AtlasPage* page = new AtlasPage;
+	page->InternalFormat = internalFormat;
+	page->Nodes.resize(ATLAS_PAGE_SIZE / ATLAS_CELL_SIZE);
+	stbrp_init_target(&page->Context, ATLAS_PAGE_SIZE / ATLAS_CELL_SIZE, ATLAS_PAGE_SIZE / ATLAS_CELL_SIZE, page->Nodes.data(), int(page->Nodes.size()));
+
+	if (_hasContext)
+	{
+		glGenTextures(1, &page->GLId);
+		glBindTexture(GL_TEXTURE_2D, page->GLId);
+	}
+
+	// Levels are cleared so the padding samples as transparent black instead of undefined memory
+	std::vector<uint8_t> zeros;
+	for (unsigned level = 0; level < ATLAS_MIP_LEVELS; ++level)
 	{
-		if (it->second == id)
+		unsigned size = ATLAS_PAGE_SIZE >> level;
+		if (internalFormat == GL_RGBA)
 		{
-			glDeleteTextures(1, &it->second);
-			_textures.erase(it);
-			break;
+			zeros.assign(size * size * 4, 0);
+			if (_hasContext)
+				glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, zeros.data());
 		}
+		else
+		{
+			size_t blockSize = internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+			zeros.assign((size / 4) * (size / 4) * blockSize, 0);
+			if (_hasContext)
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, size, size, 0, GLsizei(zeros.size()), zeros.data());
+		}
+
+		page->SizeInBytes += zeros.size();
 	}
-}
\ No newline at end of file
+
+	if (_hasContext)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, ATLAS_MIP_LEVELS - 1);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	_residentBytes += page->SizeInBytes;
+
+	for (size_t i = 0; i < _atlasPages.size(); ++i)
+	{
+		if (_atlasPages[i] == nullptr)
+		{
+			_atlasPages[i] = page;
+			return int(i);
+		}
+	}
+
+	_atlasPages.push_back(page);
+	return int(_atlasPages.size() - 1);
+}
+
+void ModuleTextures::releaseAtlasPage(int index)
+{
+	AtlasPage* page = _atlasPages[index];
+	if (page->TextureCount > 0 && --page->TextureCount > 0)
+		return;
+
+	// The packer cannot free single rectangles, so a page is only recycled once all its textures are gone
+	if (_hasContext)
+		glDeleteTextures(1, &page->GLId);
+	_residentBytes -= page->SizeInBytes;
+	RELEASE(page);
+	_atlasPages[index] = nullptr;
+}
+
+void ModuleTextures::enforceBudget()
+{
+	// Each step streams the chain of one texture from its cooked file, so the budget moves a single level at a time
+	if (_memoryBudget == 0 || _streamer->GetPendingCount() > 0)
+		return;
+
+	if (_residentBytes > _memoryBudget)
+	{
+		// Drop the highest mip of the least recently used texture
+		Texture* candidate = nullptr;
+		TextureHandle candidateHandle;
+		_texturePool.ForEach([&candidate, &candidateHandle](TextureHandle handle, Texture& texture)
+		{
+			if (texture.FirstResidentMip + 1 < texture.MipSizes.size() &&
+				(candidate == nullptr || texture.LastUsedFrame < candidate->LastUsedFrame))
+			{
+				candidate = &texture;
+				candidateHandle = handle;
+			}
+		});
+
+		if (candidate != nullptr)
+			_streamer->Request(candidateHandle, candidate->CookedPath, candidate->FirstResidentMip + 1);
+		return;
+	}
+
+	// Bring back one mip of the most reduced texture in use, if there is room for it
+	Texture* candidate = nullptr;
+	TextureHandle candidateHandle;
+	_texturePool.ForEach([this, &candidate, &candidateHandle](TextureHandle handle, Texture& texture)
+	{
+		if (texture.FirstResidentMip > 0 && texture.LastUsedFrame == _frame &&
+			_residentBytes + texture.MipSizes[texture.FirstResidentMip - 1] <= _memoryBudget &&
+			(candidate == nullptr || texture.FirstResidentMip > candidate->FirstResidentMip))
+		{
+			candidate = &texture;
+			candidateHandle = handle;
+		}
+	});
+
+	if (candidate != nullptr)
+		_streamer->Request(candidateHandle, candidate->CookedPath, candidate->FirstResidentMip - 1);
+}
@@ -2,10 +2,29 @@
 #define __MODULETEXTURES_H__
 
 #include "Module.h"
-#include <map>
+#include "TextureCooker.h"
+#include "ResourcePool.h"
+#include "IMGUI/stb_rect_pack.h"
+#include <MathGeoLib/include/Math/float4.h>
+#include <unordered_map>
 
 struct SDL_Texture;
 
+struct Texture
+{
+	unsigned GLId = 0;
+	std::string Path;
+	std::string CookedPath;
+	std::vector<size_t> MipSizes;
+	unsigned FirstResidentMip = 0;
+	size_t ResidentBytes = 0;
+	unsigned LastUsedFrame = 0;
+	unsigned Width = 0;
+	unsigned Height = 0;
+	int AtlasPage = -1; // -1 when the texture owns its GL texture
+	float4 UVTransform = float4(1.f, 1.f, 0.f, 0.f); // xy scale, zw offset inside the GL texture
+};
+
 class ModuleTextures : public Module
 {
 public:
@@ -13,16 +32,67 @@ public:
 	~ModuleTextures();
 
 	bool Init() override;
+	bool Start() override;
+	update_status PostUpdate(float DeltaTime) override;
 	bool CleanUp() override;
 
-	unsigned Load(const std::string& path);
-	void Unload(unsigned id);
+	// Returns the handle of an already loaded texture or loads it, the caller must AddRef it to keep it alive.
+	// Small textures that are only sampled inside [0, 1] can be packed into a shared atlas page.
+	TextureHandle Load(const std::string& path, bool allowAtlas = false);
+	unsigned GetTextureId(TextureHandle handle) const;
+	float4 GetUVTransform(TextureHandle handle) const;
+	bool GetTextureSize(TextureHandle handle, unsigned& width, unsigned& height) const;
+
+	void AddRef(TextureHandle handle);
+	void Release(TextureHandle handle);
+
+	// Frees every texture without references, returns the number of textures freed
+	size_t ReleaseUnused();
+
+	// Marks the texture as used this frame, the budget evicts the least recently used ones first
+	void Touch(TextureHandle handle);
+
+	size_t GetResidentMemory() const { return _residentBytes; }
+	size_t GetMemoryBudget() const { return _memoryBudget; }
+
+	size_t GetAtlasPageCount() const;
 
 private:
+	struct AtlasPage
+	{
+		unsigned GLId = 0;
+		GLenum InternalFormat = GL_RGBA;
+		size_t SizeInBytes = 0;
+		unsigned TextureCount = 0;
+		stbrp_context Context;
+		std::vector<stbrp_node> Nodes;
+	};
+
+	bool addToAtlas(Texture& texture, const CookedTexture& cooked);
+	int createAtlasPage(GLenum internalFormat);
+	void releaseAtlasPage(int index);
+
+	bool upload(Texture& texture, CookedTextureFormat format, const CookedMipLevel* mips, unsigned mipCount, unsigned firstMip);
+	void uploadStreamed();
+	void destroy(Texture& texture);
+	void enforceBudget();
+
+	ResourcePool<Texture> _texturePool;
+	// A path can be loaded twice: packed for materials that allow it and with its own GL texture for the rest
+	std::unordered_map<std::string, TextureHandle> _texturesByPath;
+	std::unordered_map<std::string, TextureHandle> _atlasedTexturesByPath;
+	std::vector<AtlasPage*> _atlasPages;
+
+	class TextureStreamer* _streamer = nullptr;
 
-	typedef std::map <std::string, unsigned> TextureMap;
+	TextureCookOptions _cookOptions;
+	bool _hasContext = true; // Without one only the sizes are kept, nothing is sent to GL
+	bool _supportsS3TC = false;
+	bool _useAtlas = true;
 
-	TextureMap _textures;
+	size_t _memoryBudget = 0; // 0 means unlimited
+	size_t _residentBytes = 0;
+	unsigned _frame = 0;
 };
 
-#endif // __MODULETEXTURES_H__
\ No newline at end of file
+#endif // __MODULETEXTURES_H__
@@ -1,11 +1,9 @@
 #include "Globals.h"
 #include "Engine.h"
 #include "ModuleWindow.h"
+#include "ModuleSettings.h"
 #include "SDL/include/SDL.h"
 #include "GL/glew.h"
-#include "SDL/include/SDL_opengl.h"
-#include <gl/GL.h>
-#include <gl/GLU.h>
 
 ModuleWindow::ModuleWindow()
 {
@@ -19,6 +17,9 @@ ModuleWindow::~ModuleWindow()
 // Called before render is available
 bool ModuleWindow::Init()
 {
+	if (App->GetModule<ModuleSettings>()->Headless)
+		return initHeadless(SCREEN_WIDTH * SCREEN_SIZE, SCREEN_HEIGHT * SCREEN_SIZE);
+
 	LOG("Init SDL window & surface");
 	bool ret = true;
 
@@ -86,5 +87,22 @@ bool ModuleWindow::CleanUp()
 
 void ModuleWindow::GetWindowSize(int& w, int& h) const
 {
-	SDL_GetWindowSize(window, &w, &h);
+	if (_headless)
+	{
+		w = _width;
+		h = _height;
+	}
+	else
+		SDL_GetWindowSize(window, &w, &h);
+}
+
+bool ModuleWindow::initHeadless(int width, int height)
+{
+	// Headless frames are only recorded, so there is no display to open nor a window to draw to
+	LOG("Init headless frames of %ix%i", width, height);
+	_headless = true;
+	_width = width;
+	_height = height;
+
+	return true;
 }
@@ -22,6 +22,7 @@ public:
 	bool CleanUp();
 
 	void GetWindowSize(int& w, int& h) const;
+	bool IsHeadless() const { return _headless; }
 
 public:
 	//The window we'll be rendering to
@@ -29,6 +30,13 @@ public:
 
 	//The surface contained by the window
 	SDL_Surface* screen_surface = nullptr;
+
+private:
+	bool initHeadless(int width, int height);
+
+	bool _headless = false;
+	int _width = 0; // Size of the recorded frames when headless
+	int _height = 0;
 };
 
 #endif // __MODULEWINDOW_H__
\ No newline at end of file
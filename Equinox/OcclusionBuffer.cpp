@@ -0,0 +1,338 @@
+#include "OcclusionBuffer.h"
+#include "SimdConfig.h"
+#include "Globals.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	const float MIN_CLIP_W = 1e-4f;
+
+	// Edges are E(x, y) = A * x + B * y + C, positive inside. Depth is a plane in screen space.
+	struct ScreenTriangle
+	{
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		float DepthA;
+		float DepthB;
+		float DepthC;
+		int MinX, MaxX;
+		int MinY, MaxY;
+	};
+
+	bool SetupTriangle(float3 v0, float3 v1, float3 v2, unsigned width, unsigned height, ScreenTriangle& triangle)
+	{
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (fabsf(area) < 1e-8f)
+			return false;
+
+		// Occluders are drawn double sided, counter clockwise keeps the edge functions positive inside
+		if (area < 0.f)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		// Pixels are sampled at their centers
+		float minX = MIN(v0.x, MIN(v1.x, v2.x));
+		float maxX = MAX(v0.x, MAX(v1.x, v2.x));
+		float minY = MIN(v0.y, MIN(v1.y, v2.y));
+		float maxY = MAX(v0.y, MAX(v1.y, v2.y));
+		triangle.MinX = int(MAX(ceilf(minX - 0.5f), 0.f));
+		triangle.MaxX = int(MIN(floorf(maxX - 0.5f), float(width - 1)));
+		triangle.MinY = int(MAX(ceilf(minY - 0.5f), 0.f));
+		triangle.MaxY = int(MIN(floorf(maxY - 0.5f), float(height - 1)));
+
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+			return false;
+
+		const float3* vertices[3] = { &v0, &v1, &v2 };
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			const float3& a = *vertices[edge];
+			const float3& b = *vertices[(edge + 1) % 3];
+			triangle.EdgeA[edge] = a.y - b.y;
+			triangle.EdgeB[edge] = b.x - a.x;
+			triangle.EdgeC[edge] = a.x * b.y - a.y * b.x;
+		}
+
+		float invArea = 1.f / area;
+		triangle.DepthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) * invArea;
+		triangle.DepthB = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) * invArea;
+		triangle.DepthC = v0.z - triangle.DepthA * v0.x - triangle.DepthB * v0.y;
+
+		return true;
+	}
+
+	void RasterizeScalar(const ScreenTriangle& triangle, float* depth, unsigned width)
+	{
+		for (int y = triangle.MinY; y <= triangle.MaxY; ++y)
+		{
+			float py = float(y) + 0.5f;
+			float rowEdge[3];
+			for (int edge = 0; edge < 3; ++edge)
+				rowEdge[edge] = triangle.EdgeB[edge] * py + triangle.EdgeC[edge];
+			float rowDepth = triangle.DepthB * py + triangle.DepthC;
+
+			float* row = depth + y * width;
+			for (int x = triangle.MinX; x <= triangle.MaxX; ++x)
+			{
+				float px = float(x) + 0.5f;
+				if (triangle.EdgeA[0] * px + rowEdge[0] < 0.f || triangle.EdgeA[1] * px + rowEdge[1] < 0.f || triangle.EdgeA[2] * px + rowEdge[2] < 0.f)
+					continue;
+
+				float z = triangle.DepthA * px + rowDepth;
+				if (z < row[x])
+					row[x] = z;
+			}
+		}
+	}
+
+#ifdef EQUINOX_SSE2
+	// Four pixels of a row per step. Rows are a multiple of four wide, so aligned steps never leave the buffer.
+	void RasterizeSSE(const ScreenTriangle& triangle, float* depth, unsigned width)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 laneCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 minX = _mm_set1_ps(float(triangle.MinX) + 0.5f);
+		const __m128 maxX = _mm_set1_ps(float(triangle.MaxX) + 0.5f);
+		const __m128 edgeA0 = _mm_set1_ps(triangle.EdgeA[0]);
+		const __m128 edgeA1 = _mm_set1_ps(triangle.EdgeA[1]);
+		const __m128 edgeA2 = _mm_set1_ps(triangle.EdgeA[2]);
+		const __m128 depthA = _mm_set1_ps(triangle.DepthA);
+
+		int startX = triangle.MinX & ~3;
+
+		for (int y = triangle.MinY; y <= triangle.MaxY; ++y)
+		{
+			float py = float(y) + 0.5f;
+			__m128 rowEdge0 = _mm_set1_ps(triangle.EdgeB[0] * py + triangle.EdgeC[0]);
+			__m128 rowEdge1 = _mm_set1_ps(triangle.EdgeB[1] * py + triangle.EdgeC[1]);
+			__m128 rowEdge2 = _mm_set1_ps(triangle.EdgeB[2] * py + triangle.EdgeC[2]);
+			__m128 rowDepth = _mm_set1_ps(triangle.DepthB * py + triangle.DepthC);
+
+			float* row = depth + y * width;
+			for (int x = startX; x <= triangle.MaxX; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps(float(x)), laneCenters);
+
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmple_ps(px, maxX));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, px), rowEdge0), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, px), rowEdge1), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, px), rowEdge2), zero));
+
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 z = _mm_add_ps(_mm_mul_ps(depthA, px), rowDepth);
+				__m128 current = _mm_loadu_ps(row + x);
+				__m128 write = _mm_and_ps(inside, _mm_cmplt_ps(z, current));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(write, z), _mm_andnot_ps(write, current)));
+			}
+		}
+	}
+#endif
+}
+
+OcclusionBuffer::OcclusionBuffer(unsigned width, unsigned height) : _width((MAX(width, 4u) + 3) & ~3u), _height(MAX(height, 1u))
+{
+	_viewProjection = float4x4::identity;
+	_depth.resize(_width * _height, FLT_MAX);
+
+	// Every level halves the previous one until a single texel is left
+	PyramidLevel level;
+	level.Width = _width;
+	level.Height = _height;
+	_pyramid.push_back(level);
+
+	while (level.Width > 1 || level.Height > 1)
+	{
+		level.Width = (level.Width + 1) / 2;
+		level.Height = (level.Height + 1) / 2;
+		level.Min.resize(level.Width * level.Height);
+		level.Max.resize(level.Width * level.Height);
+		_pyramid.push_back(level);
+	}
+}
+
+const char* OcclusionBuffer::GetKernelName(OcclusionKernel kernel)
+{
+#ifdef EQUINOX_SSE2
+	if (kernel != OcclusionKernel::Scalar)
+		return "SSE";
+#endif
+	return "Scalar";
+}
+
+void OcclusionBuffer::Clear(const float4x4& viewProjection)
+{
+	_viewProjection = viewProjection;
+	std::fill(_depth.begin(), _depth.end(), FLT_MAX);
+	_stats = OcclusionStats();
+}
+
+void OcclusionBuffer::RasterizeTriangles(const float4x4& model, const TrianglePack* packs, size_t packCount, OcclusionKernel kernel)
+{
+	float4x4 transform = _viewProjection * model;
+
+	for (size_t i = 0; i < packCount; ++i)
+	{
+		const TrianglePack& pack = packs[i];
+		for (int lane = 0; lane < RAY_TRIANGLE_LANES; ++lane)
+		{
+			float3 v0(pack.V0[0][lane], pack.V0[1][lane], pack.V0[2][lane]);
+			float3 v1 = v0 + float3(pack.Edge1[0][lane], pack.Edge1[1][lane], pack.Edge1[2][lane]);
+			float3 v2 = v0 + float3(pack.Edge2[0][lane], pack.Edge2[1][lane], pack.Edge2[2][lane]);
+
+			float3 s0, s1, s2;
+			if (!project(transform, v0, s0) || !project(transform, v1, s1) || !project(transform, v2, s2))
+				continue;
+
+			// Padding lanes have no area and are dropped here
+			ScreenTriangle triangle;
+			if (!SetupTriangle(s0, s1, s2, _width, _height, triangle))
+				continue;
+
+			++_stats.OccluderTriangles;
+
+#ifdef EQUINOX_SSE2
+			if (kernel != OcclusionKernel::Scalar)
+			{
+				RasterizeSSE(triangle, _depth.data(), _width);
+				continue;
+			}
+#endif
+			RasterizeScalar(triangle, _depth.data(), _width);
+		}
+	}
+}
+
+void OcclusionBuffer::BuildPyramid()
+{
+	for (size_t i = 1; i < _pyramid.size(); ++i)
+	{
+		const PyramidLevel& source = _pyramid[i - 1];
+		PyramidLevel& level = _pyramid[i];
+		const float* sourceMin = i == 1 ? _depth.data() : source.Min.data();
+		const float* sourceMax = i == 1 ? _depth.data() : source.Max.data();
+
+		for (unsigned y = 0; y < level.Height; ++y)
+		{
+			unsigned y0 = y * 2 * source.Width;
+			unsigned y1 = MIN(y * 2 + 1, source.Height - 1) * source.Width;
+
+			for (unsigned x = 0; x < level.Width; ++x)
+			{
+				unsigned x0 = x * 2;
+				unsigned x1 = MIN(x * 2 + 1, source.Width - 1);
+
+				level.Min[y * level.Width + x] = MIN(MIN(sourceMin[y0 + x0], sourceMin[y0 + x1]), MIN(sourceMin[y1 + x0], sourceMin[y1 + x1]));
+				level.Max[y * level.Width + x] = MAX(MAX(sourceMax[y0 + x0], sourceMax[y0 + x1]), MAX(sourceMax[y1 + x0], sourceMax[y1 + x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::IsVisible(const AABB& box)
+{
+	++_stats.Tested;
+
+	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		float3 screen;
+		// A box crossing the eye plane covers the camera, there is nothing to test it against
+		if (!project(_viewProjection, box.CornerPoint(i), screen))
+			return true;
+
+		minX = MIN(minX, screen.x);
+		maxX = MAX(maxX, screen.x);
+		minY = MIN(minY, screen.y);
+		maxY = MAX(maxY, screen.y);
+		minZ = MIN(minZ, screen.z);
+	}
+
+	if (maxX < 0.f || maxY < 0.f || minX >= float(_width) || minY >= float(_height))
+	{
+		++_stats.Culled;
+		return false;
+	}
+
+	unsigned rect[4] = {
+		unsigned(MAX(minX, 0.f)), unsigned(MIN(maxX, float(_width - 1))),
+		unsigned(MAX(minY, 0.f)), unsigned(MIN(maxY, float(_height - 1)))
+	};
+
+	// Start on the finest level where the box spans at most two by two texels
+	unsigned level = 0;
+	while (level + 1 < _pyramid.size() && ((rect[1] >> level) - (rect[0] >> level) > 1 || (rect[3] >> level) - (rect[2] >> level) > 1))
+		++level;
+
+	for (unsigned y = rect[2] >> level; y <= rect[3] >> level; ++y)
+	{
+		for (unsigned x = rect[0] >> level; x <= rect[1] >> level; ++x)
+		{
+			if (isTexelVisible(level, x, y, rect, minZ))
+				return true;
+		}
+	}
+
+	++_stats.Culled;
+	return false;
+}
+
+bool OcclusionBuffer::project(const float4x4& transform, const float3& point, float3& screen) const
+{
+	float w = transform[3][0] * point.x + transform[3][1] * point.y + transform[3][2] * point.z + transform[3][3];
+	if (w < MIN_CLIP_W)
+		return false;
+
+	float x = transform[0][0] * point.x + transform[0][1] * point.y + transform[0][2] * point.z + transform[0][3];
+	float y = transform[1][0] * point.x + transform[1][1] * point.y + transform[1][2] * point.z + transform[1][3];
+	float z = transform[2][0] * point.x + transform[2][1] * point.y + transform[2][2] * point.z + transform[2][3];
+
+	float invW = 1.f / w;
+	screen.x = (x * invW * 0.5f + 0.5f) * _width;
+	screen.y = (y * invW * 0.5f + 0.5f) * _height;
+	screen.z = z * invW;
+
+	return true;
+}
+
+bool OcclusionBuffer::isTexelVisible(unsigned level, unsigned x, unsigned y, const unsigned rect[4], float depth) const
+{
+	const PyramidLevel& current = _pyramid[level];
+	unsigned texel = y * current.Width + x;
+
+	float nearest = level == 0 ? _depth[texel] : current.Min[texel];
+	float farthest = level == 0 ? _depth[texel] : current.Max[texel];
+
+	if (depth > farthest)
+		return false;
+
+	if (depth <= nearest)
+		return true;
+
+	// Partly covered, only the children overlapping the box decide
+	const PyramidLevel& finer = _pyramid[level - 1];
+	unsigned childLevel = level - 1;
+	unsigned minChildX = MAX(x * 2, rect[0] >> childLevel);
+	unsigned maxChildX = MIN(MIN(x * 2 + 1, finer.Width - 1), rect[1] >> childLevel);
+	unsigned minChildY = MAX(y * 2, rect[2] >> childLevel);
+	unsigned maxChildY = MIN(MIN(y * 2 + 1, finer.Height - 1), rect[3] >> childLevel);
+
+	for (unsigned childY = minChildY; childY <= maxChildY; ++childY)
+	{
+		for (unsigned childX = minChildX; childX <= maxChildX; ++childX)
+		{
+			if (isTexelVisible(childLevel, childX, childY, rect, depth))
+				return true;
+		}
+	}
+
+	return false;
+}
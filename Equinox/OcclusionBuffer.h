@@ -0,0 +1,75 @@
+#ifndef __OCCLUSIONBUFFER_H__
+#define __OCCLUSIONBUFFER_H__
+
+#include "RayTriangle.h"
+#include <MathGeoLib/include/Math/float4x4.h>
+#include <MathGeoLib/include/Geometry/AABB.h>
+#include <vector>
+
+#define OCCLUSION_BUFFER_WIDTH 256
+#define OCCLUSION_BUFFER_HEIGHT 128
+
+enum class OcclusionKernel
+{
+	Scalar,
+	SSE,
+	Best
+};
+
+struct OcclusionStats
+{
+	unsigned OccluderTriangles = 0;
+	unsigned Tested = 0;
+	unsigned Culled = 0;
+};
+
+/*
+ * Low resolution depth buffer rasterized on the CPU. Occluders write their nearest depth per texel, then a
+ * min/max pyramid is built on top so a bounding box is resolved against a handful of texels instead of all
+ * the ones it covers. Depths are the z / w of the view projection, smaller is closer.
+ */
+class OcclusionBuffer
+{
+public:
+	// The width is rounded up to a multiple of four for the SIMD kernel
+	OcclusionBuffer(unsigned width = OCCLUSION_BUFFER_WIDTH, unsigned height = OCCLUSION_BUFFER_HEIGHT);
+
+	static const char* GetKernelName(OcclusionKernel kernel);
+
+	// Starts a new frame, nothing is occluded until occluders are drawn
+	void Clear(const float4x4& viewProjection);
+	// Packs are in the space given by the model matrix. Triangles behind the eye are skipped, not clipped.
+	void RasterizeTriangles(const float4x4& model, const TrianglePack* packs, size_t packCount, OcclusionKernel kernel = OcclusionKernel::Best);
+	// Must be called after the occluders are drawn and before testing
+	void BuildPyramid();
+
+	// Conservative, only returns false when the whole box is behind the occluders or off screen
+	bool IsVisible(const AABB& box);
+
+	unsigned GetWidth() const { return _width; }
+	unsigned GetHeight() const { return _height; }
+	const float* GetDepth() const { return _depth.data(); }
+	const OcclusionStats& GetStats() const { return _stats; }
+
+private:
+	struct PyramidLevel
+	{
+		unsigned Width = 0;
+		unsigned Height = 0;
+		std::vector<float> Min; // Empty on level 0, which reads the depth buffer
+		std::vector<float> Max;
+	};
+
+	bool project(const float4x4& transform, const float3& point, float3& screen) const;
+	// The rect is in level 0 texels, depth is the nearest depth of the box
+	bool isTexelVisible(unsigned level, unsigned x, unsigned y, const unsigned rect[4], float depth) const;
+
+	unsigned _width;
+	unsigned _height;
+	float4x4 _viewProjection;
+	std::vector<float> _depth;
+	std::vector<PyramidLevel> _pyramid;
+	OcclusionStats _stats;
+};
+
+#endif // __OCCLUSIONBUFFER_H__
@@ -0,0 +1,51 @@
+#include "ParticleBuffer.h"
+
+#include <cstdint>
+
+void ParticleBuffer::Reserve(unsigned capacity)
+{
+	_size = 0;
+	if (capacity == _capacity && !_storage.empty())
+		return;
+
+	_capacity = capacity;
+
+	// Every stream starts on a 32 byte boundary and is padded to a whole number of lanes
+	unsigned stride = (capacity + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+	_storage.assign(stride * STREAM_COUNT + LANE_WIDTH, 0.f);
+
+	float* base = _storage.data();
+	base += (LANE_WIDTH - (reinterpret_cast<uintptr_t>(base) / sizeof(float)) % LANE_WIDTH) % LANE_WIDTH;
+
+	float** streams[STREAM_COUNT] = { &PositionX, &PositionY, &PositionZ, &VelocityX, &VelocityY, &VelocityZ, &LifeTime };
+	for (unsigned i = 0; i < STREAM_COUNT; ++i)
+		*streams[i] = base + i * stride;
+}
+
+bool ParticleBuffer::Spawn(const float3& position, const float3& velocity, float lifeTime)
+{
+	if (_size == _capacity)
+		return false;
+
+	unsigned index = _size++;
+	PositionX[index] = position.x;
+	PositionY[index] = position.y;
+	PositionZ[index] = position.z;
+	VelocityX[index] = velocity.x;
+	VelocityY[index] = velocity.y;
+	VelocityZ[index] = velocity.z;
+	LifeTime[index] = lifeTime;
+	return true;
+}
+
+void ParticleBuffer::Kill(unsigned index)
+{
+	unsigned last = --_size;
+	PositionX[index] = PositionX[last];
+	PositionY[index] = PositionY[last];
+	PositionZ[index] = PositionZ[last];
+	VelocityX[index] = VelocityX[last];
+	VelocityY[index] = VelocityY[last];
+	VelocityZ[index] = VelocityZ[last];
+	LifeTime[index] = LifeTime[last];
+}
@@ -0,0 +1,43 @@
+#ifndef __PARTICLEBUFFER_H__
+#define __PARTICLEBUFFER_H__
+
+#include <MathGeoLib/include/Math/float3.h>
+#include <vector>
+
+/*
+ * Fixed capacity structure of arrays particle storage. Live particles are always packed at the
+ * front of the arrays, dead ones are swap-removed, so the buffer never allocates after Reserve.
+ */
+class ParticleBuffer
+{
+public:
+	// Arrays are padded up to this many floats so vector kernels can run past the last particle
+	static const unsigned LANE_WIDTH = 8;
+
+	void Reserve(unsigned capacity);
+	void Clear() { _size = 0; }
+
+	bool Spawn(const float3& position, const float3& velocity, float lifeTime);
+	void Kill(unsigned index);
+
+	unsigned Size() const { return _size; }
+	unsigned Capacity() const { return _capacity; }
+	unsigned Free() const { return _capacity - _size; }
+
+	float* PositionX = nullptr;
+	float* PositionY = nullptr;
+	float* PositionZ = nullptr;
+	float* VelocityX = nullptr;
+	float* VelocityY = nullptr;
+	float* VelocityZ = nullptr;
+	float* LifeTime = nullptr;
+
+private:
+	static const unsigned STREAM_COUNT = 7;
+
+	std::vector<float> _storage;
+	unsigned _size = 0;
+	unsigned _capacity = 0;
+};
+
+#endif // __PARTICLEBUFFER_H__
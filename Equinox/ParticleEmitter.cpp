@@ -4,8 +4,12 @@
 #include "CameraComponent.h"
 
 #include <GL/glew.h>
+#include <cstddef>
 #include "IMGUI/imgui.h"
 #include "ModuleCameraManager.h"
+#include "ModuleTextures.h"
+#include "ModuleParticles.h"
+#include "ModuleRender.h"
 
 ParticleEmitter::ParticleEmitter(int MaxParticles, float2 EmitArea, float FallHeight, float FallSpeed, float LifeTime)
 {
@@ -22,35 +26,28 @@ ParticleEmitter::ParticleEmitter(int MaxParticles, float2 EmitArea, float FallHe
 	_controlLifeTime = LifeTime;
 
 	_cameraManager = App->GetModule<ModuleCameraManager>();
+	_moduleTextures = App->GetModule<ModuleTextures>();
+	_moduleParticles = App->GetModule<ModuleParticles>();
+
+	_particles.Reserve(MAX(MaxParticles, 0));
+	_random.Seed(Seed);
+
+	_moduleParticles->AddEmitter(this);
 }
 
 ParticleEmitter::~ParticleEmitter()
 {
+	_moduleParticles->RemoveEmitter(this);
+	_moduleTextures->Release(_texture);
+
+	if (_vertexBuffer != 0)
+		App->GetModule<ModuleRender>()->GetDevice()->DeleteBuffer(_vertexBuffer);
 }
 
 void ParticleEmitter::Update(float dt)
 {
-	checkValues();
-
-	generateParticles();
-
-	for (Particle* particle : ParticlePool)
-	{
-		if (particle->IsAlive)
-		{
-			drawParticle(particle);
-
-			// Update particle position & time;
-			particle->Position = particle->Position + particle->Velocity * dt;
-			particle->LifeTime -= dt;
-
-			// When lifetime finish, kill particle
-			if (particle->LifeTime < dt)
-			{
-				particle->IsAlive = false;
-			}
-		}
-	}
+	MEMORY_TAG_SCOPE(MemoryTag::Particles);
+	drawParticles();
 }
 
 void ParticleEmitter::EditorUpdate(float dt)
@@ -59,104 +56,153 @@ void ParticleEmitter::EditorUpdate(float dt)
 		Update(dt);
 }
 
+bool ParticleEmitter::IsSimulating() const
+{
+	return Enabled && (App->GetUpdateState() == Engine::UpdateState::Playing || _editorSimulation);
+}
+
+void ParticleEmitter::BeginPlay()
+{
+	// Every play session starts from the seed so the simulation is reproducible
+	CleanUp();
+}
+
 void ParticleEmitter::EndPlay()
 {
 	CleanUp();
 }
 
-void ParticleEmitter::SetTexture(unsigned textureId)
+void ParticleEmitter::SetTexture(TextureHandle texture)
 {
-	_texture = textureId;
+	_moduleTextures->AddRef(texture);
+	_moduleTextures->Release(_texture);
+	_texture = texture;
+
+	// The GL texture may be a shared atlas page, so the size comes from the texture itself
+	unsigned width = 1, height = 1;
+	_moduleTextures->GetTextureSize(texture, width, height);
+	_uvTransform = _moduleTextures->GetUVTransform(texture);
 
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glGetTexLevelParameterfv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &_width);
-	glGetTexLevelParameterfv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &_height);
-	float ratio = _width / _height;
+	float ratio = float(width) / float(height);
 	_width = ratio;
 	_height = 1;
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-void ParticleEmitter::drawParticle(Particle* particle)
+void ParticleEmitter::drawParticles()
 {
+	if (_particles.Size() == 0)
+		return;
+
+	float3 up, right;
+	ComputeQuad(*_cameraManager->GetMainCamera(), up, right);
+
+	buildVertices(up * _height * 0.5f, right * _width * 0.5f);
+
+	// Created on the device that submits the frame, the one of the thread may only be recording it
+	if (_vertexBuffer == 0)
+		_vertexBuffer = App->GetModule<ModuleRender>()->GetDevice()->CreateBuffer(BufferTarget::Vertices, nullptr, 0);
+
+	// Orphan the previous contents so the driver does not stall on last frame's draw
+	size_t bufferSize = _vertices.size() * sizeof(ParticleVertex);
+	RenderDevice* device = RenderDevice::Current();
+	device->StreamBuffer(BufferTarget::Vertices, _vertexBuffer, _vertices.data(), bufferSize);
+
 	// Enable for billboards
-	glDisable(GL_LIGHTING);
-	glEnable(GL_ALPHA_TEST);
-	glAlphaFunc(GL_GREATER, 0.1f);
-	glEnable(GL_BLEND);
+	device->SetState(RenderState::Lighting, false);
+	device->SetState(RenderState::AlphaTest, true);
+	device->SetAlphaReference(0.1f);
+	device->SetState(RenderState::Blend, true);
 
-	glColor3f(1.f, 1.f, 1.f);
+	device->SetColor(float4(1.f, 1.f, 1.f, 1.f));
 
-	float3 up, right;
-	ComputeQuad(*_cameraManager->GetMainCamera(), up, right, particle);
-	//right = float3::unitZ; 
-
-	float3 position = particle->Position;
-
-	float halfX = (_height * 0.5f) / _height;
-	float halfY = (_width * 0.5f) / _width;
-	float3 vertex1 = (position + up * _height * 0.5f) + (right * _width * 0.5f);
-	float3 vertex2 = (position - up * _height * 0.5f) - (right * _width * 0.5f);
-	float3 vertex3 = (position - up * _height * 0.5f) + (right * _width * 0.5f);
-	float3 vertex4 = (position + up * _height * 0.5f) - (right * _width * 0.5f);
-
-	glBindTexture(GL_TEXTURE_2D, _texture);
-
-	glBegin(GL_TRIANGLES);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex1));
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex2));
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex3));
-
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex1));
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex4));
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex3fv(reinterpret_cast<GLfloat*>(&vertex2));
-	glEnd();
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	glDisable(GL_ALPHA_TEST);
-	glEnable(GL_LIGHTING);
+	device->BindTexture(0, _moduleTextures->GetTextureId(_texture));
+	_moduleTextures->Touch(_texture);
+
+	device->SetVertexArray(VertexArray::Position, true);
+	device->SetVertexArray(VertexArray::TextureCoords, true);
+	device->SetVertexPointer(VertexArray::Position, 3, sizeof(ParticleVertex), offsetof(ParticleVertex, Position));
+	device->SetVertexPointer(VertexArray::TextureCoords, 2, sizeof(ParticleVertex), offsetof(ParticleVertex, UV));
+
+	device->DrawArrays(PrimitiveType::Triangles, 0, unsigned(_vertices.size()));
+
+	device->SetVertexArray(VertexArray::TextureCoords, false);
+	device->SetVertexArray(VertexArray::Position, false);
+	device->BindBuffer(BufferTarget::Vertices, 0);
+
+	device->BindTexture(0, 0);
+
+	device->SetState(RenderState::Blend, false);
+	device->SetState(RenderState::AlphaTest, false);
+	device->SetState(RenderState::Lighting, true);
 }
 
-void ParticleEmitter::generateParticles()
+void ParticleEmitter::buildVertices(const float3& halfUp, const float3& halfRight)
 {
-	int particlesToGen = MaxParticles / LifeTime;
-
-	for (int i = 0; i < particlesToGen; ++i)
+	// Every particle shares the emitter orientation, so the corner offsets are computed once
+	const float3 corner1 = halfUp + halfRight;
+	const float3 corner2 = -halfUp - halfRight;
+	const float3 corner3 = -halfUp + halfRight;
+	const float3 corner4 = halfUp - halfRight;
+
+	const float2 uv1(_uvTransform.z, _uvTransform.w + _uvTransform.y);
+	const float2 uv2(_uvTransform.z + _uvTransform.x, _uvTransform.w);
+	const float2 uv3(_uvTransform.z, _uvTransform.w);
+	const float2 uv4(_uvTransform.z + _uvTransform.x, _uvTransform.w + _uvTransform.y);
+
+	unsigned count = _particles.Size();
+	_vertices.resize(count * 6);
+
+	ParticleVertex* vertex = _vertices.data();
+	for (unsigned i = 0; i < count; ++i)
 	{
-		Particle* particle = new Particle;
+		float3 position(_particles.PositionX[i], _particles.PositionY[i], _particles.PositionZ[i]);
+
+		vertex[0].Position = position + corner1; vertex[0].UV = uv1;
+		vertex[1].Position = position + corner2; vertex[1].UV = uv2;
+		vertex[2].Position = position + corner3; vertex[2].UV = uv3;
+		vertex[3].Position = position + corner1; vertex[3].UV = uv1;
+		vertex[4].Position = position + corner4; vertex[4].UV = uv4;
+		vertex[5].Position = position + corner2; vertex[5].UV = uv2;
+		vertex += 6;
+	}
+}
 
-		particle->IsAlive = true;
+void ParticleEmitter::generateParticles(float dt)
+{
+	if (LifeTime <= 0.f)
+		return;
 
-		float rand_x = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / EmitArea.x));
-		float rand_z = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / EmitArea.y));
+	// Emit at a steady rate that keeps MaxParticles alive, carrying the fractional part to the next frame
+	_emitAccumulator += MaxParticles / LifeTime * dt;
+	unsigned particlesToGen = unsigned(_emitAccumulator);
+	_emitAccumulator -= particlesToGen;
 
-		particle->Position = float3(rand_x, FallHeight, rand_z);
-		particle->Velocity = float3(0.0f, -FallSpeed, 0.0f);
+	particlesToGen = MIN(particlesToGen, _particles.Free());
 
-		particle->LifeTime = LifeTime;
+	// Draw the coordinates of the whole batch at once, x and z interleaved
+	_emitRandoms.resize(particlesToGen * 2);
+	_random.NextFloats(_emitRandoms.data(), particlesToGen * 2);
 
-		ParticlePool.push_back(particle);
-	}
+	for (unsigned i = 0; i < particlesToGen; ++i)
+	{
+		float rand_x = _emitRandoms[i * 2] * EmitArea.x;
+		float rand_z = _emitRandoms[i * 2 + 1] * EmitArea.y;
 
+		_particles.Spawn(float3(rand_x, FallHeight, rand_z), float3(0.0f, -FallSpeed, 0.0f), LifeTime);
+	}
+}
 
+void ParticleEmitter::Emit(float dt)
+{
+	checkValues();
+	generateParticles(dt);
 }
 
 void ParticleEmitter::CleanUp()
 {
-	for (Particle* particle : ParticlePool)
-	{
-		RELEASE(particle);
-	}
-
-	ParticlePool.clear();
+	_particles.Clear();
+	_emitAccumulator = 0.f;
+	_random.Seed(Seed);
 }
 
 void ParticleEmitter::checkValues()
@@ -175,14 +221,17 @@ void ParticleEmitter::checkValues()
 		_controlLifeTime = LifeTime;
 
 		CleanUp();
+		_particles.Reserve(MAX(MaxParticles, 0));
 	}
 
 }
 
-void ParticleEmitter::ComputeQuad(const CameraComponent& camera, float3& up, float3& right, Particle* particle) const
+void ParticleEmitter::ComputeQuad(const CameraComponent& camera, float3& up, float3& right) const
 {
-	float3 position = particle->Position;
+	// Billboards rotate around the Y axis to face the camera view plane
 	up = float3::unitY;
-	right = (position - camera.Position()).Normalized().Cross(up);
+	right = camera.Orientation().Cross(up);
+	if (right.LengthSq() < 1e-6f)
+		right = float3::unitX;
 	right.Normalize();
 }
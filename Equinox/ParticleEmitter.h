@@ -1,21 +1,18 @@
 ﻿#ifndef __PARTICLE_EMITTER_H__
 #define __PARTICLE_EMITTER_H__
 #include "BaseComponent.h"
+#include "ResourcePool.h"
+#include "ParticleBuffer.h"
+#include "Random.h"
 #include <MathGeoLib/include/Math/float2.h>
+#include <MathGeoLib/include/Math/float4.h>
 
 class CameraComponent;
 
-struct Particle
-{
-	float3 Position;
-	float3 Velocity;
-	float LifeTime;
-	bool IsAlive = false;
-};
-
 class ParticleEmitter : public BaseComponent
 {
 	DEFINE_COMPONENT(ParticleEmitter);
+	friend class ModuleParticles;
 public:
 	ParticleEmitter(int MaxParticles, float2 EmitArea, float FallHeight, float FallSpeed, float LifeTime);
 	~ParticleEmitter();
@@ -23,12 +20,17 @@ public:
 	void Update(float dt) override;
 	void EditorUpdate(float dt) override;
 
+	void BeginPlay() override;
 	void EndPlay() override;
 	void CleanUp() override;
 
-	void SetTexture(unsigned textureId);
+	void SetTexture(TextureHandle texture);
+
+	// Simulation happens in ModuleParticles while playing, or in the editor when it is previewed
+	bool IsSimulating() const;
+
+	const ParticleBuffer& GetParticles() const { return _particles; }
 
-	std::vector<Particle*> ParticlePool;
 	float2 EmitArea;
 	int MaxParticles;
 
@@ -36,12 +38,30 @@ public:
 	float FallSpeed;
 	float LifeTime;
 
+	unsigned Seed = 1; // Emission restarts from this seed every time the emitter is reset
+
 private:
-	void drawParticle(Particle* particle);
-	void generateParticles();
+	struct ParticleVertex
+	{
+		float3 Position;
+		float2 UV;
+	};
+
+	void drawParticles();
+	void buildVertices(const float3& halfUp, const float3& halfRight);
+	void Emit(float dt);
+	void generateParticles(float dt);
 	void checkValues();
 
-	void ComputeQuad(const CameraComponent& camera, float3& up, float3& right, Particle* particle) const;
+	void ComputeQuad(const CameraComponent& camera, float3& up, float3& right) const;
+
+	ParticleBuffer _particles;
+	float _emitAccumulator = 0.f;
+	Random _random;
+	std::vector<float> _emitRandoms;
+
+	std::vector<ParticleVertex> _vertices;
+	unsigned _vertexBuffer = 0;
 
 	float2 _controlEmitArea;
 	int _controlMaxParticles;
@@ -50,12 +70,15 @@ private:
 	float _controlFallSpeed;
 	float _controlLifeTime;
 
-	unsigned _texture = 0;
+	TextureHandle _texture;
+	float4 _uvTransform = float4(1.f, 1.f, 0.f, 0.f);
 	float _width, _height;
 
 	bool _editorSimulation = false;
 
 	std::shared_ptr<class ModuleCameraManager> _cameraManager;
+	std::shared_ptr<class ModuleTextures> _moduleTextures;
+	std::shared_ptr<class ModuleParticles> _moduleParticles;
 };
 
 #endif
@@ -0,0 +1,183 @@
+#include "ParticleSimulation.h"
+#include "ParticleBuffer.h"
+#include "SimdConfig.h"
+
+namespace
+{
+	void IntegrateScalar(ParticleBuffer& particles, unsigned begin, unsigned end, float dt)
+	{
+		for (unsigned i = begin; i < end; ++i)
+		{
+			particles.PositionX[i] += particles.VelocityX[i] * dt;
+			particles.PositionY[i] += particles.VelocityY[i] * dt;
+			particles.PositionZ[i] += particles.VelocityZ[i] * dt;
+			particles.LifeTime[i] -= dt;
+		}
+	}
+
+	void CompactScalar(ParticleBuffer& particles)
+	{
+		unsigned i = 0;
+		while (i < particles.Size())
+		{
+			// The last particle takes the place of the dead one, so the same index is checked again
+			if (particles.LifeTime[i] <= 0.f)
+				particles.Kill(i);
+			else
+				++i;
+		}
+	}
+
+#ifdef EQUINOX_SSE2
+	unsigned IntegrateSSE(ParticleBuffer& particles, unsigned begin, unsigned end, float dt)
+	{
+		const __m128 delta = _mm_set1_ps(dt);
+
+		unsigned i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 positionX = _mm_load_ps(particles.PositionX + i);
+			__m128 positionY = _mm_load_ps(particles.PositionY + i);
+			__m128 positionZ = _mm_load_ps(particles.PositionZ + i);
+			__m128 lifeTime = _mm_load_ps(particles.LifeTime + i);
+
+			positionX = _mm_add_ps(positionX, _mm_mul_ps(_mm_load_ps(particles.VelocityX + i), delta));
+			positionY = _mm_add_ps(positionY, _mm_mul_ps(_mm_load_ps(particles.VelocityY + i), delta));
+			positionZ = _mm_add_ps(positionZ, _mm_mul_ps(_mm_load_ps(particles.VelocityZ + i), delta));
+			lifeTime = _mm_sub_ps(lifeTime, delta);
+
+			_mm_store_ps(particles.PositionX + i, positionX);
+			_mm_store_ps(particles.PositionY + i, positionY);
+			_mm_store_ps(particles.PositionZ + i, positionZ);
+			_mm_store_ps(particles.LifeTime + i, lifeTime);
+		}
+
+		return i;
+	}
+
+	// Tests four lifetimes at once and only falls back to single particles for the groups with a dead one
+	void CompactSSE(ParticleBuffer& particles)
+	{
+		const __m128 zero = _mm_setzero_ps();
+
+		unsigned i = 0;
+		while (i < particles.Size())
+		{
+			unsigned remaining = particles.Size() - i;
+			int validLanes = remaining >= 4 ? 0xF : (1 << remaining) - 1;
+			int deadMask = _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(particles.LifeTime + i), zero)) & validLanes;
+
+			if (deadMask == 0)
+			{
+				i += 4;
+				continue;
+			}
+
+			unsigned lane = 0;
+			while ((deadMask & (1 << lane)) == 0)
+				++lane;
+
+			particles.Kill(i + lane);
+		}
+	}
+#endif
+
+#ifdef EQUINOX_AVX
+	unsigned IntegrateAVX(ParticleBuffer& particles, unsigned begin, unsigned end, float dt)
+	{
+		const __m256 delta = _mm256_set1_ps(dt);
+
+		unsigned i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 positionX = _mm256_load_ps(particles.PositionX + i);
+			__m256 positionY = _mm256_load_ps(particles.PositionY + i);
+			__m256 positionZ = _mm256_load_ps(particles.PositionZ + i);
+			__m256 lifeTime = _mm256_load_ps(particles.LifeTime + i);
+
+			positionX = _mm256_add_ps(positionX, _mm256_mul_ps(_mm256_load_ps(particles.VelocityX + i), delta));
+			positionY = _mm256_add_ps(positionY, _mm256_mul_ps(_mm256_load_ps(particles.VelocityY + i), delta));
+			positionZ = _mm256_add_ps(positionZ, _mm256_mul_ps(_mm256_load_ps(particles.VelocityZ + i), delta));
+			lifeTime = _mm256_sub_ps(lifeTime, delta);
+
+			_mm256_store_ps(particles.PositionX + i, positionX);
+			_mm256_store_ps(particles.PositionY + i, positionY);
+			_mm256_store_ps(particles.PositionZ + i, positionZ);
+			_mm256_store_ps(particles.LifeTime + i, lifeTime);
+		}
+
+		return i;
+	}
+#endif
+
+	SimulationKernel ResolveKernel(SimulationKernel kernel)
+	{
+#if defined(EQUINOX_AVX)
+		const SimulationKernel best = SimulationKernel::AVX;
+#elif defined(EQUINOX_SSE2)
+		const SimulationKernel best = SimulationKernel::SSE;
+#else
+		const SimulationKernel best = SimulationKernel::Scalar;
+#endif
+		// Kernels that are not compiled in degrade to the best one that is
+		return kernel == SimulationKernel::Best || kernel > best ? best : kernel;
+	}
+}
+
+const char* ParticleSimulation::GetKernelName(SimulationKernel kernel)
+{
+	switch (ResolveKernel(kernel))
+	{
+	case SimulationKernel::AVX:
+		return "AVX";
+	case SimulationKernel::SSE:
+		return "SSE";
+	default:
+		return "Scalar";
+	}
+}
+
+void ParticleSimulation::Integrate(ParticleBuffer& particles, float dt, SimulationKernel kernel)
+{
+	Integrate(particles, 0, particles.Size(), dt, kernel);
+}
+
+void ParticleSimulation::Integrate(ParticleBuffer& particles, unsigned begin, unsigned end, float dt, SimulationKernel kernel)
+{
+	// Vector kernels use aligned loads, so ranges have to start on a lane boundary
+	unsigned i = begin;
+	switch (ResolveKernel(kernel))
+	{
+#ifdef EQUINOX_AVX
+	case SimulationKernel::AVX:
+		i = IntegrateAVX(particles, i, end, dt);
+		// The remaining particles still fit in SSE registers
+#endif
+#ifdef EQUINOX_SSE2
+	case SimulationKernel::SSE:
+		i = IntegrateSSE(particles, i, end, dt);
+#endif
+	default:
+		IntegrateScalar(particles, i, end, dt);
+		break;
+	}
+}
+
+void ParticleSimulation::CompactDead(ParticleBuffer& particles, SimulationKernel kernel)
+{
+#ifdef EQUINOX_SSE2
+	if (ResolveKernel(kernel) != SimulationKernel::Scalar)
+	{
+		CompactSSE(particles);
+		return;
+	}
+#endif
+
+	CompactScalar(particles);
+}
+
+void ParticleSimulation::Simulate(ParticleBuffer& particles, float dt, SimulationKernel kernel)
+{
+	Integrate(particles, dt, kernel);
+	CompactDead(particles, kernel);
+}
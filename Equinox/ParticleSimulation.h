@@ -0,0 +1,29 @@
+#ifndef __PARTICLESIMULATION_H__
+#define __PARTICLESIMULATION_H__
+
+class ParticleBuffer;
+
+enum class SimulationKernel
+{
+	Scalar,
+	SSE,
+	AVX,
+	Best // Widest kernel available in this build
+};
+
+/*
+ * Particle integration kernels over the SoA arrays of a ParticleBuffer. Integration advances
+ * positions and lifetimes for every lane, compaction swap-removes the particles whose lifetime ended.
+ */
+namespace ParticleSimulation
+{
+	const char* GetKernelName(SimulationKernel kernel);
+
+	void Integrate(ParticleBuffer& particles, float dt, SimulationKernel kernel = SimulationKernel::Best);
+	void Integrate(ParticleBuffer& particles, unsigned begin, unsigned end, float dt, SimulationKernel kernel = SimulationKernel::Best);
+	void CompactDead(ParticleBuffer& particles, SimulationKernel kernel = SimulationKernel::Best);
+
+	void Simulate(ParticleBuffer& particles, float dt, SimulationKernel kernel = SimulationKernel::Best);
+}
+
+#endif // __PARTICLESIMULATION_H__
@@ -1,8 +1,8 @@
 #include "Plane.h"
-#include <GL/glew.h>
 #include <MathGeoLib/include/Math/float3.h>
 #include <MathGeoLib/include/Math/MathFunc.h>
 #include "Globals.h"
+#include <MathGeoLib/include/Math/float4x4.h>
 
 
 ::Plane::Plane(float planeSize) :
@@ -18,40 +18,52 @@
 
 void ::Plane::Draw()
 {
-	GLboolean light = glIsEnabled(GL_LIGHTING);
-	glDepthMask(GL_FALSE);
-	glDisable(GL_LIGHTING);
+	RenderDevice* device = RenderDevice::Current();
+	bool light = device->IsEnabled(RenderState::Lighting);
+	device->SetDepthWrite(false);
+	device->SetState(RenderState::Lighting, false);
+	device->PushMatrix();
 
-	glPushMatrix();
-	glTranslatef(Position.x, Position.y, Position.z);
-	float3 axis = Rotation.Axis();
-	glRotatef(RadToDeg(Rotation.Angle()), axis.x, axis.y, axis.z);
+	device->MultMatrix(float4x4::FromTRS(Position, Rotation, float3::one));
 
-	glColor4f(Color.x, Color.y, Color.z, 0.f);
+	float3 quad[4] = {
+		float3(-PlaneSize, -0.001f, -PlaneSize),
+		float3(-PlaneSize, -0.001f, PlaneSize),
+		float3(PlaneSize, -0.001f, PlaneSize),
+		float3(PlaneSize, -0.001f, -PlaneSize)
+	};
+
+	device->SetColor(float4(Color.x, Color.y, Color.z, 0.f));
+	device->DrawVertices(PrimitiveType::Quads, quad, 4);
 
-	glBegin(GL_QUADS);
-	glVertex3f(-PlaneSize, -0.001f, -PlaneSize);
-	glVertex3f(-PlaneSize, -0.001f, PlaneSize);
-	glVertex3f(PlaneSize, -0.001f, PlaneSize);
-	glVertex3f(PlaneSize, -0.001f, -PlaneSize);
-	glEnd();
+	// The first line of each direction is tinted, the rest of the grid is grey
+	float3 firstX[2] = { float3(-PlaneSize, 0.f, -PlaneSize), float3(-PlaneSize, 0.f, PlaneSize) };
+	float3 firstZ[2] = { float3(-PlaneSize, 0.f, -PlaneSize), float3(PlaneSize, 0.f, -PlaneSize) };
 
-	glBegin(GL_LINES);
+	_grid.clear();
 	for (int i = int(-PlaneSize); i <= int(PlaneSize); i++) {
-		if (i == -PlaneSize) { glColor3f(.6f, .3f, .3f); }
-		else { glColor3f(.25f, .25f, .25f); };
-		glVertex3f(float(i), 0.f, -PlaneSize);
-		glVertex3f(float(i), 0.f, PlaneSize);
-		if (i == -PlaneSize) { glColor3f(.3f, .3f, .6f); }
-		else { glColor3f(.25f, .25f, .25f); };
-		glVertex3f(-PlaneSize, 0.f, float(i));
-		glVertex3f(PlaneSize, 0.f, float(i));
+		if (i == -PlaneSize)
+			continue;
+		_grid.push_back(float3(float(i), 0.f, -PlaneSize));
+		_grid.push_back(float3(float(i), 0.f, PlaneSize));
+		_grid.push_back(float3(-PlaneSize, 0.f, float(i)));
+		_grid.push_back(float3(PlaneSize, 0.f, float(i)));
 	};
-	glEnd();
-	glPopMatrix();
 
-	glDepthMask(GL_TRUE);
+	if (int(-PlaneSize) == -PlaneSize)
+	{
+		device->SetColor(float4(.6f, .3f, .3f, 1.f));
+		device->DrawVertices(PrimitiveType::Lines, firstX, 2);
+		device->SetColor(float4(.3f, .3f, .6f, 1.f));
+		device->DrawVertices(PrimitiveType::Lines, firstZ, 2);
+	}
+
+	device->SetColor(float4(.25f, .25f, .25f, 1.f));
+	device->DrawVertices(PrimitiveType::Lines, _grid.data(), _grid.size());
+
+	device->PopMatrix();
+	device->SetDepthWrite(true);
 
 	if (light)
-		glEnable(GL_LIGHTING);
+		device->SetState(RenderState::Lighting, true);
 }
@@ -2,6 +2,8 @@
 #define __PLANE_H__
 
 #include "Primitive.h"
+#include <MathGeoLib/include/Math/float3.h>
+#include <vector>
 
 class Plane : 
 	public Primitive
@@ -15,6 +17,9 @@ public:
 	void Draw() override;
 
 	float PlaneSize;
+
+private:
+	std::vector<float3> _grid; // Kept between frames to reuse the allocation
 };
 
 #endif // __PLANE_H__
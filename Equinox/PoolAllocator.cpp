@@ -0,0 +1,55 @@
+#include "PoolAllocator.h"
+#include "Globals.h"
+
+#include <cassert>
+
+PoolAllocator::PoolAllocator(size_t slotSize, size_t slotsPerChunk) : _slotsPerChunk(slotsPerChunk)
+{
+	// Slots must hold the free list link and keep the objects 16 byte aligned
+	_slotSize = (MAX(slotSize, sizeof(FreeSlot)) + 15) & ~size_t(15);
+}
+
+PoolAllocator::~PoolAllocator()
+{
+	assert(_usedSlots == 0 && "Pool destroyed while slots are still in use");
+
+	for (char* chunk : _chunks)
+		RELEASE_ARRAY(chunk);
+}
+
+void* PoolAllocator::Allocate(size_t size)
+{
+	assert(size <= _slotSize && "Allocation does not fit in the pool slots");
+
+	if (_freeList == nullptr)
+		allocateChunk();
+
+	FreeSlot* slot = _freeList;
+	_freeList = slot->Next;
+	++_usedSlots;
+	return slot;
+}
+
+void PoolAllocator::Free(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+	slot->Next = _freeList;
+	_freeList = slot;
+	--_usedSlots;
+}
+
+void PoolAllocator::allocateChunk()
+{
+	char* chunk = new char[_slotSize * _slotsPerChunk];
+	_chunks.push_back(chunk);
+
+	for (size_t i = _slotsPerChunk; i > 0; --i)
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + (i - 1) * _slotSize);
+		slot->Next = _freeList;
+		_freeList = slot;
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef __POOLALLOCATOR_H__
+#define __POOLALLOCATOR_H__
+
+#include "Allocator.h"
+#include <vector>
+
+/*
+ * Fixed size slots carved from chunks, freed slots are kept in an intrusive free list
+ * so allocating and freeing are O(1) and the chunks are only returned when the pool dies.
+ */
+class PoolAllocator : public Allocator
+{
+public:
+	PoolAllocator(size_t slotSize, size_t slotsPerChunk = 64);
+	~PoolAllocator();
+
+	PoolAllocator(const PoolAllocator&) = delete;
+	PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+	void* Allocate(size_t size) override;
+	void Free(void* ptr) override;
+
+	size_t GetSlotSize() const { return _slotSize; }
+	size_t GetUsedSlots() const { return _usedSlots; }
+	size_t GetReservedBytes() const { return _chunks.size() * _slotSize * _slotsPerChunk; }
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* Next;
+	};
+
+	void allocateChunk();
+
+	size_t _slotSize;
+	size_t _slotsPerChunk;
+	std::vector<char*> _chunks;
+	FreeSlot* _freeList = nullptr;
+	size_t _usedSlots = 0;
+};
+
+#endif // __POOLALLOCATOR_H__
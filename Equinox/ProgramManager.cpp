@@ -1,6 +1,7 @@
 ﻿#include "Globals.h"
 #include "Engine.h"
 #include "ProgramManager.h"
+#include "ModuleRender.h"
 
 ProgramManager::ProgramManager()
 {
@@ -14,6 +15,13 @@ ProgramManager::~ProgramManager()
 
 bool ProgramManager::Start()
 {
+	// Meshes without their program fall back to the fixed pipeline and CPU skinning
+	if (!App->GetModule<ModuleRender>()->GetDevice()->HasContext())
+	{
+		LOG("No GL context, shaders are not compiled");
+		return true;
+	}
+
 	std::shared_ptr<ShaderProgram> unlit = CreateProgram("Unlit");
 
 	AddShaderToProgram(unlit, "Shaders/SimpleVertexShader.ver", GL_VERTEX_SHADER);
@@ -21,6 +29,14 @@ bool ProgramManager::Start()
 
 	CompileAndAttachProgramShaders(unlit);
 
+	std::shared_ptr<ShaderProgram> skinned = CreateProgram("Skinned");
+
+	AddShaderToProgram(skinned, "Shaders/SimpleVertexShader.ver", GL_VERTEX_SHADER, { "#define SKINNING\n" });
+	AddShaderToProgram(skinned, "Shaders/SimpleFragmentShader.frag", GL_FRAGMENT_SHADER, { "#define TEXTURE\n" });
+
+	if (!CompileAndAttachProgramShaders(skinned))
+		LOG("Skinned shader is not available, skinned meshes will be skinned on the CPU");
+
 	return true;
 }
 
@@ -105,7 +121,7 @@ bool ProgramManager::UseProgram(std::shared_ptr<ShaderProgram> program) const
 {
 	if (program != nullptr)
 	{
-		glUseProgram(program->id);
+		RenderDevice::Current()->UseProgram(program->id);
 		return true;
 	}
 	return false;
@@ -113,7 +129,7 @@ bool ProgramManager::UseProgram(std::shared_ptr<ShaderProgram> program) const
 
 void ProgramManager::UseDefaultProgram() const
 {
-	glUseProgram(0);
+	RenderDevice::Current()->UseProgram(0);
 }
 
 bool ProgramManager::UseProgram(const std::string &name) const
@@ -197,6 +213,7 @@ bool ProgramManager::CompileAndAttachProgramShaders(std::shared_ptr<ShaderProgra
 	else
 	{
 		LOG("PROGRAM LINKED: OK");
+		program->linked = true;
 		return true;
 	}
 	return true;
@@ -8,6 +8,7 @@ struct ShaderProgram
 {
 	GLuint id;
 	std::list<GLuint> shaders;
+	bool linked = false;
 };
 
 class ProgramManager : public Module
@@ -3,6 +3,7 @@
 
 #include <MathGeoLib/include/Geometry/AABB.h>
 #include "GameObject.h"
+#include <algorithm>
 
 #define MAX_BUCKET_SIZE 8
 
@@ -34,6 +35,20 @@ public:
 		}
 	}
 
+	// The object must still have the bounding box it was inserted with
+	void Remove(const GameObject* gameObject)
+	{
+		if (box.Intersects(gameObject->BoundingBox))
+		{
+			std::vector<GameObject*>::iterator it = std::find(bucket.begin(), bucket.end(), gameObject);
+			if (it != bucket.end())
+				bucket.erase(it);
+
+			for (QuadtreeNode* child : childs)
+				child->Remove(gameObject);
+		}
+	}
+
 	template<typename TYPE>
 	void CollectIntersections(std::vector<GameObject*> &objects, const TYPE& primitive) const
 	{
@@ -129,9 +144,9 @@ public:
 		root->Insert(gameObject);
 	}
 
-	void Remove(GameObject* gameObject)
+	void Remove(const GameObject* gameObject)
 	{
-		
+		root->Remove(gameObject);
 	}
 
 	template<typename TYPE>
@@ -140,6 +155,17 @@ public:
 		root->CollectIntersections(objects, primitive);
 	}
 
+	// Objects spanning several nodes come back once per node from CollectIntersections, this appends each only once
+	template<typename TYPE>
+	void CollectUniqueIntersections(std::vector<GameObject*> &objects, const TYPE& primitive) const
+	{
+		size_t first = objects.size();
+		root->CollectIntersections(objects, primitive);
+
+		std::sort(objects.begin() + first, objects.end());
+		objects.erase(std::unique(objects.begin() + first, objects.end()), objects.end());
+	}
+
 	const QuadtreeNode& GetRootNode() const
 	{
 		return *root;
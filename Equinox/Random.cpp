@@ -0,0 +1,128 @@
+#include "Random.h"
+#include "SimdConfig.h"
+
+#define FLOAT_SCALE (1.f / 16777216.f) // 24 bit mantissa
+
+namespace
+{
+	uint64_t SplitMix64(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	inline uint32_t RotateLeft(uint32_t x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+}
+
+Random::Random(uint32_t seed)
+{
+	Seed(seed);
+}
+
+void Random::Seed(uint32_t seed)
+{
+	// Expand the seed with SplitMix64 as recommended for xoshiro, it never yields an all zero lane in practice
+	uint64_t state = seed;
+	for (unsigned i = 0; i < 4 * LANE_COUNT; i += 2)
+	{
+		uint64_t value = SplitMix64(state);
+		_state[i] = uint32_t(value);
+		_state[i + 1] = uint32_t(value >> 32);
+	}
+
+	_buffered = 0;
+}
+
+uint32_t Random::Next()
+{
+	if (_buffered == 0)
+	{
+		step(_buffer);
+		_buffered = LANE_COUNT;
+	}
+
+	return _buffer[LANE_COUNT - _buffered--];
+}
+
+float Random::NextFloat()
+{
+	return (Next() >> 8) * FLOAT_SCALE;
+}
+
+float Random::NextFloat(float min, float max)
+{
+	return min + NextFloat() * (max - min);
+}
+
+void Random::NextFloats(float* values, unsigned count)
+{
+	unsigned i = 0;
+	for (; i < count && _buffered > 0; ++i)
+		values[i] = NextFloat();
+
+	for (; i + LANE_COUNT <= count; i += LANE_COUNT)
+		stepFloats(values + i);
+
+	for (; i < count; ++i)
+		values[i] = NextFloat();
+}
+
+void Random::step(uint32_t* output)
+{
+	uint32_t* s0 = _state;
+	uint32_t* s1 = _state + LANE_COUNT;
+	uint32_t* s2 = _state + 2 * LANE_COUNT;
+	uint32_t* s3 = _state + 3 * LANE_COUNT;
+
+	for (unsigned lane = 0; lane < LANE_COUNT; ++lane)
+	{
+		output[lane] = s0[lane] + s3[lane];
+
+		uint32_t t = s1[lane] << 9;
+		s2[lane] ^= s0[lane];
+		s3[lane] ^= s1[lane];
+		s1[lane] ^= s2[lane];
+		s0[lane] ^= s3[lane];
+		s2[lane] ^= t;
+		s3[lane] = RotateLeft(s3[lane], 11);
+	}
+}
+
+void Random::stepFloats(float* output)
+{
+#ifdef EQUINOX_SSE2
+	__m128i* state = reinterpret_cast<__m128i*>(_state);
+	__m128i s0 = _mm_loadu_si128(state);
+	__m128i s1 = _mm_loadu_si128(state + 1);
+	__m128i s2 = _mm_loadu_si128(state + 2);
+	__m128i s3 = _mm_loadu_si128(state + 3);
+
+	__m128i result = _mm_add_epi32(s0, s3);
+
+	__m128i t = _mm_slli_epi32(s1, 9);
+	s2 = _mm_xor_si128(s2, s0);
+	s3 = _mm_xor_si128(s3, s1);
+	s1 = _mm_xor_si128(s1, s2);
+	s0 = _mm_xor_si128(s0, s3);
+	s2 = _mm_xor_si128(s2, t);
+	s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+	_mm_storeu_si128(state, s0);
+	_mm_storeu_si128(state + 1, s1);
+	_mm_storeu_si128(state + 2, s2);
+	_mm_storeu_si128(state + 3, s3);
+
+	__m128 values = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+	_mm_storeu_ps(output, _mm_mul_ps(values, _mm_set1_ps(FLOAT_SCALE)));
+#else
+	uint32_t values[LANE_COUNT];
+	step(values);
+	for (unsigned lane = 0; lane < LANE_COUNT; ++lane)
+		output[lane] = (values[lane] >> 8) * FLOAT_SCALE;
+#endif
+}
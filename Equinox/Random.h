@@ -0,0 +1,36 @@
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+#include <cstdint>
+
+/*
+ * Seedable xoshiro128+ generator running four interleaved streams. The batch functions advance
+ * the four lanes at once with SSE2 and the scalar ones hand out the same lanes one by one, so a
+ * seed produces the same sequence however the numbers are requested.
+ */
+class Random
+{
+public:
+	static const unsigned LANE_COUNT = 4;
+
+	explicit Random(uint32_t seed = 1);
+
+	void Seed(uint32_t seed);
+
+	uint32_t Next();
+	float NextFloat(); // [0, 1)
+	float NextFloat(float min, float max);
+
+	void NextFloats(float* values, unsigned count); // [0, 1)
+
+private:
+	void step(uint32_t* output);
+	void stepFloats(float* output);
+
+	// State word i of lane l is stored at _state[i * LANE_COUNT + l] so each word loads as a vector
+	uint32_t _state[4 * LANE_COUNT];
+	uint32_t _buffer[LANE_COUNT];
+	unsigned _buffered = 0;
+};
+
+#endif // __RANDOM_H__
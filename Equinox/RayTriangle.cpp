@@ -0,0 +1,169 @@
+#include "RayTriangle.h"
+#include "SimdConfig.h"
+
+#include <cmath>
+
+namespace
+{
+	const float DETERMINANT_EPSILON = 1e-8f;
+
+	bool IntersectScalar(const float3& origin, const float3& direction, const TrianglePack* packs, size_t packCount, RayTriangleHit& hit)
+	{
+		bool found = false;
+		for (size_t p = 0; p < packCount; ++p)
+		{
+			const TrianglePack& pack = packs[p];
+			for (unsigned lane = 0; lane < RAY_TRIANGLE_LANES; ++lane)
+			{
+				float3 v0(pack.V0[0][lane], pack.V0[1][lane], pack.V0[2][lane]);
+				float3 edge1(pack.Edge1[0][lane], pack.Edge1[1][lane], pack.Edge1[2][lane]);
+				float3 edge2(pack.Edge2[0][lane], pack.Edge2[1][lane], pack.Edge2[2][lane]);
+
+				float3 pvec = direction.Cross(edge2);
+				float det = edge1.Dot(pvec);
+				if (fabsf(det) < DETERMINANT_EPSILON)
+					continue;
+
+				float invDet = 1.f / det;
+				float3 tvec = origin - v0;
+				float u = tvec.Dot(pvec) * invDet;
+				float3 qvec = tvec.Cross(edge1);
+				float v = direction.Dot(qvec) * invDet;
+				float t = edge2.Dot(qvec) * invDet;
+
+				if (u >= 0.f && v >= 0.f && u + v <= 1.f && t >= 0.f && t < hit.Distance)
+				{
+					hit.Distance = t;
+					hit.Triangle = pack.Triangle[lane];
+					found = true;
+				}
+			}
+		}
+
+		return found;
+	}
+
+#ifdef EQUINOX_SSE2
+	inline __m128 Dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+	}
+
+	bool IntersectSSE(const float3& origin, const float3& direction, const TrianglePack* packs, size_t packCount, RayTriangleHit& hit)
+	{
+		const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+		const __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 epsilon = _mm_set1_ps(DETERMINANT_EPSILON);
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+		bool found = false;
+		for (size_t p = 0; p < packCount; ++p)
+		{
+			const TrianglePack& pack = packs[p];
+			__m128 e1x = _mm_loadu_ps(pack.Edge1[0]), e1y = _mm_loadu_ps(pack.Edge1[1]), e1z = _mm_loadu_ps(pack.Edge1[2]);
+			__m128 e2x = _mm_loadu_ps(pack.Edge2[0]), e2y = _mm_loadu_ps(pack.Edge2[1]), e2z = _mm_loadu_ps(pack.Edge2[2]);
+
+			// pvec = direction x edge2
+			__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+			__m128 det = Dot(e1x, e1y, e1z, px, py, pz);
+			__m128 valid = _mm_cmpge_ps(_mm_and_ps(det, absMask), epsilon);
+			if (_mm_movemask_ps(valid) == 0)
+				continue;
+
+			__m128 invDet = _mm_div_ps(one, det);
+
+			__m128 tx = _mm_sub_ps(ox, _mm_loadu_ps(pack.V0[0]));
+			__m128 ty = _mm_sub_ps(oy, _mm_loadu_ps(pack.V0[1]));
+			__m128 tz = _mm_sub_ps(oz, _mm_loadu_ps(pack.V0[2]));
+
+			__m128 u = _mm_mul_ps(Dot(tx, ty, tz, px, py, pz), invDet);
+
+			// qvec = tvec x edge1
+			__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+			__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+			__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+
+			__m128 v = _mm_mul_ps(Dot(dx, dy, dz, qx, qy, qz), invDet);
+			__m128 t = _mm_mul_ps(Dot(e2x, e2y, e2z, qx, qy, qz), invDet);
+
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+			valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(t, zero));
+			valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(hit.Distance)));
+
+			int mask = _mm_movemask_ps(valid);
+			if (mask == 0)
+				continue;
+
+			float distances[RAY_TRIANGLE_LANES];
+			_mm_storeu_ps(distances, t);
+			for (unsigned lane = 0; lane < RAY_TRIANGLE_LANES; ++lane)
+			{
+				if ((mask & (1 << lane)) && distances[lane] < hit.Distance)
+				{
+					hit.Distance = distances[lane];
+					hit.Triangle = pack.Triangle[lane];
+					found = true;
+				}
+			}
+		}
+
+		return found;
+	}
+#endif
+}
+
+const char* RayTriangle::GetKernelName(RayTriangleKernel kernel)
+{
+#ifdef EQUINOX_SSE2
+	if (kernel != RayTriangleKernel::Scalar)
+		return "SSE";
+#endif
+	return "Scalar";
+}
+
+void RayTriangle::BuildPacks(const float3* vertices, const uint32_t* indices, size_t triangleCount, std::vector<TrianglePack>& packs)
+{
+	size_t first = packs.size();
+	packs.resize(first + (triangleCount + RAY_TRIANGLE_LANES - 1) / RAY_TRIANGLE_LANES);
+
+	for (size_t triangle = 0; triangle < (packs.size() - first) * RAY_TRIANGLE_LANES; ++triangle)
+	{
+		TrianglePack& pack = packs[first + triangle / RAY_TRIANGLE_LANES];
+		unsigned lane = triangle % RAY_TRIANGLE_LANES;
+
+		float3 v0 = float3::zero, edge1 = float3::zero, edge2 = float3::zero;
+		uint32_t id = 0xFFFFFFFF;
+		if (triangle < triangleCount)
+		{
+			v0 = vertices[indices[triangle * 3]];
+			edge1 = vertices[indices[triangle * 3 + 1]] - v0;
+			edge2 = vertices[indices[triangle * 3 + 2]] - v0;
+			id = uint32_t(triangle);
+		}
+
+		for (unsigned axis = 0; axis < 3; ++axis)
+		{
+			pack.V0[axis][lane] = v0[axis];
+			pack.Edge1[axis][lane] = edge1[axis];
+			pack.Edge2[axis][lane] = edge2[axis];
+		}
+		pack.Triangle[lane] = id;
+	}
+}
+
+bool RayTriangle::Intersect(const float3& origin, const float3& direction, const TrianglePack* packs, size_t packCount, RayTriangleHit& hit, RayTriangleKernel kernel)
+{
+#ifdef EQUINOX_SSE2
+	if (kernel != RayTriangleKernel::Scalar)
+		return IntersectSSE(origin, direction, packs, packCount, hit);
+#endif
+
+	return IntersectScalar(origin, direction, packs, packCount, hit);
+}
@@ -0,0 +1,47 @@
+#ifndef __RAYTRIANGLE_H__
+#define __RAYTRIANGLE_H__
+
+#include <MathGeoLib/include/Math/float3.h>
+#include <cstdint>
+#include <vector>
+
+#define RAY_TRIANGLE_LANES 4
+
+enum class RayTriangleKernel
+{
+	Scalar,
+	SSE,
+	Best
+};
+
+// Four triangles in SoA layout with their edges precomputed. Padding lanes have zero edges and never hit.
+struct TrianglePack
+{
+	float V0[3][RAY_TRIANGLE_LANES];
+	float Edge1[3][RAY_TRIANGLE_LANES];
+	float Edge2[3][RAY_TRIANGLE_LANES];
+	uint32_t Triangle[RAY_TRIANGLE_LANES];
+};
+
+struct RayTriangleHit
+{
+	float Distance = 0.f; // Only triangles closer than this are reported
+	uint32_t Triangle = 0xFFFFFFFF;
+};
+
+/*
+ * Moller-Trumbore ray against triangle tests, four triangles at a time. The ray direction does
+ * not need to be normalized, distances are in units of its length.
+ */
+namespace RayTriangle
+{
+	const char* GetKernelName(RayTriangleKernel kernel);
+
+	// Appends packs for triangles [0, triangleCount) of an indexed mesh
+	void BuildPacks(const float3* vertices, const uint32_t* indices, size_t triangleCount, std::vector<TrianglePack>& packs);
+
+	// Returns true and updates hit when a triangle closer than hit.Distance is found
+	bool Intersect(const float3& origin, const float3& direction, const TrianglePack* packs, size_t packCount, RayTriangleHit& hit, RayTriangleKernel kernel = RayTriangleKernel::Best);
+}
+
+#endif // __RAYTRIANGLE_H__
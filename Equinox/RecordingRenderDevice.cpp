@@ -0,0 +1,506 @@
+#include "RecordingRenderDevice.h"
+#include "Globals.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const size_t MAX_RECORDED_ERRORS = 32;
+	const int MAX_MATRIX_DEPTH = 32; // Model view stack depth GL guarantees
+
+	unsigned VerticesPerPrimitive(PrimitiveType type)
+	{
+		switch (type)
+		{
+			case PrimitiveType::Lines: return 2;
+			case PrimitiveType::Quads: return 4;
+			default: return 3;
+		}
+	}
+}
+
+void RecordingRenderDevice::BeginFrame()
+{
+	_commands.clear();
+	_payload.clear();
+	_errors.clear();
+	memset(_commandCounts, 0, sizeof(_commandCounts));
+	_stats = RenderStats();
+}
+
+void RecordingRenderDevice::EndFrame()
+{
+	if (_matrixDepth != 0)
+	{
+		error("Frame ended with %i matrices pushed", _matrixDepth);
+		_matrixDepth = 0;
+	}
+
+	_frameStats = _stats;
+
+	// Every frame repeats the same mistakes, each one is only logged the first time
+	for (const std::string& message : _errors)
+	{
+		if (_reportedErrors.insert(message).second)
+			LOG("Render validation: %s", message.c_str());
+	}
+}
+
+void RecordingRenderDevice::Replay(RenderDevice& device) const
+{
+	for (const RenderCommand& command : _commands)
+	{
+		switch (command.Type)
+		{
+			case RenderCommandType::SetViewport:
+				device.SetViewport(command.Ints[0], command.Ints[1], command.Ints[2], command.Ints[3]);
+				break;
+			case RenderCommandType::Clear:
+				device.Clear(float4(floats(command)));
+				break;
+			case RenderCommandType::SetCamera:
+				device.SetCamera(floats(command), floats(command, 16));
+				break;
+			case RenderCommandType::SetState:
+				device.SetState(RenderState(command.Enum), command.Flag);
+				break;
+			case RenderCommandType::SetDepthWrite:
+				device.SetDepthWrite(command.Flag);
+				break;
+			case RenderCommandType::SetAlphaReference:
+				device.SetAlphaReference(command.Value);
+				break;
+			case RenderCommandType::SetLineWidth:
+				device.SetLineWidth(command.Value);
+				break;
+			case RenderCommandType::SetColor:
+				device.SetColor(float4(floats(command)));
+				break;
+			case RenderCommandType::SetMaterial:
+				device.SetMaterial(floats(command), floats(command, 4), floats(command, 8), command.Value);
+				break;
+			case RenderCommandType::SetAmbientLight:
+				device.SetAmbientLight(floats(command));
+				break;
+			case RenderCommandType::SetLightEnabled:
+				device.SetLightEnabled(command.Ints[0], command.Flag);
+				break;
+			case RenderCommandType::SetLight:
+				device.SetLight(command.Ints[0], floats(command), floats(command, 4), floats(command, 8), floats(command, 12), command.Value, floats(command, 16));
+				break;
+			case RenderCommandType::PushMatrix:
+				device.PushMatrix();
+				break;
+			case RenderCommandType::PopMatrix:
+				device.PopMatrix();
+				break;
+			case RenderCommandType::MultMatrix:
+				device.MultMatrix(*reinterpret_cast<const float4x4*>(floats(command)));
+				break;
+			case RenderCommandType::BindBuffer:
+				device.BindBuffer(BufferTarget(command.Enum), command.Ints[0]);
+				break;
+			case RenderCommandType::StreamBuffer:
+				device.StreamBuffer(BufferTarget(command.Enum), command.Ints[0], _payload.data() + command.Payload, command.PayloadSize);
+				break;
+			case RenderCommandType::SetVertexArray:
+				device.SetVertexArray(VertexArray(command.Enum), command.Flag);
+				break;
+			case RenderCommandType::SetVertexPointer:
+				device.SetVertexPointer(VertexArray(command.Enum), command.Ints[0], command.Ints[1], size_t(command.Ints[2]));
+				break;
+			case RenderCommandType::SetVertexAttribute:
+				device.SetVertexAttribute(command.Name, command.Ints[0], command.Ints[1]);
+				break;
+			case RenderCommandType::DisableVertexAttribute:
+				device.DisableVertexAttribute(command.Name);
+				break;
+			case RenderCommandType::UseProgram:
+				device.UseProgram(command.Ints[0]);
+				break;
+			case RenderCommandType::SetUniformInt:
+				device.SetUniform(command.Name, command.Ints[0]);
+				break;
+			case RenderCommandType::SetUniformVector:
+				device.SetUniform(command.Name, float4(floats(command)));
+				break;
+			case RenderCommandType::SetUniformMatrices:
+				device.SetUniform(command.Name, reinterpret_cast<const float4x4*>(floats(command)), command.Ints[0]);
+				break;
+			case RenderCommandType::BindTexture:
+				device.BindTexture(command.Ints[0], command.Ints[1]);
+				break;
+			case RenderCommandType::DrawIndexed:
+				device.DrawIndexed(PrimitiveType(command.Enum), command.Ints[0]);
+				break;
+			case RenderCommandType::DrawArrays:
+				device.DrawArrays(PrimitiveType(command.Enum), command.Ints[0], command.Ints[1]);
+				break;
+			case RenderCommandType::DrawVertices:
+				device.DrawVertices(PrimitiveType(command.Enum), reinterpret_cast<const float3*>(floats(command)), command.Ints[0]);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void RecordingRenderDevice::SetViewport(int x, int y, int width, int height)
+{
+	RenderCommand& command = record(RenderCommandType::SetViewport);
+	command.Ints[0] = x;
+	command.Ints[1] = y;
+	command.Ints[2] = width;
+	command.Ints[3] = height;
+
+	if (width <= 0 || height <= 0)
+		error("Empty viewport of %ix%i", width, height);
+}
+
+void RecordingRenderDevice::Clear(const float4& color)
+{
+	attach(record(RenderCommandType::Clear), color.ptr(), sizeof(float4));
+}
+
+void RecordingRenderDevice::SetCamera(const float* projection, const float* view)
+{
+	RenderCommand& command = record(RenderCommandType::SetCamera);
+	attach(command, projection, sizeof(float) * 16);
+	attach(command, view, sizeof(float) * 16);
+}
+
+void RecordingRenderDevice::SetDepthWrite(bool enabled)
+{
+	record(RenderCommandType::SetDepthWrite).Flag = enabled;
+	++_stats.StateChanges;
+}
+
+void RecordingRenderDevice::SetAlphaReference(float reference)
+{
+	record(RenderCommandType::SetAlphaReference).Value = reference;
+	++_stats.StateChanges;
+}
+
+void RecordingRenderDevice::SetLineWidth(float width)
+{
+	record(RenderCommandType::SetLineWidth).Value = width;
+	++_stats.StateChanges;
+}
+
+void RecordingRenderDevice::SetColor(const float4& color)
+{
+	attach(record(RenderCommandType::SetColor), color.ptr(), sizeof(float4));
+}
+
+void RecordingRenderDevice::SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess)
+{
+	RenderCommand& command = record(RenderCommandType::SetMaterial);
+	command.Value = shininess;
+	attach(command, ambient, sizeof(float) * 4);
+	attach(command, diffuse, sizeof(float) * 4);
+	attach(command, specular, sizeof(float) * 4);
+	++_stats.StateChanges;
+}
+
+void RecordingRenderDevice::SetAmbientLight(const float* color)
+{
+	attach(record(RenderCommandType::SetAmbientLight), color, sizeof(float) * 4);
+	++_stats.StateChanges;
+}
+
+void RecordingRenderDevice::SetLightEnabled(unsigned light, bool enabled)
+{
+	RenderCommand& command = record(RenderCommandType::SetLightEnabled);
+	command.Ints[0] = light;
+	command.Flag = enabled;
+	++_stats.StateChanges;
+
+	if (light >= MAX_RENDER_LIGHTS)
+		error("Light %u out of range", light);
+}
+
+void RecordingRenderDevice::SetLight(unsigned light, const float* ambient, const float* diffuse, const float* specular, const float* position, float cutOff, const float* direction)
+{
+	RenderCommand& command = record(RenderCommandType::SetLight);
+	command.Ints[0] = light;
+	command.Value = cutOff;
+	attach(command, ambient, sizeof(float) * 4);
+	attach(command, diffuse, sizeof(float) * 4);
+	attach(command, specular, sizeof(float) * 4);
+	attach(command, position, sizeof(float) * 4);
+	attach(command, direction, sizeof(float) * 3);
+	++_stats.StateChanges;
+
+	if (light >= MAX_RENDER_LIGHTS)
+		error("Light %u out of range", light);
+}
+
+void RecordingRenderDevice::PushMatrix()
+{
+	record(RenderCommandType::PushMatrix);
+
+	if (++_matrixDepth > MAX_MATRIX_DEPTH)
+		error("More than %i matrices pushed", MAX_MATRIX_DEPTH);
+}
+
+void RecordingRenderDevice::PopMatrix()
+{
+	record(RenderCommandType::PopMatrix);
+
+	if (_matrixDepth == 0)
+		error("Matrix popped without a push");
+	else
+		--_matrixDepth;
+}
+
+void RecordingRenderDevice::MultMatrix(const float4x4& matrix)
+{
+	attach(record(RenderCommandType::MultMatrix), matrix.ptr(), sizeof(float4x4));
+}
+
+unsigned RecordingRenderDevice::CreateBuffer(BufferTarget target, const void* data, size_t bytes)
+{
+	// Buffers are not part of the frame, they only need an id for the draws that bind them
+	return ++_lastBuffer;
+}
+
+void RecordingRenderDevice::DeleteBuffer(unsigned buffer)
+{
+}
+
+void RecordingRenderDevice::BindBuffer(BufferTarget target, unsigned buffer)
+{
+	RenderCommand& command = record(RenderCommandType::BindBuffer);
+	command.Enum = uint8_t(target);
+	command.Ints[0] = buffer;
+
+	unsigned& bound = target == BufferTarget::Indices ? _indexBuffer : _vertexBuffer;
+	if (bound == buffer)
+		++_stats.RedundantStateChanges;
+	bound = buffer;
+}
+
+void RecordingRenderDevice::StreamBuffer(BufferTarget target, unsigned buffer, const void* data, size_t bytes)
+{
+	RenderCommand& command = record(RenderCommandType::StreamBuffer);
+	command.Enum = uint8_t(target);
+	command.Ints[0] = buffer;
+	attach(command, data, bytes);
+	_stats.UploadedBytes += bytes;
+
+	if (buffer == 0)
+		error("Upload of %u bytes without a buffer", unsigned(bytes));
+
+	unsigned& bound = target == BufferTarget::Indices ? _indexBuffer : _vertexBuffer;
+	bound = buffer;
+}
+
+void RecordingRenderDevice::SetVertexArray(VertexArray array, bool enabled)
+{
+	RenderCommand& command = record(RenderCommandType::SetVertexArray);
+	command.Enum = uint8_t(array);
+	command.Flag = enabled;
+
+	++_stats.StateChanges;
+	if (_arrays[int(array)] == enabled)
+		++_stats.RedundantStateChanges;
+	_arrays[int(array)] = enabled;
+}
+
+void RecordingRenderDevice::SetVertexPointer(VertexArray array, int components, int stride, size_t offset)
+{
+	RenderCommand& command = record(RenderCommandType::SetVertexPointer);
+	command.Enum = uint8_t(array);
+	command.Ints[0] = components;
+	command.Ints[1] = stride;
+	command.Ints[2] = int(offset);
+
+	if (_vertexBuffer == 0)
+		error("Vertex pointer set without a vertex buffer bound");
+}
+
+void RecordingRenderDevice::SetVertexAttribute(const char* name, int components, unsigned buffer)
+{
+	RenderCommand& command = record(RenderCommandType::SetVertexAttribute);
+	command.Name = name;
+	command.Ints[0] = components;
+	command.Ints[1] = buffer;
+	_vertexBuffer = buffer;
+
+	if (_program == 0)
+		error("Attribute %s set without a program", name);
+	if (buffer == 0)
+		error("Attribute %s set without a buffer", name);
+}
+
+void RecordingRenderDevice::DisableVertexAttribute(const char* name)
+{
+	record(RenderCommandType::DisableVertexAttribute).Name = name;
+
+	if (_program == 0)
+		error("Attribute %s disabled without a program", name);
+}
+
+void RecordingRenderDevice::UseProgram(unsigned program)
+{
+	record(RenderCommandType::UseProgram).Ints[0] = program;
+
+	++_stats.ProgramChanges;
+	if (_program == program)
+		++_stats.RedundantStateChanges;
+	_program = program;
+}
+
+void RecordingRenderDevice::SetUniform(const char* name, int value)
+{
+	RenderCommand& command = record(RenderCommandType::SetUniformInt);
+	command.Name = name;
+	command.Ints[0] = value;
+
+	if (_program == 0)
+		error("Uniform %s set without a program", name);
+}
+
+void RecordingRenderDevice::SetUniform(const char* name, const float4& value)
+{
+	RenderCommand& command = record(RenderCommandType::SetUniformVector);
+	command.Name = name;
+	attach(command, value.ptr(), sizeof(float4));
+
+	if (_program == 0)
+		error("Uniform %s set without a program", name);
+}
+
+void RecordingRenderDevice::SetUniform(const char* name, const float4x4* matrices, size_t count)
+{
+	RenderCommand& command = record(RenderCommandType::SetUniformMatrices);
+	command.Name = name;
+	command.Ints[0] = int(count);
+	attach(command, matrices, sizeof(float4x4) * count);
+
+	if (_program == 0)
+		error("Uniform %s set without a program", name);
+}
+
+void RecordingRenderDevice::BindTexture(unsigned unit, unsigned texture)
+{
+	RenderCommand& command = record(RenderCommandType::BindTexture);
+	command.Ints[0] = unit;
+	command.Ints[1] = texture;
+
+	if (unit >= sizeof(_textures) / sizeof(_textures[0]))
+	{
+		error("Texture unit %u out of range", unit);
+		return;
+	}
+
+	++_stats.TextureBinds;
+	if (_textures[unit] == texture)
+		++_stats.RedundantStateChanges;
+	_textures[unit] = texture;
+}
+
+void RecordingRenderDevice::DrawIndexed(PrimitiveType type, unsigned indexCount)
+{
+	RenderCommand& command = record(RenderCommandType::DrawIndexed);
+	command.Enum = uint8_t(type);
+	command.Ints[0] = indexCount;
+
+	checkDraw(type, indexCount, true);
+}
+
+void RecordingRenderDevice::DrawArrays(PrimitiveType type, unsigned first, unsigned count)
+{
+	RenderCommand& command = record(RenderCommandType::DrawArrays);
+	command.Enum = uint8_t(type);
+	command.Ints[0] = first;
+	command.Ints[1] = count;
+
+	checkDraw(type, count, false);
+}
+
+void RecordingRenderDevice::DrawVertices(PrimitiveType type, const float3* vertices, size_t count)
+{
+	RenderCommand& command = record(RenderCommandType::DrawVertices);
+	command.Enum = uint8_t(type);
+	command.Ints[0] = int(count);
+	attach(command, vertices, sizeof(float3) * count);
+
+	++_stats.DrawCalls;
+	_stats.Primitives += unsigned(count) / VerticesPerPrimitive(type);
+
+	if (count % VerticesPerPrimitive(type) != 0)
+		error("%u immediate vertices do not make whole primitives", unsigned(count));
+}
+
+void RecordingRenderDevice::applyState(RenderState state, bool enabled)
+{
+	RenderCommand& command = record(RenderCommandType::SetState);
+	command.Enum = uint8_t(state);
+	command.Flag = enabled;
+
+	++_stats.StateChanges;
+	if (IsEnabled(state) == enabled)
+		++_stats.RedundantStateChanges;
+}
+
+RenderCommand& RecordingRenderDevice::record(RenderCommandType type)
+{
+	++_stats.Commands;
+	++_commandCounts[int(type)];
+
+	_commands.push_back(RenderCommand());
+	_commands.back().Type = type;
+	return _commands.back();
+}
+
+void RecordingRenderDevice::attach(RenderCommand& command, const void* data, size_t bytes)
+{
+	size_t offset = (_payload.size() + 15) & ~size_t(15);
+	_payload.resize(offset + bytes);
+	if (bytes > 0)
+		memcpy(_payload.data() + offset, data, bytes);
+
+	// Arguments attached to the same command follow each other, 16 byte aligned
+	if (command.PayloadSize == 0)
+		command.Payload = uint32_t(offset);
+	command.PayloadSize = uint32_t(offset + bytes - command.Payload);
+}
+
+const float* RecordingRenderDevice::floats(const RenderCommand& command, size_t offset) const
+{
+	// Offsets of later arguments are in floats, each argument starts on a 16 byte boundary
+	return reinterpret_cast<const float*>(_payload.data() + command.Payload) + offset;
+}
+
+void RecordingRenderDevice::checkDraw(PrimitiveType type, unsigned vertexCount, bool indexed)
+{
+	++_stats.DrawCalls;
+	_stats.Primitives += vertexCount / VerticesPerPrimitive(type);
+
+	if (vertexCount % VerticesPerPrimitive(type) != 0)
+		error("Draw of %u vertices does not make whole primitives", vertexCount);
+
+	if (indexed && _indexBuffer == 0)
+		error("Indexed draw without an index buffer");
+
+	if (!_arrays[int(VertexArray::Position)])
+		error("Draw without the position array enabled");
+}
+
+void RecordingRenderDevice::error(const char* format, ...)
+{
+	++_stats.Errors;
+	if (_errors.size() >= MAX_RECORDED_ERRORS)
+		return;
+
+	char message[256];
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(message, sizeof(message), format, arguments);
+	va_end(arguments);
+
+	_errors.push_back(message);
+}
@@ -0,0 +1,163 @@
+#ifndef __RECORDINGRENDERDEVICE_H__
+#define __RECORDINGRENDERDEVICE_H__
+
+#include "RenderDevice.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+enum class RenderCommandType : uint8_t
+{
+	SetViewport,
+	Clear,
+	SetCamera,
+	SetState,
+	SetDepthWrite,
+	SetAlphaReference,
+	SetLineWidth,
+	SetColor,
+	SetMaterial,
+	SetAmbientLight,
+	SetLightEnabled,
+	SetLight,
+	PushMatrix,
+	PopMatrix,
+	MultMatrix,
+	BindBuffer,
+	StreamBuffer,
+	SetVertexArray,
+	SetVertexPointer,
+	SetVertexAttribute,
+	DisableVertexAttribute,
+	UseProgram,
+	SetUniformInt,
+	SetUniformVector,
+	SetUniformMatrices,
+	BindTexture,
+	DrawIndexed,
+	DrawArrays,
+	DrawVertices,
+	Count
+};
+
+// Arguments that do not fit in the command (matrices, colors, buffer contents) are copied to the payload
+struct RenderCommand
+{
+	RenderCommandType Type;
+	uint8_t Enum = 0; // State, array, buffer target or primitive type
+	bool Flag = false;
+	int Ints[4] = {};
+	float Value = 0.f;
+	const char* Name = nullptr;
+	uint32_t Payload = 0; // Byte offset
+	uint32_t PayloadSize = 0;
+};
+
+struct RenderStats
+{
+	unsigned Commands = 0;
+	unsigned DrawCalls = 0;
+	unsigned Primitives = 0;
+	unsigned StateChanges = 0;
+	unsigned RedundantStateChanges = 0;
+	unsigned ProgramChanges = 0;
+	unsigned TextureBinds = 0;
+	size_t UploadedBytes = 0;
+	unsigned Errors = 0;
+};
+
+/*
+ * Null backend that keeps the calls of a frame as commands instead of drawing. It counts them, checks
+ * they would be valid GL (balanced matrix stack, buffers bound before drawing, a program bound before
+ * setting uniforms...) and can replay them on another device. As the device of ModuleRender it runs
+ * without a GL context: buffers only get ids, textures and shaders are not created.
+ */
+class RecordingRenderDevice : public RenderDevice
+{
+public:
+	const char* GetName() const override { return "Recording"; }
+	bool HasContext() const override { return false; }
+
+	// Drops the commands of the previous frame
+	void BeginFrame() override;
+	void EndFrame() override;
+
+	void Replay(RenderDevice& device) const;
+
+	const std::vector<RenderCommand>& GetCommands() const { return _commands; }
+	unsigned GetCommandCount(RenderCommandType type) const { return _commandCounts[int(type)]; }
+	// Frame being recorded
+	const RenderStats& GetStats() const { return _stats; }
+	// Last frame that ended
+	const RenderStats& GetFrameStats() const { return _frameStats; }
+	const std::vector<std::string>& GetErrors() const { return _errors; }
+
+	void SetViewport(int x, int y, int width, int height) override;
+	void Clear(const float4& color) override;
+	void SetCamera(const float* projection, const float* view) override;
+
+	void SetDepthWrite(bool enabled) override;
+	void SetAlphaReference(float reference) override;
+	void SetLineWidth(float width) override;
+	void SetColor(const float4& color) override;
+	void SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess) override;
+
+	void SetAmbientLight(const float* color) override;
+	void SetLightEnabled(unsigned light, bool enabled) override;
+	void SetLight(unsigned light, const float* ambient, const float* diffuse, const float* specular, const float* position, float cutOff, const float* direction) override;
+
+	void PushMatrix() override;
+	void PopMatrix() override;
+	void MultMatrix(const float4x4& matrix) override;
+
+	unsigned CreateBuffer(BufferTarget target, const void* data, size_t bytes) override;
+	void DeleteBuffer(unsigned buffer) override;
+	void BindBuffer(BufferTarget target, unsigned buffer) override;
+	void StreamBuffer(BufferTarget target, unsigned buffer, const void* data, size_t bytes) override;
+	void SetVertexArray(VertexArray array, bool enabled) override;
+	void SetVertexPointer(VertexArray array, int components, int stride, size_t offset) override;
+	void SetVertexAttribute(const char* name, int components, unsigned buffer) override;
+	void DisableVertexAttribute(const char* name) override;
+
+	void UseProgram(unsigned program) override;
+	void SetUniform(const char* name, int value) override;
+	void SetUniform(const char* name, const float4& value) override;
+	void SetUniform(const char* name, const float4x4* matrices, size_t count) override;
+	void BindTexture(unsigned unit, unsigned texture) override;
+
+	void DrawIndexed(PrimitiveType type, unsigned indexCount) override;
+	void DrawArrays(PrimitiveType type, unsigned first, unsigned count) override;
+	void DrawVertices(PrimitiveType type, const float3* vertices, size_t count) override;
+
+protected:
+	void applyState(RenderState state, bool enabled) override;
+
+private:
+	RenderCommand& record(RenderCommandType type);
+	// Copies the data at the end of the payload, 16 byte aligned
+	void attach(RenderCommand& command, const void* data, size_t bytes);
+	const float* floats(const RenderCommand& command, size_t offset = 0) const;
+	void checkDraw(PrimitiveType type, unsigned vertexCount, bool indexed);
+	void error(const char* format, ...);
+
+	std::vector<RenderCommand> _commands;
+	std::vector<uint8_t> _payload;
+	unsigned _commandCounts[int(RenderCommandType::Count)] = {};
+
+	RenderStats _stats;
+	RenderStats _frameStats;
+	std::vector<std::string> _errors;
+	std::set<std::string> _reportedErrors;
+
+	// GL state followed for validation
+	int _matrixDepth = 0;
+	unsigned _vertexBuffer = 0;
+	unsigned _indexBuffer = 0;
+	unsigned _program = 0;
+	unsigned _textures[8] = {};
+	bool _arrays[int(VertexArray::Count)] = {};
+	unsigned _lastBuffer = 0;
+};
+
+#endif // __RECORDINGRENDERDEVICE_H__
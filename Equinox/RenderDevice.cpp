@@ -0,0 +1,28 @@
+#include "RenderDevice.h"
+
+namespace
+{
+	thread_local RenderDevice* currentDevice = nullptr;
+}
+
+RenderDevice* RenderDevice::Current()
+{
+	return currentDevice;
+}
+
+void RenderDevice::MakeCurrent(RenderDevice* device)
+{
+	currentDevice = device;
+}
+
+void RenderDevice::InheritStates(const RenderDevice& device)
+{
+	for (int state = 0; state < int(RenderState::Count); ++state)
+		_states[state] = device._states[state];
+}
+
+void RenderDevice::SetState(RenderState state, bool enabled)
+{
+	applyState(state, enabled);
+	_states[int(state)] = enabled;
+}
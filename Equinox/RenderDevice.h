@@ -0,0 +1,130 @@
+#ifndef __RENDERDEVICE_H__
+#define __RENDERDEVICE_H__
+
+#include <MathGeoLib/include/Math/float3.h>
+#include <MathGeoLib/include/Math/float4.h>
+#include <MathGeoLib/include/Math/float4x4.h>
+#include <cstddef>
+
+#define MAX_RENDER_LIGHTS 8
+
+enum class RenderState
+{
+	Lighting,
+	ColorMaterial,
+	Texture2D,
+	Blend,
+	AlphaTest,
+	DepthTest,
+	CullFace,
+	Count
+};
+
+enum class VertexArray
+{
+	Position,
+	Normal,
+	TextureCoords,
+	Count
+};
+
+enum class BufferTarget
+{
+	Vertices,
+	Indices
+};
+
+enum class PrimitiveType
+{
+	Lines,
+	Triangles,
+	Quads
+};
+
+/*
+ * Every per frame draw goes through a render device instead of calling GL, so the frame can be sent
+ * to GL or recorded to be counted, validated and replayed. Buffers are created through the device too.
+ * Textures and shaders are still created with GL directly at load time, and only when HasContext.
+ *
+ * Uniform and attribute names are kept by pointer, pass string literals.
+ */
+class RenderDevice
+{
+public:
+	virtual ~RenderDevice() = default;
+
+	// Device the calling thread draws with, ModuleRender sets the one of the main thread
+	static RenderDevice* Current();
+	static void MakeCurrent(RenderDevice* device);
+
+	virtual const char* GetName() const = 0;
+	// False when the device never reaches GL: ModuleRender creates no context and nothing may call GL
+	virtual bool HasContext() const { return true; }
+
+	virtual void BeginFrame() {}
+	virtual void EndFrame() {}
+
+	virtual void SetViewport(int x, int y, int width, int height) = 0;
+	virtual void Clear(const float4& color) = 0;
+	// Column major matrices, as CameraComponent returns them. Resets the transform stack to the view.
+	virtual void SetCamera(const float* projection, const float* view) = 0;
+
+	// The last value set is kept so callers can restore what they change
+	void SetState(RenderState state, bool enabled);
+	bool IsEnabled(RenderState state) const { return _states[int(state)]; }
+	// Takes the state values of another device without applying them, for commands that will be replayed on it
+	void InheritStates(const RenderDevice& device);
+
+	virtual void SetDepthWrite(bool enabled) = 0;
+	// Fragments pass the alpha test when their alpha is greater than the reference
+	virtual void SetAlphaReference(float reference) = 0;
+	virtual void SetLineWidth(float width) = 0;
+	virtual void SetColor(const float4& color) = 0;
+	virtual void SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess) = 0;
+
+	virtual void SetAmbientLight(const float* color) = 0;
+	virtual void SetLightEnabled(unsigned light, bool enabled) = 0;
+	// Position w is 0 for directional lights. A cut off of 180 degrees is not a spotlight.
+	virtual void SetLight(unsigned light, const float* ambient, const float* diffuse, const float* specular, const float* position, float cutOff, const float* direction) = 0;
+
+	// Model transforms, on top of the camera view
+	virtual void PushMatrix() = 0;
+	virtual void PopMatrix() = 0;
+	// Row major, as MathGeoLib stores them
+	virtual void MultMatrix(const float4x4& matrix) = 0;
+
+	// Static buffer filled with the data, if any. Created at load time, never 0.
+	virtual unsigned CreateBuffer(BufferTarget target, const void* data, size_t bytes) = 0;
+	virtual void DeleteBuffer(unsigned buffer) = 0;
+	virtual void BindBuffer(BufferTarget target, unsigned buffer) = 0;
+	// Replaces the whole contents of an existing buffer, the previous storage is orphaned
+	virtual void StreamBuffer(BufferTarget target, unsigned buffer, const void* data, size_t bytes) = 0;
+	virtual void SetVertexArray(VertexArray array, bool enabled) = 0;
+	// Float components read from the bound vertex buffer. Normals always have three.
+	virtual void SetVertexPointer(VertexArray array, int components, int stride, size_t offset) = 0;
+	// Enables a float attribute of the current program and reads it from the given buffer
+	virtual void SetVertexAttribute(const char* name, int components, unsigned buffer) = 0;
+	virtual void DisableVertexAttribute(const char* name) = 0;
+
+	// 0 goes back to the fixed pipeline
+	virtual void UseProgram(unsigned program) = 0;
+	virtual void SetUniform(const char* name, int value) = 0;
+	virtual void SetUniform(const char* name, const float4& value) = 0;
+	virtual void SetUniform(const char* name, const float4x4* matrices, size_t count) = 0;
+	virtual void BindTexture(unsigned unit, unsigned texture) = 0;
+
+	// 32 bit indices from the bound index buffer
+	virtual void DrawIndexed(PrimitiveType type, unsigned indexCount) = 0;
+	virtual void DrawArrays(PrimitiveType type, unsigned first, unsigned count) = 0;
+	// Small debug geometry sent with the draw, in the current color
+	virtual void DrawVertices(PrimitiveType type, const float3* vertices, size_t count) = 0;
+
+protected:
+	// Called before the new value is stored, IsEnabled still returns the previous one
+	virtual void applyState(RenderState state, bool enabled) = 0;
+
+private:
+	bool _states[int(RenderState::Count)] = {};
+};
+
+#endif // __RENDERDEVICE_H__
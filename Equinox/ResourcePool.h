@@ -0,0 +1,208 @@
+#ifndef __RESOURCEPOOL_H__
+#define __RESOURCEPOOL_H__
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+/*
+ * Generational handle to a resource owned by a ResourcePool. A handle whose slot has been
+ * released and reused no longer resolves, so stale handles are detected instead of aliasing.
+ */
+template<typename ResourceType>
+struct ResourceHandle
+{
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	uint32_t Index = INVALID_INDEX;
+	uint32_t Generation = 0;
+
+	bool IsValid() const
+	{
+		return Index != INVALID_INDEX;
+	}
+
+	bool operator==(const ResourceHandle& other) const
+	{
+		return Index == other.Index && Generation == other.Generation;
+	}
+
+	bool operator!=(const ResourceHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/*
+ * Reference counted slot storage. Resources live in a deque so their addresses are stable,
+ * handles resolve in O(1) and released slots are recycled through a free list.
+ */
+template<typename ResourceType>
+class ResourcePool
+{
+public:
+	typedef ResourceHandle<ResourceType> Handle;
+
+	Handle Create()
+	{
+		uint32_t index;
+		if (!_freeSlots.empty())
+		{
+			index = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		else
+		{
+			index = uint32_t(_slots.size());
+			_slots.emplace_back();
+		}
+
+		Slot& slot = _slots[index];
+		slot.Alive = true;
+		slot.RefCount = 0;
+		++_aliveCount;
+
+		Handle handle;
+		handle.Index = index;
+		handle.Generation = slot.Generation;
+		return handle;
+	}
+
+	ResourceType* Get(Handle handle)
+	{
+		Slot* slot = getSlot(handle);
+		return slot != nullptr ? &slot->Resource : nullptr;
+	}
+
+	const ResourceType* Get(Handle handle) const
+	{
+		const Slot* slot = getSlot(handle);
+		return slot != nullptr ? &slot->Resource : nullptr;
+	}
+
+	void AddRef(Handle handle)
+	{
+		Slot* slot = getSlot(handle);
+		if (slot != nullptr)
+			++slot->RefCount;
+	}
+
+	void Release(Handle handle)
+	{
+		Slot* slot = getSlot(handle);
+		if (slot != nullptr)
+		{
+			assert(slot->RefCount > 0 && "Releasing a resource that is not referenced");
+			--slot->RefCount;
+		}
+	}
+
+	unsigned GetRefCount(Handle handle) const
+	{
+		const Slot* slot = getSlot(handle);
+		return slot != nullptr ? slot->RefCount : 0;
+	}
+
+	// Destroys every resource that is no longer referenced, calling destroy(handle, resource) first
+	template<typename DestroyCallback>
+	size_t ReleaseUnused(DestroyCallback destroy)
+	{
+		size_t released = 0;
+		for (uint32_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i].Alive && _slots[i].RefCount == 0)
+			{
+				destroy(handleAt(i), _slots[i].Resource);
+				freeSlot(i);
+				++released;
+			}
+		}
+		return released;
+	}
+
+	template<typename DestroyCallback>
+	void Clear(DestroyCallback destroy)
+	{
+		for (uint32_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i].Alive)
+				destroy(handleAt(i), _slots[i].Resource);
+		}
+
+		_slots.clear();
+		_freeSlots.clear();
+		_aliveCount = 0;
+	}
+
+	template<typename Callback>
+	void ForEach(Callback callback)
+	{
+		for (uint32_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i].Alive)
+				callback(handleAt(i), _slots[i].Resource);
+		}
+	}
+
+	size_t Size() const
+	{
+		return _aliveCount;
+	}
+
+private:
+	struct Slot
+	{
+		ResourceType Resource = ResourceType();
+		uint32_t Generation = 0;
+		uint32_t RefCount = 0;
+		bool Alive = false;
+	};
+
+	Slot* getSlot(Handle handle)
+	{
+		if (handle.Index >= _slots.size())
+			return nullptr;
+
+		Slot& slot = _slots[handle.Index];
+		return slot.Alive && slot.Generation == handle.Generation ? &slot : nullptr;
+	}
+
+	const Slot* getSlot(Handle handle) const
+	{
+		return const_cast<ResourcePool*>(this)->getSlot(handle);
+	}
+
+	Handle handleAt(uint32_t index) const
+	{
+		Handle handle;
+		handle.Index = index;
+		handle.Generation = _slots[index].Generation;
+		return handle;
+	}
+
+	void freeSlot(uint32_t index)
+	{
+		Slot& slot = _slots[index];
+		slot.Resource = ResourceType();
+		slot.Alive = false;
+		slot.RefCount = 0;
+		++slot.Generation;
+		_freeSlots.push_back(index);
+		--_aliveCount;
+	}
+
+	std::deque<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+	size_t _aliveCount = 0;
+};
+
+struct Mesh;
+struct Material;
+struct Texture;
+
+typedef ResourceHandle<Mesh> MeshHandle;
+typedef ResourceHandle<Material> MaterialHandle;
+typedef ResourceHandle<Texture> TextureHandle;
+
+#endif // __RESOURCEPOOL_H__
@@ -0,0 +1,98 @@
+#include "SceneQuery.h"
+#include "Level.h"
+#include "GameObject.h"
+#include "MeshComponent.h"
+#include "ModuleMeshManager.h"
+#include "ModuleJobSystem.h"
+
+#include <MathGeoLib/include/Geometry/LineSegment.h>
+
+namespace
+{
+	bool RaycastMeshes(const Level& level, const ModuleMeshManager& meshManager, const Ray& ray, float maxDistance, RaycastHit& hit, std::vector<GameObject*>& candidates)
+	{
+		candidates.clear();
+		level.GetQuadtree().CollectUniqueIntersections(candidates, LineSegment(ray, maxDistance));
+
+		hit.Object = nullptr;
+		hit.Distance = maxDistance;
+
+		for (GameObject* gameObject : candidates)
+		{
+			if (!gameObject->Enabled)
+				continue;
+
+			float dNear, dFar;
+			if (!gameObject->BoundingBox.Intersects(ray, dNear, dFar) || dNear > hit.Distance)
+				continue;
+
+			const MeshComponent* meshComponent = gameObject->GetMeshComponent();
+			if (meshComponent == nullptr || !meshComponent->Enabled)
+				continue;
+
+			// Test in mesh space, an unnormalized direction keeps distances in world units
+			float4x4 worldToLocal = gameObject->GetWorldTransform();
+			worldToLocal.Inverse();
+			float3 origin = worldToLocal.TransformPos(ray.pos);
+			float3 direction = worldToLocal.TransformDir(ray.dir);
+
+			for (size_t i = 0; i < meshComponent->Meshes.size(); ++i)
+			{
+				const Mesh* mesh = meshManager.GetMesh(meshComponent->Meshes[i]);
+				if (mesh == nullptr)
+					continue;
+
+				RayTriangleHit triangleHit;
+				triangleHit.Distance = hit.Distance;
+
+				bool intersects = mesh->bvh != nullptr
+					? mesh->bvh->Intersect(origin, direction, triangleHit)
+					: RayTriangle::Intersect(origin, direction, mesh->triangles.data(), mesh->triangles.size(), triangleHit);
+
+				if (intersects)
+				{
+					hit.Object = gameObject;
+					hit.Distance = triangleHit.Distance;
+					hit.Mesh = uint32_t(i);
+					hit.Triangle = triangleHit.Triangle;
+				}
+			}
+		}
+
+		if (hit.Object != nullptr)
+			hit.Point = ray.GetPoint(hit.Distance);
+
+		return hit.Object != nullptr;
+	}
+}
+
+bool SceneQuery::Raycast(const Level& level, const Ray& ray, float maxDistance, RaycastHit& hit)
+{
+	std::vector<GameObject*> candidates;
+	return RaycastMeshes(level, *App->GetModule<ModuleMeshManager>(), ray, maxDistance, hit, candidates);
+}
+
+void SceneQuery::RaycastBatch(const Level& level, const Ray* rays, size_t count, float maxDistance, RaycastHit* hits)
+{
+	// Modules are looked up once here, workers only read through these
+	std::shared_ptr<ModuleMeshManager> meshManager = App->GetModule<ModuleMeshManager>();
+	unsigned batches = unsigned((count + RAYCAST_BATCH_SIZE - 1) / RAYCAST_BATCH_SIZE);
+
+	App->GetModule<ModuleJobSystem>()->ParallelFor(batches, [&](unsigned batch)
+	{
+		std::vector<GameObject*> candidates;
+		size_t end = MIN(count, size_t(batch + 1) * RAYCAST_BATCH_SIZE);
+		for (size_t i = size_t(batch) * RAYCAST_BATCH_SIZE; i < end; ++i)
+			RaycastMeshes(level, *meshManager, rays[i], maxDistance, hits[i], candidates);
+	});
+}
+
+void SceneQuery::OverlapSphere(const Level& level, const Sphere& sphere, std::vector<GameObject*>& objects)
+{
+	level.GetQuadtree().CollectUniqueIntersections(objects, sphere);
+}
+
+void SceneQuery::OverlapFrustum(const Level& level, const Frustum& frustum, std::vector<GameObject*>& objects)
+{
+	level.GetQuadtree().CollectUniqueIntersections(objects, frustum);
+}
@@ -0,0 +1,41 @@
+#ifndef __SCENEQUERY_H__
+#define __SCENEQUERY_H__
+
+#include <MathGeoLib/include/Geometry/Ray.h>
+#include <MathGeoLib/include/Geometry/Sphere.h>
+#include <MathGeoLib/include/Geometry/Frustum.h>
+#include <cstdint>
+#include <vector>
+
+#define RAYCAST_BATCH_SIZE 64
+
+class Level;
+class GameObject;
+
+struct RaycastHit
+{
+	GameObject* Object = nullptr;
+	float Distance = 0.f;
+	float3 Point = float3::zero;
+	uint32_t Mesh = 0; // Index in the MeshComponent of the hit object
+	uint32_t Triangle = 0;
+};
+
+/*
+ * Spatial queries over a level. They traverse the level quadtree first, raycasts then test the
+ * triangles of the candidate meshes. Queries only read the level, so batches can run on the job system.
+ */
+namespace SceneQuery
+{
+	// Closest mesh triangle along the ray up to maxDistance
+	bool Raycast(const Level& level, const Ray& ray, float maxDistance, RaycastHit& hit);
+
+	// Splits the rays in batches of RAYCAST_BATCH_SIZE across the job system workers, hits[i].Object is null on a miss
+	void RaycastBatch(const Level& level, const Ray* rays, size_t count, float maxDistance, RaycastHit* hits);
+
+	// Objects whose bounding box touches the primitive
+	void OverlapSphere(const Level& level, const Sphere& sphere, std::vector<GameObject*>& objects);
+	void OverlapFrustum(const Level& level, const Frustum& frustum, std::vector<GameObject*>& objects);
+}
+
+#endif // __SCENEQUERY_H__
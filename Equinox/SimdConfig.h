@@ -0,0 +1,31 @@
+#ifndef __SIMDCONFIG_H__
+#define __SIMDCONFIG_H__
+
+// Instruction sets available to the engine kernels, taken from the compiler target (/arch or -m flags).
+// MathGeoLib is built without SIMD, so these are independent from its MATH_SSE defines.
+// Define EQUINOX_NO_SIMD to build only the scalar paths.
+#ifndef EQUINOX_NO_SIMD
+
+	#if defined(__AVX__)
+		#define EQUINOX_AVX
+	#endif
+
+	#if defined(EQUINOX_AVX) || defined(__SSE4_1__)
+		#define EQUINOX_SSE41
+	#endif
+
+	#if defined(EQUINOX_SSE41) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define EQUINOX_SSE2
+	#endif
+
+#endif
+
+#if defined(EQUINOX_AVX)
+	#include <immintrin.h>
+#elif defined(EQUINOX_SSE41)
+	#include <smmintrin.h>
+#elif defined(EQUINOX_SSE2)
+	#include <emmintrin.h>
+#endif
+
+#endif // __SIMDCONFIG_H__
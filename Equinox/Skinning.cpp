@@ -0,0 +1,133 @@
+#include "Skinning.h"
+#include "SimdConfig.h"
+
+namespace
+{
+	// Palette matrices as four columns of four floats, so a blended matrix is a weighted sum of columns
+	void BuildColumns(const float4x4* palette, size_t boneCount, std::vector<float>& columns)
+	{
+		columns.resize(boneCount * 16);
+		for (size_t bone = 0; bone < boneCount; ++bone)
+		{
+			float* column = &columns[bone * 16];
+			for (int c = 0; c < 4; ++c)
+			{
+				for (int r = 0; r < 4; ++r)
+					column[c * 4 + r] = palette[bone][r][c];
+			}
+		}
+	}
+
+	void SkinScalar(const MeshSkin& skin, const float* columns, float3* positions, float3* normals)
+	{
+		size_t vertexCount = skin.BindPositions.size();
+		bool hasNormals = normals != nullptr && skin.BindNormals.size() == vertexCount;
+
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			float blended[12] = { 0.f };
+			for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+			{
+				float weight = skin.BoneWeights[v * SKINNING_INFLUENCES + i];
+				if (weight == 0.f)
+					continue;
+
+				const float* bone = columns + unsigned(skin.BoneIndices[v * SKINNING_INFLUENCES + i]) * 16;
+				for (unsigned c = 0; c < 4; ++c)
+				{
+					for (unsigned r = 0; r < 3; ++r)
+						blended[c * 3 + r] += bone[c * 4 + r] * weight;
+				}
+			}
+
+			const float3& p = skin.BindPositions[v];
+			positions[v] = float3(
+				blended[0] * p.x + blended[3] * p.y + blended[6] * p.z + blended[9],
+				blended[1] * p.x + blended[4] * p.y + blended[7] * p.z + blended[10],
+				blended[2] * p.x + blended[5] * p.y + blended[8] * p.z + blended[11]);
+
+			if (hasNormals)
+			{
+				const float3& n = skin.BindNormals[v];
+				normals[v] = float3(
+					blended[0] * n.x + blended[3] * n.y + blended[6] * n.z,
+					blended[1] * n.x + blended[4] * n.y + blended[7] * n.z,
+					blended[2] * n.x + blended[5] * n.y + blended[8] * n.z).Normalized();
+			}
+		}
+	}
+
+#ifdef EQUINOX_SSE2
+	void SkinSSE(const MeshSkin& skin, const float* columns, float3* positions, float3* normals)
+	{
+		size_t vertexCount = skin.BindPositions.size();
+		bool hasNormals = normals != nullptr && skin.BindNormals.size() == vertexCount;
+
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			__m128 column0 = _mm_setzero_ps();
+			__m128 column1 = _mm_setzero_ps();
+			__m128 column2 = _mm_setzero_ps();
+			__m128 column3 = _mm_setzero_ps();
+
+			for (unsigned i = 0; i < SKINNING_INFLUENCES; ++i)
+			{
+				float weight = skin.BoneWeights[v * SKINNING_INFLUENCES + i];
+				if (weight == 0.f)
+					continue;
+
+				const float* bone = columns + unsigned(skin.BoneIndices[v * SKINNING_INFLUENCES + i]) * 16;
+				__m128 w = _mm_set1_ps(weight);
+				column0 = _mm_add_ps(column0, _mm_mul_ps(_mm_loadu_ps(bone), w));
+				column1 = _mm_add_ps(column1, _mm_mul_ps(_mm_loadu_ps(bone + 4), w));
+				column2 = _mm_add_ps(column2, _mm_mul_ps(_mm_loadu_ps(bone + 8), w));
+				column3 = _mm_add_ps(column3, _mm_mul_ps(_mm_loadu_ps(bone + 12), w));
+			}
+
+			float result[4];
+
+			const float3& p = skin.BindPositions[v];
+			__m128 position = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(p.x)), _mm_mul_ps(column1, _mm_set1_ps(p.y))),
+				_mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(p.z)), column3));
+			_mm_storeu_ps(result, position);
+			positions[v] = float3(result[0], result[1], result[2]);
+
+			if (hasNormals)
+			{
+				const float3& n = skin.BindNormals[v];
+				__m128 normal = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(n.x)), _mm_mul_ps(column1, _mm_set1_ps(n.y))),
+					_mm_mul_ps(column2, _mm_set1_ps(n.z)));
+				_mm_storeu_ps(result, normal);
+				normals[v] = float3(result[0], result[1], result[2]).Normalized();
+			}
+		}
+	}
+#endif
+}
+
+const char* Skinning::GetKernelName(SkinningKernel kernel)
+{
+#ifdef EQUINOX_SSE2
+	if (kernel != SkinningKernel::Scalar)
+		return "SSE";
+#endif
+	return "Scalar";
+}
+
+void Skinning::SkinVertices(const MeshSkin& skin, const float4x4* palette, size_t boneCount, float3* positions, float3* normals, SkinningKernel kernel)
+{
+	std::vector<float> columns;
+	BuildColumns(palette, boneCount, columns);
+
+#ifdef EQUINOX_SSE2
+	if (kernel != SkinningKernel::Scalar)
+	{
+		SkinSSE(skin, columns.data(), positions, normals);
+		return;
+	}
+#endif
+
+	SkinScalar(skin, columns.data(), positions, normals);
+}
@@ -0,0 +1,52 @@
+#ifndef __SKINNING_H__
+#define __SKINNING_H__
+
+#include <GL/glew.h>
+#include <MathGeoLib/include/Math/float3.h>
+#include <MathGeoLib/include/Math/float4x4.h>
+#include <string>
+#include <vector>
+
+#define MAX_SKINNING_BONES 64 // Must match MAX_BONES in the vertex shader
+#define SKINNING_INFLUENCES 4
+
+// Bone data of a skinned mesh. The bind pose stays on the CPU for the SIMD fallback.
+struct MeshSkin
+{
+	std::vector<std::string> BoneNames;
+	std::vector<float4x4> InverseBindMatrices; // Mesh space to bone space in the bind pose
+
+	std::vector<float3> BindPositions;
+	std::vector<float3> BindNormals;
+
+	// SKINNING_INFLUENCES per vertex, indices are floats so fixed function era GLSL can read them as attributes
+	std::vector<float> BoneIndices;
+	std::vector<float> BoneWeights;
+
+	GLuint BoneIndicesID = 0;
+	GLuint BoneWeightsID = 0;
+
+	// Output of CPU skinning, streamed every frame
+	GLuint SkinnedVertexID = 0;
+	GLuint SkinnedNormalID = 0;
+};
+
+enum class SkinningKernel
+{
+	Scalar,
+	SSE,
+	Best
+};
+
+/*
+ * Linear blend skinning on the CPU, used when the skinned shader is not available or the mesh
+ * has more bones than the shader palette. The palette holds one mesh space matrix per bone.
+ */
+namespace Skinning
+{
+	const char* GetKernelName(SkinningKernel kernel);
+
+	void SkinVertices(const MeshSkin& skin, const float4x4* palette, size_t boneCount, float3* positions, float3* normals, SkinningKernel kernel = SkinningKernel::Best);
+}
+
+#endif // __SKINNING_H__
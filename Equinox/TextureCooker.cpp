@@ -0,0 +1,532 @@
+#include "TextureCooker.h"
+#include "Globals.h"
+
+#include <IL/ilut.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+
+namespace
+{
+	struct CookedTextureHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint32_t Format;
+		uint32_t MipCount;
+	};
+
+	struct CookedMipHeader
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Size;
+	};
+
+	const char COOKED_TEXTURE_MAGIC[4] = { 'E', 'Q', 'T', 'X' };
+
+	uint16_t PackRGB565(const uint8_t* color)
+	{
+		return uint16_t(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+	}
+
+	void UnpackRGB565(uint16_t packed, uint8_t* color)
+	{
+		uint8_t r = (packed >> 11) & 31;
+		uint8_t g = (packed >> 5) & 63;
+		uint8_t b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+		color[3] = 255;
+	}
+
+	// Reads a 4x4 block clamping at the image borders so odd sized mips are also encoded
+	void FetchBlock(const uint8_t* rgba, unsigned width, unsigned height, unsigned blockX, unsigned blockY, uint8_t block[64])
+	{
+		for (unsigned y = 0; y < 4; ++y)
+		{
+			unsigned sourceY = MIN(blockY + y, height - 1);
+			for (unsigned x = 0; x < 4; ++x)
+			{
+				unsigned sourceX = MIN(blockX + x, width - 1);
+				memcpy(&block[(y * 4 + x) * 4], &rgba[(sourceY * width + sourceX) * 4], 4);
+			}
+		}
+	}
+
+	void StoreBlock(uint8_t* rgba, unsigned width, unsigned height, unsigned blockX, unsigned blockY, const uint8_t block[64])
+	{
+		for (unsigned y = 0; y < 4 && blockY + y < height; ++y)
+		{
+			for (unsigned x = 0; x < 4 && blockX + x < width; ++x)
+			{
+				memcpy(&rgba[((blockY + y) * width + blockX + x) * 4], &block[(y * 4 + x) * 4], 4);
+			}
+		}
+	}
+
+	// BC1 color block using an inset bounding box as the endpoints (range fit)
+	void EncodeColorBlock(const uint8_t block[64], uint8_t* out)
+	{
+		int minColor[3] = { 255, 255, 255 };
+		int maxColor[3] = { 0, 0, 0 };
+
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			for (unsigned c = 0; c < 3; ++c)
+			{
+				minColor[c] = MIN(minColor[c], int(block[i * 4 + c]));
+				maxColor[c] = MAX(maxColor[c], int(block[i * 4 + c]));
+			}
+		}
+
+		uint8_t endpoints[2][3];
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			int inset = (maxColor[c] - minColor[c]) >> 4;
+			endpoints[0][c] = uint8_t(maxColor[c] - inset);
+			endpoints[1][c] = uint8_t(minColor[c] + inset);
+		}
+
+		uint16_t color0 = PackRGB565(endpoints[0]);
+		uint16_t color1 = PackRGB565(endpoints[1]);
+
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		uint32_t indices = 0;
+
+		if (color0 != color1)
+		{
+			uint8_t palette[4][4];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (unsigned c = 0; c < 3; ++c)
+			{
+				palette[2][c] = uint8_t((2 * palette[0][c] + palette[1][c]) / 3);
+				palette[3][c] = uint8_t((palette[0][c] + 2 * palette[1][c]) / 3);
+			}
+
+			for (unsigned i = 0; i < 16; ++i)
+			{
+				int bestDistance = INT_MAX;
+				uint32_t bestIndex = 0;
+				for (uint32_t p = 0; p < 4; ++p)
+				{
+					int distance = 0;
+					for (unsigned c = 0; c < 3; ++c)
+					{
+						int delta = int(block[i * 4 + c]) - int(palette[p][c]);
+						distance += delta * delta;
+					}
+
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+				indices |= bestIndex << (i * 2);
+			}
+		}
+
+		out[0] = color0 & 0xFF;
+		out[1] = color0 >> 8;
+		out[2] = color1 & 0xFF;
+		out[3] = color1 >> 8;
+		out[4] = indices & 0xFF;
+		out[5] = (indices >> 8) & 0xFF;
+		out[6] = (indices >> 16) & 0xFF;
+		out[7] = (indices >> 24) & 0xFF;
+	}
+
+	// BC3 alpha block, always in the 8 interpolated values mode
+	void EncodeAlphaBlock(const uint8_t block[64], uint8_t* out)
+	{
+		int alpha0 = 0;
+		int alpha1 = 255;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			alpha0 = MAX(alpha0, int(block[i * 4 + 3]));
+			alpha1 = MIN(alpha1, int(block[i * 4 + 3]));
+		}
+
+		memset(out, 0, 8);
+		out[0] = uint8_t(alpha0);
+		out[1] = uint8_t(alpha1);
+
+		if (alpha0 == alpha1)
+			return;
+
+		int palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (int i = 1; i < 7; ++i)
+			palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+
+		uint64_t indices = 0;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			int alpha = block[i * 4 + 3];
+			int bestDistance = INT_MAX;
+			uint64_t bestIndex = 0;
+			for (uint64_t p = 0; p < 8; ++p)
+			{
+				int distance = abs(alpha - palette[p]);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+
+		for (unsigned i = 0; i < 6; ++i)
+			out[2 + i] = uint8_t((indices >> (i * 8)) & 0xFF);
+	}
+
+	void DecodeColorBlock(const uint8_t* in, uint8_t block[64])
+	{
+		uint16_t color0 = uint16_t(in[0] | (in[1] << 8));
+		uint16_t color1 = uint16_t(in[2] | (in[3] << 8));
+		uint32_t indices = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+
+		uint8_t palette[4][4];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			if (color0 > color1)
+			{
+				palette[2][c] = uint8_t((2 * palette[0][c] + palette[1][c]) / 3);
+				palette[3][c] = uint8_t((palette[0][c] + 2 * palette[1][c]) / 3);
+			}
+			else
+			{
+				palette[2][c] = uint8_t((palette[0][c] + palette[1][c]) / 2);
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = color0 > color1 ? 255 : 0;
+
+		for (unsigned i = 0; i < 16; ++i)
+			memcpy(&block[i * 4], palette[(indices >> (i * 2)) & 3], 4);
+	}
+
+	void DecodeAlphaBlock(const uint8_t* in, uint8_t block[64])
+	{
+		int palette[8];
+		palette[0] = in[0];
+		palette[1] = in[1];
+		if (palette[0] > palette[1])
+		{
+			for (int i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+		}
+		else
+		{
+			for (int i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (unsigned i = 0; i < 6; ++i)
+			indices |= uint64_t(in[2 + i]) << (i * 8);
+
+		for (unsigned i = 0; i < 16; ++i)
+			block[i * 4 + 3] = uint8_t(palette[(indices >> (i * 3)) & 7]);
+	}
+
+	unsigned BlockSize(CookedTextureFormat format)
+	{
+		return format == CookedTextureFormat::BC1 ? 8 : 16;
+	}
+
+	void CompressLevel(CookedTextureFormat format, const std::vector<uint8_t>& rgba, CookedMipLevel& level)
+	{
+		unsigned blocksX = (level.Width + 3) / 4;
+		unsigned blocksY = (level.Height + 3) / 4;
+		unsigned blockSize = BlockSize(format);
+
+		level.Data.resize(blocksX * blocksY * blockSize);
+
+		uint8_t block[64];
+		uint8_t* out = level.Data.data();
+		for (unsigned by = 0; by < blocksY; ++by)
+		{
+			for (unsigned bx = 0; bx < blocksX; ++bx)
+			{
+				FetchBlock(rgba.data(), level.Width, level.Height, bx * 4, by * 4, block);
+
+				if (format == CookedTextureFormat::BC3)
+				{
+					EncodeAlphaBlock(block, out);
+					out += 8;
+				}
+
+				EncodeColorBlock(block, out);
+				out += 8;
+			}
+		}
+	}
+
+	// 2x2 box filter, odd dimensions clamp the last row / column
+	void Downsample(const std::vector<uint8_t>& source, unsigned width, unsigned height, std::vector<uint8_t>& destination, unsigned& outWidth, unsigned& outHeight)
+	{
+		outWidth = MAX(1u, width / 2);
+		outHeight = MAX(1u, height / 2);
+		destination.resize(outWidth * outHeight * 4);
+
+		for (unsigned y = 0; y < outHeight; ++y)
+		{
+			unsigned y0 = MIN(y * 2, height - 1);
+			unsigned y1 = MIN(y * 2 + 1, height - 1);
+			for (unsigned x = 0; x < outWidth; ++x)
+			{
+				unsigned x0 = MIN(x * 2, width - 1);
+				unsigned x1 = MIN(x * 2 + 1, width - 1);
+				for (unsigned c = 0; c < 4; ++c)
+				{
+					unsigned sum = source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] +
+						source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+					destination[(y * outWidth + x) * 4 + c] = uint8_t((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	bool HasTransparency(const uint8_t* rgba, unsigned width, unsigned height)
+	{
+		for (unsigned i = 0; i < width * height; ++i)
+		{
+			if (rgba[i * 4 + 3] != 255)
+				return true;
+		}
+		return false;
+	}
+}
+
+size_t CookedTexture::SizeInBytes(unsigned firstMip) const
+{
+	size_t size = 0;
+	for (unsigned i = firstMip; i < Mips.size(); ++i)
+		size += Mips[i].Data.size();
+	return size;
+}
+
+std::string TextureCooker::GetCookedPath(const std::string& sourcePath)
+{
+	return sourcePath + COOKED_TEXTURE_EXTENSION;
+}
+
+bool TextureCooker::IsCookedUpToDate(const std::string& sourcePath, const std::string& cookedPath)
+{
+	struct stat cookedStat;
+	if (stat(cookedPath.c_str(), &cookedStat) != 0)
+		return false;
+
+	// Shipped builds may only contain the cooked files
+	struct stat sourceStat;
+	if (stat(sourcePath.c_str(), &sourceStat) != 0)
+		return true;
+
+	return cookedStat.st_mtime >= sourceStat.st_mtime;
+}
+
+bool TextureCooker::Cook(const std::string& sourcePath, const std::string& cookedPath, const TextureCookOptions& options)
+{
+	LOG("Cooking texture %s", sourcePath.c_str());
+
+	ILuint imageID;
+	ilGenImages(1, &imageID);
+	ilBindImage(imageID);
+
+	if (!ilLoadImage(sourcePath.c_str()))
+	{
+		LOG("Could not load texture %s", sourcePath.c_str());
+		ilBindImage(0);
+		ilDeleteImages(1, &imageID);
+		return false;
+	}
+
+	ILinfo ImageInfo;
+	iluGetImageInfo(&ImageInfo);
+	if (ImageInfo.Origin == IL_ORIGIN_UPPER_LEFT)
+	{
+		iluFlipImage();
+	}
+
+	ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+
+	unsigned width = ilGetInteger(IL_IMAGE_WIDTH);
+	unsigned height = ilGetInteger(IL_IMAGE_HEIGHT);
+
+	CookedTexture cooked;
+	bool ret = BuildCookedTexture(ilGetData(), width, height, options, cooked);
+
+	ilBindImage(0);
+	ilDeleteImages(1, &imageID);
+
+	return ret && Save(cookedPath, cooked);
+}
+
+bool TextureCooker::BuildCookedTexture(const uint8_t* rgba, unsigned width, unsigned height, const TextureCookOptions& options, CookedTexture& cooked)
+{
+	if (rgba == nullptr || width == 0 || height == 0)
+		return false;
+
+	if (options.Compress)
+		cooked.Format = HasTransparency(rgba, width, height) ? CookedTextureFormat::BC3 : CookedTextureFormat::BC1;
+	else
+		cooked.Format = CookedTextureFormat::RGBA8;
+
+	std::vector<uint8_t> current(rgba, rgba + width * height * 4);
+	std::vector<uint8_t> next;
+
+	cooked.Mips.clear();
+	while (true)
+	{
+		cooked.Mips.emplace_back();
+		CookedMipLevel& level = cooked.Mips.back();
+		level.Width = width;
+		level.Height = height;
+
+		if (cooked.Format == CookedTextureFormat::RGBA8)
+			level.Data = current;
+		else
+			CompressLevel(cooked.Format, current, level);
+
+		if (!options.GenerateMips || (width == 1 && height == 1))
+			break;
+
+		unsigned nextWidth, nextHeight;
+		Downsample(current, width, height, next, nextWidth, nextHeight);
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	return true;
+}
+
+bool TextureCooker::Save(const std::string& cookedPath, const CookedTexture& cooked)
+{
+	FILE* file = fopen(cookedPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		LOG("Could not write cooked texture %s", cookedPath.c_str());
+		return false;
+	}
+
+	CookedTextureHeader header;
+	memcpy(header.Magic, COOKED_TEXTURE_MAGIC, sizeof(header.Magic));
+	header.Version = COOKED_TEXTURE_VERSION;
+	header.Format = uint32_t(cooked.Format);
+	header.MipCount = uint32_t(cooked.Mips.size());
+	fwrite(&header, sizeof(header), 1, file);
+
+	for (const CookedMipLevel& level : cooked.Mips)
+	{
+		CookedMipHeader mipHeader = { level.Width, level.Height, uint32_t(level.Data.size()) };
+		fwrite(&mipHeader, sizeof(mipHeader), 1, file);
+		fwrite(level.Data.data(), 1, level.Data.size(), file);
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool TextureCooker::Load(const std::string& cookedPath, CookedTexture& cooked, unsigned firstMip)
+{
+	FILE* file = fopen(cookedPath.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	CookedTextureHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.Magic, COOKED_TEXTURE_MAGIC, sizeof(header.Magic)) != 0 ||
+		header.Version != COOKED_TEXTURE_VERSION || header.MipCount == 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	firstMip = MIN(firstMip, header.MipCount - 1);
+
+	cooked.Format = CookedTextureFormat(header.Format);
+	cooked.Mips.clear();
+	cooked.Mips.reserve(header.MipCount - firstMip);
+
+	bool ret = true;
+	for (unsigned i = 0; i < header.MipCount && ret; ++i)
+	{
+		CookedMipHeader mipHeader;
+		if (fread(&mipHeader, sizeof(mipHeader), 1, file) != 1)
+		{
+			ret = false;
+		}
+		else if (i < firstMip)
+		{
+			ret = fseek(file, mipHeader.Size, SEEK_CUR) == 0;
+		}
+		else
+		{
+			cooked.Mips.emplace_back();
+			CookedMipLevel& level = cooked.Mips.back();
+			level.Width = mipHeader.Width;
+			level.Height = mipHeader.Height;
+			level.Data.resize(mipHeader.Size);
+			ret = fread(level.Data.data(), 1, mipHeader.Size, file) == mipHeader.Size;
+		}
+	}
+
+	fclose(file);
+
+	if (!ret)
+		cooked.Mips.clear();
+
+	return ret;
+}
+
+void TextureCooker::Decompress(CookedTextureFormat format, const CookedMipLevel& level, std::vector<uint8_t>& rgba)
+{
+	rgba.resize(level.Width * level.Height * 4);
+
+	if (format == CookedTextureFormat::RGBA8)
+	{
+		rgba = level.Data;
+		return;
+	}
+
+	unsigned blocksX = (level.Width + 3) / 4;
+	unsigned blocksY = (level.Height + 3) / 4;
+	const uint8_t* in = level.Data.data();
+
+	uint8_t block[64];
+	for (unsigned by = 0; by < blocksY; ++by)
+	{
+		for (unsigned bx = 0; bx < blocksX; ++bx)
+		{
+			if (format == CookedTextureFormat::BC3)
+			{
+				DecodeColorBlock(in + 8, block);
+				DecodeAlphaBlock(in, block);
+				in += 16;
+			}
+			else
+			{
+				DecodeColorBlock(in, block);
+				in += 8;
+			}
+
+			StoreBlock(rgba.data(), level.Width, level.Height, bx * 4, by * 4, block);
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef __TEXTURECOOKER_H__
+#define __TEXTURECOOKER_H__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define COOKED_TEXTURE_EXTENSION ".eqtex"
+#define COOKED_TEXTURE_VERSION 1
+
+enum class CookedTextureFormat : uint32_t
+{
+	RGBA8 = 0, // Uncompressed fallback
+	BC1 = 1,   // DXT1, opaque textures
+	BC3 = 2    // DXT5, textures with alpha
+};
+
+struct CookedMipLevel
+{
+	unsigned Width = 0;
+	unsigned Height = 0;
+	std::vector<uint8_t> Data;
+};
+
+struct CookedTexture
+{
+	CookedTextureFormat Format = CookedTextureFormat::RGBA8;
+	std::vector<CookedMipLevel> Mips;
+
+	size_t SizeInBytes(unsigned firstMip = 0) const;
+};
+
+struct TextureCookOptions
+{
+	bool Compress = true;
+	bool GenerateMips = true;
+};
+
+/*
+ * Offline texture cook: decodes a source image, builds its full mip chain, block compresses it
+ * and stores the result in a .eqtex container that can be uploaded to GL without further processing.
+ */
+namespace TextureCooker
+{
+	std::string GetCookedPath(const std::string& sourcePath);
+	bool IsCookedUpToDate(const std::string& sourcePath, const std::string& cookedPath);
+
+	bool Cook(const std::string& sourcePath, const std::string& cookedPath, const TextureCookOptions& options);
+	bool BuildCookedTexture(const uint8_t* rgba, unsigned width, unsigned height, const TextureCookOptions& options, CookedTexture& cooked);
+
+	bool Save(const std::string& cookedPath, const CookedTexture& cooked);
+	bool Load(const std::string& cookedPath, CookedTexture& cooked, unsigned firstMip = 0);
+
+	// Expands a compressed level to RGBA8, used when the driver lacks S3TC support
+	void Decompress(CookedTextureFormat format, const CookedMipLevel& level, std::vector<uint8_t>& rgba);
+}
+
+#endif // __TEXTURECOOKER_H__
@@ -0,0 +1,85 @@
+#include "TextureStreamer.h"
+#include "MemoryTracker.h"
+
+TextureStreamer::TextureStreamer()
+{
+	_thread = std::thread(&TextureStreamer::threadLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_requests.clear();
+		_exit = true;
+	}
+	_requestQueued.notify_one();
+
+	_thread.join();
+}
+
+void TextureStreamer::Request(TextureHandle handle, const std::string& cookedPath, unsigned firstMip)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		StreamRequest request;
+		request.Handle = handle;
+		request.CookedPath = cookedPath;
+		request.FirstMip = firstMip;
+		_requests.push_back(request);
+		++_pending;
+	}
+	_requestQueued.notify_one();
+}
+
+bool TextureStreamer::CollectFinished(std::vector<StreamedTexture>& finished)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_finished.empty())
+		return false;
+
+	_pending -= _finished.size();
+	for (StreamedTexture& streamed : _finished)
+		finished.push_back(std::move(streamed));
+	_finished.clear();
+
+	return true;
+}
+
+size_t TextureStreamer::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _pending;
+}
+
+void TextureStreamer::threadLoop()
+{
+	// Levels waiting to be uploaded are texture memory as much as the resident ones
+	MEMORY_TAG_SCOPE(MemoryTag::Textures);
+
+	while (true)
+	{
+		StreamRequest request;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_requestQueued.wait(lock, [this]() { return _exit || !_requests.empty(); });
+
+			if (_exit)
+				return;
+
+			request = _requests.front();
+			_requests.erase(_requests.begin());
+		}
+
+		StreamedTexture streamed;
+		streamed.Handle = request.Handle;
+		streamed.FirstMip = request.FirstMip;
+		streamed.Loaded = TextureCooker::Load(request.CookedPath, streamed.Cooked, request.FirstMip);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_finished.push_back(std::move(streamed));
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef __TEXTURESTREAMER_H__
+#define __TEXTURESTREAMER_H__
+
+#include "TextureCooker.h"
+#include "ResourcePool.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct StreamedTexture
+{
+	TextureHandle Handle;
+	unsigned FirstMip = 0;
+	CookedTexture Cooked;
+	bool Loaded = false;
+};
+
+/*
+ * Reads mip chains from cooked textures on its own thread so the texture budget never blocks the
+ * main thread on the file system. The results are picked up and uploaded to GL from the main thread.
+ */
+class TextureStreamer
+{
+public:
+	TextureStreamer();
+	~TextureStreamer();
+
+	// Queues reading every level from firstMip down to the smallest one
+	void Request(TextureHandle handle, const std::string& cookedPath, unsigned firstMip);
+	// Moves the finished requests into finished, returns false when there were none
+	bool CollectFinished(std::vector<StreamedTexture>& finished);
+
+	size_t GetPendingCount() const;
+
+private:
+	struct StreamRequest
+	{
+		TextureHandle Handle;
+		std::string CookedPath;
+		unsigned FirstMip = 0;
+	};
+
+	void threadLoop();
+
+	std::thread _thread;
+
+	mutable std::mutex _mutex;
+	std::condition_variable _requestQueued;
+
+	std::vector<StreamRequest> _requests;
+	std::vector<StreamedTexture> _finished;
+	size_t _pending = 0;
+	bool _exit = false;
+};
+
+#endif // __TEXTURESTREAMER_H__
@@ -1,5 +1,5 @@
 ﻿#include "TransformComponent.h"
-#include <GL/glew.h>
+#include "RenderDevice.h"
 #include <MathGeoLib/include/Math/float4x4.h>
 #include "IMGUI/imgui.h"
 
@@ -18,8 +18,7 @@ float4x4 TransformComponent::GetTransformMatrix() const
 
 void TransformComponent::Update(float dt)
 {	
-	float4x4 transformMatrix = GetTransformMatrix().Transposed();
-	glMultMatrixf(reinterpret_cast<GLfloat*>(&transformMatrix));
+	RenderDevice::Current()->MultMatrix(GetTransformMatrix());
 }
 
 void TransformComponent::EditorUpdate(float dt)